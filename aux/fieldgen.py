@@ -0,0 +1,704 @@
+#!/usr/bin/env python3
+"""
+Generate field arithmetic for unsaturated-limb primes.
+
+Given a prime p, a number of limbs n and a word size, this emits C for
+  * mul and sqr kernels: schoolbook for any p where 2^(n*radix) mod p has
+    small digits in the radix, or Karatsuba when p = 2^(2k) - 2^k - 1
+    splits evenly into halves ("golden" primes like p448 and p480);
+  * addition chains for field_isr, field_inverse and field_sqrt, in the
+    style of src/$(FIELD)/f_arithmetic.c;
+  * a bound proof for each kernel, as a comment block: the largest limbs
+    the kernel accepts without overflowing an accumulator, the bound on its
+    output limbs, and so how many reduced values can be added together
+    (lazily, without weak_reduce) before they go into a mul.
+
+Each kernel is a straight-line program, which this script also
+interprets.  The bound proof tracks every accumulator as a constant plus
+a polynomial in the input limbs with non-negative coefficients, so its
+maximum is at the top corner of the input box; Karatsuba subtractions are
+checked to leave the coefficients non-negative.  The kernels are then
+tested on random and extreme inputs in Python, and with --check they are
+compiled and compared (values and speed) with the hand-written kernels
+in an object file such as build/p448.o from "make ARCH=arch_ref64".
+
+Examples:
+    aux/fieldgen.py --config p448/arch_ref64 -o build/gen_p448.c
+    aux/fieldgen.py --prime '2^255-19' --limbs 5 --word 64 --prefix p255
+    aux/fieldgen.py --config p448/arch_ref64 --check build/p448.o
+"""
+
+import argparse
+import math
+import os
+import random
+import re
+import subprocess
+import sys
+import tempfile
+
+# Known fields, by the src/ directory of their hand-written backend.
+CONFIGS = {
+    "p448/arch_ref64":    dict(prime="2^448-2^224-1", limbs=8,  word=64, prefix="p448"),
+    "p448/arch_x86_64":   dict(prime="2^448-2^224-1", limbs=8,  word=64, prefix="p448"),
+    "p448/arch_32":       dict(prime="2^448-2^224-1", limbs=16, word=32, prefix="p448"),
+    "p448/arch_arm_32":   dict(prime="2^448-2^224-1", limbs=16, word=32, prefix="p448"),
+    "p480/arch_x86_64":   dict(prime="2^480-2^240-1", limbs=8,  word=64, prefix="p480"),
+    "p521/arch_ref64":    dict(prime="2^521-1",       limbs=9,  word=64, prefix="p521"),
+}
+
+def parse_prime(s):
+    if not re.match(r"^[0-9^*+\-() ]+$", s):
+        raise ValueError("bad prime expression: %s" % s)
+    return eval(s.replace("^", "**"), {"__builtins__": {}})
+
+def log2(x):
+    return math.log2(x) if x else float("-inf")
+
+class Field(object):
+    def __init__(self, p, limbs, word, radix=None):
+        self.p, self.n, self.w = p, limbs, word
+        self.r = radix or -(-p.bit_length() // limbs)
+        if self.r >= word or self.n * self.r < p.bit_length():
+            raise ValueError("%d limbs of %d bits don't fit p" % (self.n, self.r))
+
+        # 2^(n*r) = sum fold[d] * 2^(d*r) mod p, with small fold[d]
+        v = pow(2, self.n * self.r, self.p)
+        self.fold, d = {}, 0
+        while v:
+            if v & ((1 << self.r) - 1):
+                self.fold[d] = v & ((1 << self.r) - 1)
+            v >>= self.r
+            d += 1
+        if not self.fold or max(self.fold.values()) >= 1 << 8 or max(self.fold) >= self.n - 1:
+            raise ValueError("2^(%d*%d) mod p isn't sparse in this radix" % (self.n, self.r))
+
+        self.h = self.n // 2
+        self.golden = self.n % 2 == 0 and self.fold == {0: 1, self.h: 1}
+
+    def value(self, limbs):
+        return sum(x << (self.r * i) for i, x in enumerate(limbs)) % self.p
+
+# Straight-line kernel programs.
+#
+# Arrays hold linear forms in the input limbs: {("a",i): coef, ...}.  In a
+# squaring kernel the "b" limbs are the "a" limbs.  Ops:
+#   ("zero", acc)
+#   ("mac", acc, x, i, y, j)          acc += x[i] * y[j]
+#   ("addacc", dst, src, k)           dst += src * k
+#   ("subacc", dst, src)              dst -= src
+#   ("addlimb", acc, k)               acc += c[k]
+#   ("emit", k, acc)                  c[k] = acc & mask; acc >>= radix
+#   ("addcarry", k, acc)              c[k] += acc
+def bilinear(x, y):
+    """The product of two linear forms."""
+    poly = {}
+    for (u, k) in x.items():
+        for (v, l) in y.items():
+            m = tuple(sorted((u, v)))
+            poly[m] = poly.get(m, 0) + k * l
+    return poly
+
+class Kernel(object):
+    def __init__(self, field, name, sqr):
+        self.field, self.name, self.sqr = field, name, sqr
+        n = field.n
+        self.arrays = {"a": [{("a", i): 1} for i in range(n)]}
+        self.arrays["b"] = self.arrays["a"] if sqr else [{("b", i): 1} for i in range(n)]
+        self.pre = []           # names of precomputed arrays, in order
+        self.ops = []
+        self.accs = []
+
+    def array(self, name, forms):
+        self.arrays[name] = forms
+        self.pre.append(name)
+
+    def op(self, *o):
+        self.ops.append(o)
+        for x in o[1:]:
+            if isinstance(x, str) and x.startswith("accum") and x not in self.accs:
+                self.accs.append(x)
+
+    def muls(self):
+        return sum(1 for o in self.ops if o[0] == "mac")
+
+    # Python interpretation, checking for overflow as C would have it
+    def run(self, a, b):
+        w2 = 1 << (2 * self.field.w)
+        vals = {"a": a, "b": a if self.sqr else b}
+        def lin(form):
+            return sum(k * vals[v][i] for (v, i), k in form.items())
+        arr = {}
+        for name, forms in self.arrays.items():
+            arr[name] = [lin(f) for f in forms]
+            assert all(x < 1 << self.field.w for x in arr[name]), name
+        acc, c = {}, [0] * self.field.n
+        mask = (1 << self.field.r) - 1
+        for o in self.ops:
+            if o[0] == "zero":
+                acc[o[1]] = 0
+            elif o[0] == "mac":
+                acc[o[1]] += arr[o[2]][o[3]] * arr[o[4]][o[5]]
+            elif o[0] == "addacc":
+                acc[o[1]] += acc[o[2]] * o[3]
+            elif o[0] == "subacc":
+                acc[o[1]] -= acc[o[2]]
+            elif o[0] == "addlimb":
+                acc[o[1]] += c[o[2]]
+            elif o[0] == "emit":
+                c[o[1]] = acc[o[2]] & mask
+                acc[o[2]] >>= self.field.r
+            elif o[0] == "addcarry":
+                c[o[1]] += acc[o[2]]
+                assert c[o[1]] < 1 << self.field.w
+            for x in acc.values():
+                assert 0 <= x < w2, (self.name, o)
+        return c
+
+    # Bound proof for input limbs <= bound.  Returns (ok, out_bounds, steps)
+    def prove(self, bound):
+        f = self.field
+        w2 = 1 << (2 * f.w)
+        def pmax(poly):
+            return sum(poly.values()) * bound * bound
+        for name in self.pre:
+            for form in self.arrays[name]:
+                if sum(form.values()) * bound >= 1 << f.w:
+                    return False, None, None
+        # acc -> [constant bound, polynomial]
+        acc, c, steps = {}, [0] * f.n, []
+        for o in self.ops:
+            if o[0] == "zero":
+                acc[o[1]] = [0, {}]
+            elif o[0] == "mac":
+                for m, k in bilinear(self.arrays[o[2]][o[3]], self.arrays[o[4]][o[5]]).items():
+                    acc[o[1]][1][m] = acc[o[1]][1].get(m, 0) + k
+            elif o[0] == "addacc":
+                const, poly = acc[o[2]]
+                acc[o[1]][0] += const * o[3]
+                for m, k in poly.items():
+                    acc[o[1]][1][m] = acc[o[1]][1].get(m, 0) + k * o[3]
+            elif o[0] == "subacc":
+                if acc[o[2]][0]:
+                    return False, None, None
+                for m, k in acc[o[2]][1].items():
+                    acc[o[1]][1][m] = acc[o[1]][1].get(m, 0) - k
+                if min(acc[o[1]][1].values()) < 0:
+                    return False, None, None
+            elif o[0] == "addlimb":
+                acc[o[1]][0] += c[o[2]]
+            elif o[0] == "emit":
+                hi = acc[o[2]][0] + pmax(acc[o[2]][1])
+                if hi >= w2:
+                    return False, None, None
+                steps.append((o[1], o[2], hi))
+                c[o[1]] = min(hi, (1 << f.r) - 1)
+                acc[o[2]] = [hi >> f.r, {}]
+            elif o[0] == "addcarry":
+                c[o[1]] += acc[o[2]][0] + pmax(acc[o[2]][1])
+                if c[o[1]] >= 1 << f.w:
+                    return False, None, None
+            for const, poly in acc.values():
+                if const + pmax(poly) >= w2:
+                    return False, None, None
+        return True, c, steps
+
+    def max_bound(self):
+        lo, hi = 1, 1 << self.field.w
+        while hi - lo > 1:
+            mid = (lo + hi) // 2
+            if self.prove(mid)[0]:
+                lo = mid
+            else:
+                hi = mid
+        return lo
+
+def fold(field, s, k):
+    """Where a product of weight 2^(s*r) lands, as [(limb, coef)]."""
+    if s < field.n:
+        return [(s, k)]
+    out = []
+    for d, dk in field.fold.items():
+        out += fold(field, s - field.n + d, k * dk)
+    return out
+
+def schoolbook(field, sqr):
+    kern = Kernel(field, "sqr" if sqr else "mul", sqr)
+    n = field.n
+    terms = [dict() for _ in range(n)]
+    for i in range(n):
+        for j in range(i if sqr else 0, n):
+            k0 = 2 if sqr and i != j else 1
+            for limb, k in fold(field, i + j, k0):
+                terms[limb].setdefault(k, []).append((i, j))
+
+    # One carry chain through accum0; products with coefficient k go
+    # through their own accumulator and get scaled once.
+    kern.op("zero", "accum0")
+    for limb in range(n):
+        for g, (k, prods) in enumerate(sorted(terms[limb].items())):
+            acc = "accum0" if k == 1 else "accum%d" % (g + 1)
+            if acc != "accum0":
+                kern.op("zero", acc)
+            for i, j in prods:
+                kern.op("mac", acc, "a", i, "a" if sqr else "b", j)
+            if acc != "accum0":
+                kern.op("addacc", "accum0", acc, k)
+        kern.op("emit", limb, "accum0")
+
+    # The carry out of the top limb has weight 2^(n*r) = sum fold[d] 2^(d*r).
+    for g, (d, k) in enumerate(sorted(field.fold.items())):
+        acc = "accum%d" % (g + 1)
+        kern.op("zero", acc)
+        kern.op("addacc", acc, "accum0", k)
+        kern.op("addlimb", acc, d)
+        kern.op("emit", d, acc)
+        kern.op("addcarry", d + 1, acc)
+    return kern
+
+def merge_symmetric(kern):
+    """
+    In a squaring, x[i]*y[j] and y[j]*x[i] often go into the same sum.
+    Compute such pairs once, with x doubled.
+    """
+    seen, seg, ops, double = {}, {}, [], set()
+    for o in kern.ops:
+        if o[0] == "mac":
+            prod = bilinear(kern.arrays[o[2]][o[3]], kern.arrays[o[4]][o[5]])
+            key = (o[1], seg.get(o[1], 0), frozenset(prod.items()))
+            if key in seen and seen[key] not in double:
+                double.add(seen[key])
+                continue
+            seen[key] = len(ops)
+        else:
+            # Don't move products across anything else touching the sum
+            for x in o[1:]:
+                if isinstance(x, str) and x.startswith("accum"):
+                    seg[x] = seg.get(x, 0) + 1
+        ops.append(o)
+    for i in sorted(double):
+        o = ops[i]
+        name = o[2] + "2"
+        if name not in kern.arrays:
+            kern.array(name, [dict((v, 2 * k) for v, k in form.items())
+                              for form in kern.arrays[o[2]]])
+        ops[i] = (o[0], o[1], name) + o[3:]
+    kern.ops = ops
+    return kern
+
+def karatsuba(field, sqr):
+    """
+    Karatsuba for p = 2^(2k) - 2^k - 1, split into halves of h limbs as
+    the hand-written p448 kernels do: with phi = 2^k, phi^2 = phi + 1, so
+    (a0 + a1 phi)(b0 + b1 phi) = (a0 b0 + a1 b1) + ((a0+a1)(b0+b1) - a0 b0) phi.
+    """
+    kern = Kernel(field, "sqr" if sqr else "mul", sqr)
+    n, h = field.n, field.h
+    a, b = kern.arrays["a"], kern.arrays["b"]
+    def add(x, y):
+        z = dict(x)
+        for v, k in y.items():
+            z[v] = z.get(v, 0) + k
+        return z
+    kern.array("aa", [add(a[i], a[i + h]) for i in range(h)])
+    if sqr:
+        kern.arrays["bb"] = kern.arrays["aa"]
+    else:
+        kern.array("bb", [add(b[i], b[i + h]) for i in range(h)])
+    kern.array("bbb", [add(kern.arrays["bb"][i], b[i + h]) for i in range(h)])
+    # In a squaring, b is a and bb is aa
+    B, BB = ("a", "aa") if sqr else ("b", "bb")
+
+    kern.op("zero", "accum0")
+    kern.op("zero", "accum1")
+    for i in range(h):
+        kern.op("zero", "accum2")
+        for j in range(h):
+            if j <= i:
+                kern.op("mac", "accum2", "a", j, B, i - j)
+                kern.op("mac", "accum1", "aa", j, BB, i - j)
+                kern.op("mac", "accum0", "a", j + h, B, i - j + h)
+            else:
+                kern.op("mac", "accum2", "a", j, B, i - j + n)
+                kern.op("mac", "accum1", "aa", j, "bbb", i - j + h)
+                kern.op("mac", "accum0", "a", j + h, BB, i - j + h)
+        kern.op("subacc", "accum1", "accum2")
+        kern.op("addacc", "accum0", "accum2", 1)
+        kern.op("emit", i, "accum0")
+        kern.op("emit", i + h, "accum1")
+
+    # accum0 carries into limb h; accum1 has weight phi^2 = phi + 1.
+    kern.op("addacc", "accum0", "accum1", 1)
+    kern.op("addlimb", "accum0", h)
+    kern.op("addlimb", "accum1", 0)
+    kern.op("emit", h, "accum0")
+    kern.op("emit", 0, "accum1")
+    kern.op("addcarry", h + 1, "accum0")
+    kern.op("addcarry", 1, "accum1")
+    return merge_symmetric(kern) if sqr else kern
+
+# Addition chains.  Each step is ("sqr", dst, src, count) or
+# ("mul", dst, src1, src2) on named values; "x" is the input.
+def addition_chain(e):
+    exps = {"x": 1}
+    steps = []
+    ones = {1: "x"}         # L -> value holding x^(2^L - 1)
+    counter = [0]
+
+    def new(exp):
+        counter[0] += 1
+        name = "t%d" % counter[0]
+        exps[name] = exp
+        return name
+    def sqrn(src, k):
+        dst = new(exps[src] << k)
+        steps.append(("sqr", dst, src, k))
+        return dst
+    def mul(x, y):
+        dst = new(exps[x] + exps[y])
+        steps.append(("mul", dst, x, y))
+        return dst
+    def get(L):
+        if L not in ones:
+            splits = [s for s in ones if L - s in ones]
+            if splits:
+                s = max(splits)
+                ones[L] = mul(sqrn(ones[s], L - s), ones[L - s])
+            elif L % 2:
+                ones[L] = mul(sqrn(get(L - 1), 1), "x")
+            else:
+                half = get(L // 2)
+                ones[L] = mul(sqrn(half, L // 2), half)
+        return ones[L]
+
+    runs = [(len(o), len(z)) for o, z in re.findall(r"(1+)(0*)", bin(e)[2:])]
+    for L in sorted(set(L for L, _ in runs)):
+        get(L)
+    acc = ones[runs[0][0]]
+    for (_, z), (L, _) in zip(runs, runs[1:]):
+        acc = mul(sqrn(acc, z + L), ones[L])
+    if runs[-1][1]:
+        acc = sqrn(acc, runs[-1][1])
+    assert exps[acc] == e
+    return steps, acc
+
+def allocate(steps, out):
+    """Rename chain values onto as few temporaries as possible."""
+    last = {}
+    for i, s in enumerate(steps):
+        for v in s[2:4]:
+            if isinstance(v, str):
+                last[v] = i
+    regs, free, names = {"x": "x"}, [], 0
+    renamed = []
+    for i, s in enumerate(steps):
+        if s[1] == out:
+            dst = "a"
+        elif free:
+            dst = free.pop(0)
+        else:
+            dst = "L%d" % names
+            names += 1
+        srcs = [regs[v] if isinstance(v, str) else v for v in s[2:4]]
+        renamed.append((s[0], dst) + tuple(srcs))
+        for v in set(s[2:4]):
+            if isinstance(v, str) and v != "x" and last[v] == i:
+                free.append(regs[v])
+                free.sort()
+        regs[s[1]] = dst
+    return renamed, names
+
+def emit_chain(fname, steps, out):
+    renamed, temps = allocate(steps, out)
+    nsqr = sum(s[3] for s in steps if s[0] == "sqr")
+    nmul = sum(1 for s in steps if s[0] == "mul")
+    lines = ["/* %d squarings, %d multiplies */" % (nsqr, nmul),
+             "void",
+             "%s (" % fname,
+             "    field_a_t a,",
+             "    const field_a_t x",
+             ") {"]
+    if temps:
+        lines.append("    field_a_t %s;" % ", ".join("L%d" % i for i in range(temps)))
+    for s in renamed:
+        if s[0] == "sqr" and s[3] == 1:
+            lines.append("    field_sqr  ( %5s, %5s );" % (s[1], s[2]))
+        elif s[0] == "sqr":
+            lines.append("    field_sqrn ( %5s, %5s, %5d );" % (s[1], s[2], s[3]))
+        else:
+            lines.append("    field_mul  ( %5s, %5s, %5s );" % (s[1], s[2], s[3]))
+    lines.append("}")
+    return "\n".join(lines), nsqr, nmul
+
+def chains(field):
+    p = field.p
+    out = [("field_inverse", p - 2)]
+    if p % 4 == 3:
+        out = [("field_isr", (p - 3) // 4), ("field_sqrt", (p + 1) // 4)] + out
+    return [(name,) + emit_chain(name, *addition_chain(e)) for name, e in out]
+
+# C output
+def ctype(field):
+    return ("uint64_t", "__uint128_t", "widemul") if field.w == 64 \
+        else ("uint32_t", "uint64_t", "widemul_32")
+
+def emit_kernel(kern, prefix):
+    word, dword, wm = ctype(kern.field)
+    f = kern.field
+    args = ["    %s *__restrict__ c," % word, "    const %s *a%s" % (word, "" if kern.sqr else ",")]
+    if not kern.sqr:
+        args.append("    const %s *b" % word)
+    lines = ["void", "%s_%s (" % (prefix, kern.name)] + args + [") {"]
+    lines.append("    const %s mask = (((%s)1)<<%d) - 1;" % (word, word, f.r))
+    lines.append("    %s %s;" % (dword, ", ".join(kern.accs)))
+    for name in kern.pre:
+        lines.append("    %s %s[%d];" % (word, name, len(kern.arrays[name])))
+    for name in kern.pre:
+        for i, form in enumerate(kern.arrays[name]):
+            expr = []
+            for (v, j), k in sorted(form.items()):
+                expr.append("%s[%d]" % (v, j) if k == 1 else "%d*%s[%d]" % (k, v, j))
+            lines.append("    %s[%d] = %s;" % (name, i, " + ".join(expr)))
+    lines.append("")
+    fresh = set()
+    for o in kern.ops:
+        if o[0] == "zero":
+            fresh.add(o[1])
+        elif o[0] == "mac":
+            eq = "=" if o[1] in fresh else "+="
+            fresh.discard(o[1])
+            lines.append("    %s %s %s(%s[%d], %s[%d]);" % (o[1], eq, wm, o[2], o[3], o[4], o[5]))
+        elif o[0] in ("addacc", "addlimb"):
+            eq = "=" if o[1] in fresh else "+="
+            fresh.discard(o[1])
+            if o[0] == "addlimb":
+                src = "c[%d]" % o[2]
+            elif o[3] == 1:
+                src = o[2]
+            elif o[3] & (o[3] - 1) == 0:
+                src = "(%s << %d)" % (o[2], o[3].bit_length() - 1)
+            else:
+                src = "%s * %d" % (o[2], o[3])
+            lines.append("    %s %s %s;" % (o[1], eq, src))
+        elif o[0] == "subacc":
+            lines.append("    %s -= %s;" % (o[1], o[2]))
+        elif o[0] == "emit":
+            lines.append("    c[%d] = ((%s)%s) & mask;" % (o[1], word, o[2]))
+            lines.append("    %s >>= %d;" % (o[2], f.r))
+            lines.append("")
+        elif o[0] == "addcarry":
+            lines.append("    c[%d] += (%s)%s;" % (o[1], word, o[2]))
+    lines.append("}")
+    return "\n".join(lines)
+
+def bits(x):
+    # Round down, so that a bound just under 2^128 doesn't print as 2^128
+    return "2^%.2f" % (math.floor(log2(x) * 100) / 100)
+
+def proof_comment(kern, bound, out, steps):
+    f = kern.field
+    lines = ["%s: %d multiplies, input limbs <= 0x%x (%s)" % (kern.name, kern.muls(), bound, bits(bound))]
+    for limb, acc, hi in steps:
+        lines.append("    %s before c[%d]: <= %s < 2^%d" % (acc, limb, bits(hi), 2 * f.w))
+    lines.append("    output limbs <= 0x%x (%s)" % (max(out), bits(max(out))))
+    lines.append("    so inputs may be sums of up to %d outputs" % (bound // max(out)))
+    return lines
+
+def generate(field, prefix, mulstrat):
+    if mulstrat == "karatsuba" or (mulstrat == "auto" and field.golden):
+        if not field.golden:
+            raise ValueError("Karatsuba needs p = 2^(2k) - 2^k - 1 split into halves")
+        mul, sqr = karatsuba(field, False), karatsuba(field, True)
+        if mulstrat == "auto" and schoolbook(field, True).muls() < sqr.muls():
+            sqr = schoolbook(field, True)
+    else:
+        mul, sqr = schoolbook(field, False), schoolbook(field, True)
+
+    proofs, kerns = [], []
+    for kern in (mul, sqr):
+        bound = kern.max_bound()
+        ok, out, steps = kern.prove(bound)
+        assert ok
+        if max(out) > bound:
+            raise ValueError("%s output limbs exceed its input bound" % kern.name)
+        kern.bound, kern.out = bound, max(out)
+        proofs += proof_comment(kern, bound, out, steps) + [""]
+        kerns.append(kern)
+
+    word, dword, wm = ctype(field)
+    src = ["/* Generated by aux/fieldgen.py for p = 0x%x," % field.p,
+           " * %d limbs of %d bits in %d-bit words.  Do not edit." % (field.n, field.r, field.w),
+           " *",
+           " * Bound proof:"]
+    src += [(" *   " + l).rstrip() for l in proofs]
+    src += [" */", "", "#include <stdint.h>", "",
+            "static inline %s %s(const %s a, const %s b) {" % (dword, wm, word, word),
+            "    return ((%s)a) * b;" % dword, "}", ""]
+    for kern in kerns:
+        src += [emit_kernel(kern, prefix), ""]
+    src += ["#ifdef FIELDGEN_CHAINS", "/* For src/$(FIELD)/f_arithmetic.c */", ""]
+    chain_info = []
+    for name, text, nsqr, nmul in chains(field):
+        src += [text, ""]
+        chain_info.append((name, nsqr, nmul))
+    src += ["#endif /* FIELDGEN_CHAINS */", ""]
+    return "\n".join(src), kerns, proofs, chain_info
+
+def selftest(field, kerns, count=2000):
+    rng = random.Random(1)
+    for kern in kerns:
+        n = field.n
+        # Extremes (all zero, all at the bound), then random limbs up to it
+        tests = [([0] * n, [0] * n), ([kern.bound] * n, [kern.bound] * n)]
+        for _ in range(count):
+            tests.append(([rng.randint(0, kern.bound) for _ in range(n)],
+                          [rng.randint(0, kern.bound) for _ in range(n)]))
+        for a, b in tests:
+            c = kern.run(a, b)
+            want = field.value(a) * field.value(a if kern.sqr else b) % field.p
+            assert field.value(c) == want, (kern.name, a, b)
+            assert max(c) <= kern.out
+
+HARNESS = r"""
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+typedef struct { %(word)s limb[%(n)d]; } __attribute__((aligned(32))) fe_t;
+void %(gen)s_mul (%(word)s *__restrict__ c, const %(word)s *a, const %(word)s *b);
+void %(gen)s_sqr (%(word)s *__restrict__ c, const %(word)s *a);
+#if HAND
+void %(hand)s_mul (fe_t *__restrict__ c, const fe_t *a, const fe_t *b);
+void %(hand)s_sqr (fe_t *__restrict__ c, const fe_t *a);
+#endif
+
+static double now (void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void put (const fe_t *x) {
+    int i;
+    for (i=0; i<%(n)d; i++) printf(" %%llx", (unsigned long long)x->limb[i]);
+}
+
+#define BENCH(what, op) do { \
+    double t = now(); \
+    for (i=0; i<iters; i++) { op; } \
+    printf("bench %%s %%.2f\n", what, (now() - t) * 1e9 / iters); \
+} while (0)
+
+int main (void) {
+    fe_t a, b, c, d;
+    unsigned long long x;
+    int i, hand, iters = 200000;
+    while (scanf("%%d", &hand) == 1) {
+        for (i=0; i<%(n)d; i++) { if (scanf("%%llx", &x) != 1) return 1; a.limb[i] = x; }
+        for (i=0; i<%(n)d; i++) { if (scanf("%%llx", &x) != 1) return 1; b.limb[i] = x; }
+        %(gen)s_mul(c.limb, a.limb, b.limb); printf("gmul"); put(&c);
+        %(gen)s_sqr(d.limb, a.limb); printf(" gsqr"); put(&d);
+#if HAND
+        if (hand) {
+            %(hand)s_mul(&c, &a, &b); printf(" hmul"); put(&c);
+            %(hand)s_sqr(&d, &a); printf(" hsqr"); put(&d);
+        }
+#endif
+        printf("\n");
+    }
+    /* Dependency chains, as in test/bench_field.c */
+    BENCH("gen_mul", { %(gen)s_mul(c.limb, a.limb, b.limb); %(gen)s_mul(a.limb, c.limb, b.limb); });
+    BENCH("gen_sqr", { %(gen)s_sqr(c.limb, a.limb); %(gen)s_sqr(a.limb, c.limb); });
+#if HAND
+    BENCH("hand_mul", { %(hand)s_mul(&c, &a, &b); %(hand)s_mul(&a, &c, &b); });
+    BENCH("hand_sqr", { %(hand)s_sqr(&c, &a); %(hand)s_sqr(&a, &c); });
+#endif
+    return 0;
+}
+"""
+
+def check(field, src, kerns, prefix, hand_obj, cc):
+    """Compile the kernels, test them against Python and the hand-written ones."""
+    word = ctype(field)[0]
+    with tempfile.TemporaryDirectory(prefix="fieldgen") as tmp:
+        gen = "fieldgen_%s" % prefix
+        cfile, hfile, exe = [os.path.join(tmp, x) for x in ("gen.c", "harness.c", "harness")]
+        with open(cfile, "w") as fp:
+            fp.write(src.replace("%s_" % prefix, "%s_" % gen))
+        with open(hfile, "w") as fp:
+            fp.write(HARNESS % dict(word=word, n=field.n, gen=gen, hand=prefix))
+        cmd = cc.split() + ["-std=gnu99", "-O3", "-DHAND=%d" % bool(hand_obj), "-o", exe,
+                            hfile, cfile] + ([hand_obj] if hand_obj else [])
+        subprocess.check_call(cmd)
+
+        # Hand-written kernels take reduced limbs; the generated ones are
+        # also run at their proven bound.
+        rng = random.Random(2)
+        bound = min(k.bound for k in kerns)
+        vectors = []
+        for t in range(1000):
+            top = (1 << field.r) - 1 if t % 2 else bound
+            a = [rng.randint(0, top) for _ in range(field.n)]
+            b = [rng.randint(0, top) for _ in range(field.n)]
+            vectors.append((t % 2, a, b))
+        vectors.append((0, [bound] * field.n, [bound] * field.n))
+        inp = "".join("%d %s %s\n" % (h, " ".join("%x" % x for x in a), " ".join("%x" % x for x in b))
+                      for h, a, b in vectors)
+        out = subprocess.run([exe], input=inp, capture_output=True, text=True, check=True).stdout
+
+        lines = out.splitlines()
+        for (h, a, b), line in zip(vectors, lines):
+            parts = re.findall(r"([gh](?:mul|sqr))((?: [0-9a-f]+)+)", line)
+            for tag, limbs in parts:
+                c = [int(x, 16) for x in limbs.split()]
+                want = field.value(a) * field.value(b if tag.endswith("mul") else a) % field.p
+                if field.value(c) != want:
+                    raise AssertionError("%s wrong on a=%s b=%s" % (tag, a, b))
+        return [l.split()[1:] for l in lines if l.startswith("bench")]
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("--config", choices=sorted(CONFIGS), help="a known field backend")
+    ap.add_argument("--prime", help="eg 2^448-2^224-1")
+    ap.add_argument("--limbs", type=int)
+    ap.add_argument("--radix", type=int, help="bits per limb (default: as few as fit)")
+    ap.add_argument("--word", type=int, choices=(32, 64), default=64)
+    ap.add_argument("--prefix", help="function name prefix (default p<bits>)")
+    ap.add_argument("--mul", choices=("auto", "schoolbook", "karatsuba"), default="auto")
+    ap.add_argument("-o", "--output", help="write the C here")
+    ap.add_argument("--check", metavar="OBJ", nargs="?", const="",
+                    help="compile and test the kernels, comparing with OBJ if given")
+    ap.add_argument("--cc", default=os.environ.get("CC", "cc"))
+    args = ap.parse_args()
+
+    opts = dict(CONFIGS[args.config]) if args.config else {}
+    for k in ("prime", "limbs", "word", "prefix"):
+        if getattr(args, k) is not None and (k != "word" or not args.config):
+            opts[k] = getattr(args, k)
+    if "prime" not in opts or "limbs" not in opts:
+        ap.error("need --config, or --prime and --limbs")
+    field = Field(parse_prime(opts["prime"]), opts["limbs"], opts.get("word", 64), args.radix)
+    prefix = opts.get("prefix") or "p%d" % field.p.bit_length()
+
+    src, kerns, proofs, chain_info = generate(field, prefix, args.mul)
+    selftest(field, kerns)
+    if args.output:
+        with open(args.output, "w") as fp:
+            fp.write(src)
+    elif args.check is None:
+        sys.stdout.write(src)
+
+    info = sys.stderr if args.check is None else sys.stdout
+    info.write("%s: %d limbs of %d bits, %s mul\n" % (opts["prime"], field.n, field.r,
+               "Karatsuba" if kerns[0].pre else "schoolbook"))
+    for l in proofs:
+        info.write("  " + l + "\n" if l else "")
+    for name, nsqr, nmul in chain_info:
+        info.write("  %s: %d sqr, %d mul\n" % (name, nsqr, nmul))
+    if args.check is not None:
+        for what, ns in check(field, src, kerns, prefix, args.check, args.cc):
+            info.write("  %-10s %8s ns\n" % (what, ns))
+        info.write("  OK\n")
+
+if __name__ == "__main__":
+    main()
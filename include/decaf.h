@@ -27,6 +27,7 @@
 
 #include <stdint.h>
 #include <sys/types.h>
+#include "decaf_common.h"
 
 /* Goldilocks' build flags default to hidden and stripping executables. */
 /** @cond internal */
@@ -42,18 +43,6 @@
 #define NONNULL4 __attribute__((nonnull(1,2,3,4)))
 #define NONNULL5 __attribute__((nonnull(1,2,3,4,5)))
 
-/* Internal word types */
-#if (defined(__ILP64__) || defined(__amd64__) || defined(__x86_64__) || (((__UINT_FAST32_MAX__)>>30)>>30)) \
-	 && !defined(DECAF_FORCE_32_BIT)
-#define DECAF_WORD_BITS 64
-typedef uint64_t decaf_word_t, decaf_bool_t;
-typedef __uint128_t decaf_dword_t;
-#else
-#define DECAF_WORD_BITS 32
-typedef uint32_t decaf_word_t, decaf_bool_t;
-typedef uint64_t decaf_dword_t;
-#endif
-
 #define DECAF_448_LIMBS (512/DECAF_WORD_BITS)
 #define DECAF_448_SCALAR_BITS 446
 #define DECAF_448_SCALAR_LIMBS (448/DECAF_WORD_BITS)
@@ -82,6 +71,21 @@ typedef struct decaf_448_precomputed_s decaf_448_precomputed_s;
 /** Size and alignment of precomputed point tables. */
 extern const size_t sizeof_decaf_448_precomputed_s API_VIS, alignof_decaf_448_precomputed_s API_VIS;
 
+/** Precomputed variable-time (wNAF) table based on a point.  Can be trivial implementation. */
+struct decaf_448_precomputed_wnaf_s;
+
+/** Precomputed variable-time (wNAF) table based on a point.  Can be trivial implementation. */
+typedef struct decaf_448_precomputed_wnaf_s decaf_448_precomputed_wnaf_s;
+
+/** Precomputed comb table with runtime parameters.  Can be trivial implementation. */
+struct decaf_448_precomputed_comb_s;
+
+/** Precomputed comb table with runtime parameters.  Can be trivial implementation. */
+typedef struct decaf_448_precomputed_comb_s decaf_448_precomputed_comb_s;
+
+/** Size and alignment of precomputed wNAF tables. */
+extern const size_t sizeof_decaf_448_precomputed_wnaf_s API_VIS, alignof_decaf_448_precomputed_wnaf_s API_VIS;
+
 /** Scalar is stored packed, because we don't need the speed. */
 typedef struct decaf_448_scalar_s {
     /** @cond internal */
@@ -89,13 +93,6 @@ typedef struct decaf_448_scalar_s {
     /** @endcond */
 } decaf_448_scalar_t[1];
 
-/** DECAF_TRUE = -1 so that DECAF_TRUE & x = x */
-static const decaf_bool_t DECAF_TRUE = -(decaf_bool_t)1, DECAF_FALSE = 0;
-
-/** NB Success is -1, failure is 0.  TODO: see if people would rather the reverse. */
-static const decaf_bool_t DECAF_SUCCESS = -(decaf_bool_t)1 /*DECAF_TRUE*/,
-	DECAF_FAILURE = 0 /*DECAF_FALSE*/;
-
 /** A scalar equal to 1. */
 extern const decaf_448_scalar_t decaf_448_scalar_one API_VIS;
 
@@ -253,6 +250,26 @@ void decaf_448_point_encode (
     const decaf_448_point_t pt
 ) API_VIS NONNULL2 NOINLINE;
 
+/**
+ * @brief Double many points and encode the results:
+ * ser[i] = encode(2*pts[i]).
+ *
+ * The output is the same as doubling and calling decaf_448_point_encode
+ * on each point, but much faster: the square root in the encoding has a
+ * closed form for a doubled point, so the batch shares a single inversion.
+ * An arbitrary point has no such shortcut; to encode x*P for many x,
+ * compute (x/2)*P instead and pass that here.
+ *
+ * @param [out] ser The encodings, n*DECAF_448_SER_BYTES bytes.
+ * @param [in] pts The points to double and encode.
+ * @param [in] n The number of points.
+ */
+void decaf_448_point_double_and_encode_batch (
+    uint8_t *ser,
+    const decaf_448_point_t *pts,
+    size_t n
+) API_VIS NOINLINE;
+
 /**
  * @brief Decode a point from a sequence of bytes.
  *
@@ -426,6 +443,90 @@ void decaf_448_precomputed_scalarmul (
     const decaf_448_scalar_t scalar
 ) API_VIS NONNULL3 NOINLINE;
 
+/**
+ * @brief Size of a precomputed comb table with n combs of t teeth,
+ * spaced s apart.
+ *
+ * The table holds n*2^(t-1) points, and a scalar multiplication with it
+ * costs about n*s additions and s doublings.  The parameters must satisfy
+ * n >= 1, 2 <= t <= 8, s >= 1 and n*t*s >= DECAF_448_SCALAR_BITS.
+ *
+ * @param [in] n The number of combs.
+ * @param [in] t The number of teeth per comb.
+ * @param [in] s The spacing between teeth.
+ * @return The size in bytes, or 0 if the parameters are unsupported.
+ */
+size_t decaf_448_sizeof_precomputed_comb (
+    unsigned int n,
+    unsigned int t,
+    unsigned int s
+) API_VIS;
+
+/**
+ * @brief Alignment required of a precomputed comb table.
+ */
+size_t decaf_448_alignof_precomputed_comb (void) API_VIS;
+
+/**
+ * @brief Precompute a comb table with the given parameters, for fast
+ * scalar multiplication.  Like decaf_448_precompute, but with the table
+ * shape chosen at runtime.
+ *
+ * @param [out] a A table of decaf_448_sizeof_precomputed_comb(n,t,s) bytes.
+ * @param [in] n The number of combs.
+ * @param [in] t The number of teeth per comb.
+ * @param [in] s The spacing between teeth.
+ * @param [in] b Any point.
+ *
+ * @retval DECAF_SUCCESS The table was computed.
+ * @retval DECAF_FAILURE The parameters are unsupported.
+ */
+decaf_bool_t decaf_448_precompute_comb (
+    decaf_448_precomputed_comb_s *a,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
+    const decaf_448_point_t b
+) API_VIS NONNULL1 WARN_UNUSED NOINLINE;
+
+/**
+ * @brief Multiply a point by a scalar using its comb table:
+ * scaled = scalar*base.
+ *
+ * @param [out] scaled The scaled point base*scalar
+ * @param [in] base A table from decaf_448_precompute_comb.
+ * @param [in] scalar The scalar to multiply by.
+ */
+void decaf_448_precomputed_comb_scalarmul (
+    decaf_448_point_t scaled,
+    const decaf_448_precomputed_comb_s *base,
+    const decaf_448_scalar_t scalar
+) API_VIS NONNULL3 NOINLINE;
+
+/**
+ * @brief Multiply the base point by a scalar using one of the comb tables
+ * built into the library: scaled = scalar*decaf_448_point_base.
+ *
+ * The default (DECAF_COMBS_N,T,S) table is always built in; others are
+ * listed in DECAF_EXTRA_BASE_COMBS at build time.
+ *
+ * @param [out] scaled The scaled point base*scalar
+ * @param [in] n The number of combs.
+ * @param [in] t The number of teeth per comb.
+ * @param [in] s The spacing between teeth.
+ * @param [in] scalar The scalar to multiply by.
+ *
+ * @retval DECAF_SUCCESS The product was computed.
+ * @retval DECAF_FAILURE No such table is built in.
+ */
+decaf_bool_t decaf_448_precomputed_base_comb_scalarmul (
+    decaf_448_point_t scaled,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
+    const decaf_448_scalar_t scalar
+) API_VIS NONNULL1 WARN_UNUSED NOINLINE;
+
 /**
  * @brief Multiply two base points by two scalars:
  * scaled = scalar1*base1 + scalar2*base2.
@@ -447,6 +548,31 @@ void decaf_448_point_double_scalarmul (
     const decaf_448_scalar_t scalar2
 ) API_VIS NONNULL5 NOINLINE;
 
+/**
+ * @brief Multiply two base points by two scalars:
+ * combo = scalar1*base1 + scalar2*base2.
+ *
+ * Otherwise equivalent to decaf_448_point_double_scalarmul, but faster
+ * at the expense of being variable time.  The output may alias the
+ * inputs.
+ *
+ * @param [out] combo The linear combination scalar1*base1 + scalar2*base2.
+ * @param [in] base1 A first point to be scaled.
+ * @param [in] scalar1 A first scalar to multiply by.
+ * @param [in] base2 A second point to be scaled.
+ * @param [in] scalar2 A second scalar to multiply by.
+ *
+ * @warning: This function takes variable time, and may leak the scalars
+ * used.  It is designed for operations on public data.
+ */
+void decaf_448_point_double_scalarmul_non_secret (
+    decaf_448_point_t combo,
+    const decaf_448_point_t base1,
+    const decaf_448_scalar_t scalar1,
+    const decaf_448_point_t base2,
+    const decaf_448_scalar_t scalar2
+) API_VIS NONNULL5 NOINLINE;
+
 /**
  * @brief Multiply two base points by two scalars:
  * scaled = scalar1*decaf_448_point_base + scalar2*base2.
@@ -469,6 +595,87 @@ void decaf_448_base_double_scalarmul_non_secret (
     const decaf_448_scalar_t scalar2
 ) API_VIS NONNULL4 NOINLINE;
 
+/**
+ * @brief Multiply a point by a scalar: scaled = scalar*base.
+ *
+ * Otherwise equivalent to decaf_448_point_scalarmul, but faster at the
+ * expense of being variable time.  The output may alias the input.
+ *
+ * @param [out] scaled The scaled point base*scalar
+ * @param [in] base The point to be scaled.
+ * @param [in] scalar The scalar to multiply by.
+ *
+ * @warning: This function takes variable time, and may leak the scalar
+ * used.  It is designed for operations on public data, such as checking
+ * proofs and commitments.
+ */
+void decaf_448_point_scalarmul_non_secret (
+    decaf_448_point_t scaled,
+    const decaf_448_point_t base,
+    const decaf_448_scalar_t scalar
+) API_VIS NONNULL3 NOINLINE;
+
+/**
+ * @brief Precompute a wNAF table for a point that will be used in many
+ * variable-time multiplications, such as a signer's public key.
+ * Some implementations do not include precomputed points; for
+ * those implementations, this implementation simply copies the
+ * point.
+ *
+ * @param [out] a A precomputed table of odd multiples of the point.
+ * @param [in] b Any point.
+ */
+void decaf_448_precompute_wnaf (
+    decaf_448_precomputed_wnaf_s *a,
+    const decaf_448_point_t b
+) API_VIS NONNULL2 NOINLINE;
+
+/**
+ * @brief Multiply two base points by two scalars:
+ * combo = scalar1*decaf_448_point_base + scalar2*base2, where base2
+ * has been precomputed with decaf_448_precompute_wnaf.
+ *
+ * Otherwise equivalent to decaf_448_base_double_scalarmul_non_secret,
+ * but faster because base2's table is already built.
+ *
+ * @param [out] combo The linear combination scalar1*base + scalar2*base2.
+ * @param [in] scalar1 A first scalar to multiply by.
+ * @param [in] base2 A precomputed second point to be scaled.
+ * @param [in] scalar2 A second scalar to multiply by.
+ *
+ * @warning: This function takes variable time, and may leak the scalars
+ * used.  It is designed for signature verification.
+ */
+void decaf_448_base_double_scalarmul_wnaf_non_secret (
+    decaf_448_point_t combo,
+    const decaf_448_scalar_t scalar1,
+    const decaf_448_precomputed_wnaf_s *base2,
+    const decaf_448_scalar_t scalar2
+) API_VIS NONNULL4 NOINLINE;
+
+/**
+ * @brief Multiply many points by many scalars and sum the results:
+ * combo = sum(scalars[i]*bases[i]) for 0 <= i < n.
+ *
+ * The output may alias any of the inputs.  If n is 0, the result is the
+ * identity.
+ *
+ * @param [out] combo The linear combination.
+ * @param [in] bases The points to be scaled.
+ * @param [in] scalars The scalars to multiply by.
+ * @param [in] n The number of points and scalars.
+ *
+ * @warning: This function takes variable time, and may leak the scalars
+ * used.  It is designed for batch signature verification and other
+ * operations on public data.
+ */
+void decaf_448_multiscalarmul_non_secret (
+    decaf_448_point_t combo,
+    const decaf_448_point_t *bases,
+    const decaf_448_scalar_t *scalars,
+    size_t n
+) API_VIS NONNULL1 NOINLINE;
+
 /**
  * @brief Test that a point is valid, for debugging purposes.
  *
@@ -594,21 +801,11 @@ unsigned char decaf_448_point_from_hash_uniform (
 ) API_VIS NONNULL2 NOINLINE;
 
 /**
- * @brief Overwrite data with zeros.  Uses memset_s if available.
+ * @brief The name of the field arithmetic backend, eg "arch_x86_64".
+ * If the library was built with runtime dispatch, this is the backend
+ * that was picked for this CPU.
  */
-void decaf_bzero (
-   void *data,
-   size_t size
-) NONNULL1 API_VIS NOINLINE;
-
-/**
- * @brief Compare two buffers, returning DECAF_TRUE if they are equal.
- */
-decaf_bool_t decaf_memeq (
-   const void *data1,
-   const void *data2,
-   size_t size
-) NONNULL2 WARN_UNUSED API_VIS NOINLINE;
+const char *decaf_448_field_backend (void) WARN_UNUSED API_VIS NOINLINE;
 
 /**
  * @brief Overwrite scalar with zeros.
@@ -633,6 +830,20 @@ void decaf_448_precomputed_destroy (
   decaf_448_precomputed_s *pre
 ) NONNULL1 API_VIS;
 
+/**
+ * @brief Overwrite a precomputed comb table with zeros.
+ */
+void decaf_448_precomputed_comb_destroy (
+  decaf_448_precomputed_comb_s *pre
+) NONNULL1 API_VIS;
+
+/**
+ * @brief Overwrite a precomputed wNAF table with zeros.
+ */
+void decaf_448_precomputed_wnaf_destroy (
+  decaf_448_precomputed_wnaf_s *pre
+) NONNULL1 API_VIS;
+
 /* TODO: functions to invert point_from_hash?? */
 
 #undef API_VIS
@@ -378,6 +378,23 @@ public:
     }
 };
 
+/**
+ * @brief A scalar which is public, so that multiplying a point by it may
+ * take variable time: p * NonSecret(s).
+ * @warning The time taken leaks the scalar.  Don't use this on secrets.
+ */
+class NonSecret {
+public:
+    /** @brief The scalar, which must outlive this. */
+    const Scalar &s;
+    
+    /** @brief Mark s as public. */
+    inline explicit NonSecret(const Scalar &s) NOEXCEPT : s(s) {}
+    
+    /** @brief Variable-time scalarmul with scalar on left. */
+    inline Point operator* (const Point &q) const NOEXCEPT { return q * (*this); }
+};
+
 /**
  * @brief Element of prime-order group.
  */
@@ -544,6 +561,12 @@ public:
     /** @brief Scalar multiply in place. */
     inline Point &operator*=(const Scalar &s)       NOEXCEPT { decaf_448_point_scalarmul(p,p,s.s); return *this; }
     
+    /** @brief Variable-time scalar multiply, by a public scalar. */
+    inline Point  operator* (const NonSecret &s) const NOEXCEPT { Point r((NOINIT())); decaf_448_point_scalarmul_non_secret(r.p,p,s.s.s); return r; }
+    
+    /** @brief Variable-time scalar multiply in place, by a public scalar. */
+    inline Point &operator*=(const NonSecret &s)       NOEXCEPT { decaf_448_point_scalarmul_non_secret(p,p,s.s.s); return *this; }
+    
     /** @brief Multiply by s.inverse().  If s=0, maps to the identity. */
     inline Point  operator/ (const Scalar &s) const NOEXCEPT { return (*this) * s.inverse(); }
     
@@ -570,6 +593,16 @@ public:
         Point p((NOINIT())); decaf_448_point_double_scalarmul(p.p,q.p,qs.s,r.p,rs.s); return p;
     }
     
+    /**
+     * @brief Double-scalar multiply, equivalent to q*qs + r*rs but faster.
+     * @warning This function takes variable time, and may leak the scalars.
+     */
+    static inline Point double_scalarmul_non_secret (
+        const Point &q, const Scalar &qs, const Point &r, const Scalar &rs
+    ) NOEXCEPT {
+        Point p((NOINIT())); decaf_448_point_double_scalarmul_non_secret(p.p,q.p,qs.s,r.p,rs.s); return p;
+    }
+    
     /**
      * @brief Double-scalar multiply: this point by the first scalar and base by the second scalar.
      * @warning This function takes variable time, and may leak the scalars (or points, but currently
@@ -0,0 +1,435 @@
+/**
+ * @file decaf_521.h
+ * @author Mike Hamburg
+ *
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ *
+ * @brief A group of prime order q, on E-521.
+ *
+ * This is the same API as decaf.h, over E-521, the curve
+ * x^2 + y^2 = 1 - 376014 x^2 y^2 mod 2^521 - 1.  See decaf.h for the
+ * documentation of each function.  Build it with FIELD=p521
+ * ARCH=arch_x86_64_r12, which produces libdecaf_521.
+ */
+#ifndef __DECAF_521_H__
+#define __DECAF_521_H__ 1
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "decaf_common.h"
+
+/* Goldilocks' build flags default to hidden and stripping executables. */
+/** @cond internal */
+#if defined(DOXYGEN) && !defined(__attribute__)
+#define __attribute__((x))
+#endif
+#define API_VIS __attribute__((visibility("default")))
+#define NOINLINE  __attribute__((noinline))
+#define WARN_UNUSED __attribute__((warn_unused_result))
+#define NONNULL1 __attribute__((nonnull(1)))
+#define NONNULL2 __attribute__((nonnull(1,2)))
+#define NONNULL3 __attribute__((nonnull(1,2,3)))
+#define NONNULL4 __attribute__((nonnull(1,2,3,4)))
+#define NONNULL5 __attribute__((nonnull(1,2,3,4,5)))
+
+/* arch_x86_64_r12 pads the 9 limbs to 12, for its vector layout */
+#define DECAF_521_LIMBS (768/DECAF_WORD_BITS)
+#define DECAF_521_SCALAR_BITS 519
+#define DECAF_521_SCALAR_LIMBS ((DECAF_521_SCALAR_BITS+DECAF_WORD_BITS-1)/DECAF_WORD_BITS)
+
+/** Galois field element internal structure */
+typedef struct gf_521_s {
+    decaf_word_t limb[DECAF_521_LIMBS];
+} __attribute__((aligned(32))) gf_521_s, gf_521[1];
+/** @endcond */
+
+/** Number of bytes in a serialized point. */
+#define DECAF_521_SER_BYTES 66
+
+/** Number of bytes in a serialized scalar. */
+#define DECAF_521_SCALAR_BYTES 65
+
+/** Twisted Edwards (-1,d-1) extended homogeneous coordinates */
+typedef struct decaf_521_point_s { /**@cond internal*/gf_521 x,y,z,t;/**@endcond*/ } decaf_521_point_t[1];
+
+/** Precomputed table based on a point.  Can be trivial implementation. */
+struct decaf_521_precomputed_s;
+
+/** Precomputed table based on a point.  Can be trivial implementation. */
+typedef struct decaf_521_precomputed_s decaf_521_precomputed_s; 
+
+/** Size and alignment of precomputed point tables. */
+extern const size_t sizeof_decaf_521_precomputed_s API_VIS, alignof_decaf_521_precomputed_s API_VIS;
+
+/** Precomputed variable-time (wNAF) table based on a point.  Can be trivial implementation. */
+struct decaf_521_precomputed_wnaf_s;
+
+/** Precomputed variable-time (wNAF) table based on a point.  Can be trivial implementation. */
+typedef struct decaf_521_precomputed_wnaf_s decaf_521_precomputed_wnaf_s;
+
+/** Precomputed comb table with runtime parameters.  Can be trivial implementation. */
+struct decaf_521_precomputed_comb_s;
+
+/** Precomputed comb table with runtime parameters.  Can be trivial implementation. */
+typedef struct decaf_521_precomputed_comb_s decaf_521_precomputed_comb_s;
+
+/** Size and alignment of precomputed wNAF tables. */
+extern const size_t sizeof_decaf_521_precomputed_wnaf_s API_VIS, alignof_decaf_521_precomputed_wnaf_s API_VIS;
+
+/** Scalar is stored packed, because we don't need the speed. */
+typedef struct decaf_521_scalar_s {
+    /** @cond internal */
+    decaf_word_t limb[DECAF_521_SCALAR_LIMBS];
+    /** @endcond */
+} decaf_521_scalar_t[1];
+
+/** A scalar equal to 1. */
+extern const decaf_521_scalar_t decaf_521_scalar_one API_VIS;
+
+/** A scalar equal to 0. */
+extern const decaf_521_scalar_t decaf_521_scalar_zero API_VIS;
+
+/** The identity point on the curve. */
+extern const decaf_521_point_t decaf_521_point_identity API_VIS;
+
+/** An arbitrarily chosen base point on the curve. */
+extern const decaf_521_point_t decaf_521_point_base API_VIS;
+
+/** Precomputed table for the base point on the curve. */
+extern const struct decaf_521_precomputed_s *decaf_521_precomputed_base API_VIS;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Read a scalar from wire format or from bytes. */
+decaf_bool_t decaf_521_scalar_decode (
+    decaf_521_scalar_t out,
+    const unsigned char ser[DECAF_521_SCALAR_BYTES]
+) API_VIS WARN_UNUSED NONNULL2 NOINLINE;
+
+/** Read a scalar from wire format or from bytes.  Reduces mod scalar prime. */
+void decaf_521_scalar_decode_long (
+    decaf_521_scalar_t out,
+    const unsigned char *ser,
+    size_t ser_len
+) API_VIS NONNULL2 NOINLINE;
+    
+/** Serialize a scalar to wire format. */
+void decaf_521_scalar_encode (
+    unsigned char ser[DECAF_521_SCALAR_BYTES],
+    const decaf_521_scalar_t s
+) API_VIS NONNULL2 NOINLINE NOINLINE;
+        
+/** Add two scalars.  The scalars may use the same memory. */
+void decaf_521_scalar_add (
+    decaf_521_scalar_t out,
+    const decaf_521_scalar_t a,
+    const decaf_521_scalar_t b
+) API_VIS NONNULL3 NOINLINE;
+
+/** Compare two scalars. */
+decaf_bool_t decaf_521_scalar_eq (
+    const decaf_521_scalar_t a,
+    const decaf_521_scalar_t b
+) API_VIS WARN_UNUSED NONNULL2 NOINLINE;
+
+/** Subtract two scalars.  The scalars may use the same memory. */
+void decaf_521_scalar_sub (
+    decaf_521_scalar_t out,
+    const decaf_521_scalar_t a,
+    const decaf_521_scalar_t b
+) API_VIS NONNULL3 NOINLINE;
+
+/** Multiply two scalars.  The scalars may use the same memory. */
+void decaf_521_scalar_mul (
+    decaf_521_scalar_t out,
+    const decaf_521_scalar_t a,
+    const decaf_521_scalar_t b
+) API_VIS NONNULL3 NOINLINE;
+
+/** Invert a scalar.  When passed zero, return 0.  The input and output may alias. */
+decaf_bool_t decaf_521_scalar_invert (
+    decaf_521_scalar_t out,
+    const decaf_521_scalar_t a
+) API_VIS NONNULL2 NOINLINE;
+
+/** Copy a scalar.  The scalars may use the same memory, in which case this function does nothing. */
+static inline void NONNULL2 decaf_521_scalar_copy (
+    decaf_521_scalar_t out,
+    const decaf_521_scalar_t a
+) {
+    *out = *a;
+}
+
+/** Set a scalar to an integer. */
+void decaf_521_scalar_set(
+    decaf_521_scalar_t out,
+    decaf_word_t a
+) API_VIS NONNULL1;
+
+/** Encode a point as a sequence of bytes. */
+void decaf_521_point_encode (
+    uint8_t ser[DECAF_521_SER_BYTES],
+    const decaf_521_point_t pt
+) API_VIS NONNULL2 NOINLINE;
+
+/** Double many points and encode the results: ser[i] = encode(2*pts[i]). */
+void decaf_521_point_double_and_encode_batch (
+    uint8_t *ser,
+    const decaf_521_point_t *pts,
+    size_t n
+) API_VIS NOINLINE;
+
+/** Decode a point from a sequence of bytes. */
+decaf_bool_t decaf_521_point_decode (
+    decaf_521_point_t pt,
+    const uint8_t ser[DECAF_521_SER_BYTES],
+    decaf_bool_t allow_identity
+) API_VIS WARN_UNUSED NONNULL2 NOINLINE;
+
+/** Copy a point.  The input and output may alias, in which case this function does nothing. */
+static inline void NONNULL2 decaf_521_point_copy (
+    decaf_521_point_t a,
+    const decaf_521_point_t b
+) {
+    *a=*b;
+}
+
+/** Test whether two points are equal.  If yes, return DECAF_TRUE, else return DECAF_FALSE. */
+decaf_bool_t decaf_521_point_eq (
+    const decaf_521_point_t a,
+    const decaf_521_point_t b
+) API_VIS WARN_UNUSED NONNULL2 NOINLINE;
+
+/** Add two points to produce a third point.  The input points and output point can be pointers to the same memory. */
+void decaf_521_point_add (
+    decaf_521_point_t sum,
+    const decaf_521_point_t a,
+    const decaf_521_point_t b
+) API_VIS NONNULL3;
+
+/** Double a point.  Equivalent to decaf_521_point_add(two_a,a,a), but potentially faster. */
+void decaf_521_point_double (
+    decaf_521_point_t two_a,
+    const decaf_521_point_t a
+) API_VIS NONNULL2;
+
+/** Subtract two points to produce a third point.  The input points and output point can be pointers to the same memory. */
+void decaf_521_point_sub (
+    decaf_521_point_t diff,
+    const decaf_521_point_t a,
+    const decaf_521_point_t b
+) API_VIS NONNULL3;
+    
+/** Negate a point to produce another point.  The input and output points can use the same memory. */
+void decaf_521_point_negate (
+   decaf_521_point_t nega,
+   const decaf_521_point_t a
+) API_VIS NONNULL2;
+
+/** Multiply a base point by a scalar: scaled = scalar*base. */
+void decaf_521_point_scalarmul (
+    decaf_521_point_t scaled,
+    const decaf_521_point_t base,
+    const decaf_521_scalar_t scalar
+) API_VIS NONNULL3 NOINLINE;
+
+/** Multiply a base point by a scalar: scaled = scalar*base. */
+decaf_bool_t decaf_521_direct_scalarmul (
+    uint8_t scaled[DECAF_521_SER_BYTES],
+    const uint8_t base[DECAF_521_SER_BYTES],
+    const decaf_521_scalar_t scalar,
+    decaf_bool_t allow_identity,
+    decaf_bool_t short_circuit
+) API_VIS NONNULL3 WARN_UNUSED NOINLINE;
+
+/** Precompute a table for fast scalar multiplication. */
+void decaf_521_precompute (
+    decaf_521_precomputed_s *a,
+    const decaf_521_point_t b
+) API_VIS NONNULL2 NOINLINE;
+
+/** Multiply a precomputed base point by a scalar: scaled = scalar*base. */
+void decaf_521_precomputed_scalarmul (
+    decaf_521_point_t scaled,
+    const decaf_521_precomputed_s *base,
+    const decaf_521_scalar_t scalar
+) API_VIS NONNULL3 NOINLINE;
+
+/** Size of a precomputed comb table with n combs of t teeth, spaced s apart. */
+size_t decaf_521_sizeof_precomputed_comb (
+    unsigned int n,
+    unsigned int t,
+    unsigned int s
+) API_VIS;
+
+/** Alignment required of a precomputed comb table. */
+size_t decaf_521_alignof_precomputed_comb (void) API_VIS;
+
+/** Precompute a comb table with the given parameters, for fast scalar multiplication.  Like decaf_521_precompute, but with the table shape chosen at runtime. */
+decaf_bool_t decaf_521_precompute_comb (
+    decaf_521_precomputed_comb_s *a,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
+    const decaf_521_point_t b
+) API_VIS NONNULL1 WARN_UNUSED NOINLINE;
+
+/** Multiply a point by a scalar using its comb table: scaled = scalar*base. */
+void decaf_521_precomputed_comb_scalarmul (
+    decaf_521_point_t scaled,
+    const decaf_521_precomputed_comb_s *base,
+    const decaf_521_scalar_t scalar
+) API_VIS NONNULL3 NOINLINE;
+
+/** Multiply the base point by a scalar using one of the comb tables built into the library: scaled = scalar*decaf_521_point_base. */
+decaf_bool_t decaf_521_precomputed_base_comb_scalarmul (
+    decaf_521_point_t scaled,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
+    const decaf_521_scalar_t scalar
+) API_VIS NONNULL1 WARN_UNUSED NOINLINE;
+
+/** Multiply two base points by two scalars: scaled = scalar1*base1 + scalar2*base2. */
+void decaf_521_point_double_scalarmul (
+    decaf_521_point_t combo,
+    const decaf_521_point_t base1,
+    const decaf_521_scalar_t scalar1,
+    const decaf_521_point_t base2,
+    const decaf_521_scalar_t scalar2
+) API_VIS NONNULL5 NOINLINE;
+
+/** Multiply two base points by two scalars, in variable time: combo = scalar1*base1 + scalar2*base2. */
+void decaf_521_point_double_scalarmul_non_secret (
+    decaf_521_point_t combo,
+    const decaf_521_point_t base1,
+    const decaf_521_scalar_t scalar1,
+    const decaf_521_point_t base2,
+    const decaf_521_scalar_t scalar2
+) API_VIS NONNULL5 NOINLINE;
+
+/** Multiply two base points by two scalars: scaled = scalar1*decaf_521_point_base + scalar2*base2. */
+void decaf_521_base_double_scalarmul_non_secret (
+    decaf_521_point_t combo,
+    const decaf_521_scalar_t scalar1,
+    const decaf_521_point_t base2,
+    const decaf_521_scalar_t scalar2
+) API_VIS NONNULL4 NOINLINE;
+
+/** Multiply a point by a scalar, in variable time: scaled = scalar*base. */
+void decaf_521_point_scalarmul_non_secret (
+    decaf_521_point_t scaled,
+    const decaf_521_point_t base,
+    const decaf_521_scalar_t scalar
+) API_VIS NONNULL3 NOINLINE;
+
+/** Precompute a wNAF table for a point that will be used in many variable-time multiplications, such as a signer's public key. */
+void decaf_521_precompute_wnaf (
+    decaf_521_precomputed_wnaf_s *a,
+    const decaf_521_point_t b
+) API_VIS NONNULL2 NOINLINE;
+
+/** Multiply two base points by two scalars: combo = scalar1*decaf_521_point_base + scalar2*base2, where base2 has been precomputed with decaf_521_precompute_wnaf. */
+void decaf_521_base_double_scalarmul_wnaf_non_secret (
+    decaf_521_point_t combo,
+    const decaf_521_scalar_t scalar1,
+    const decaf_521_precomputed_wnaf_s *base2,
+    const decaf_521_scalar_t scalar2
+) API_VIS NONNULL4 NOINLINE;
+
+/** Multiply many points by many scalars and sum the results: combo = sum(scalars[i]*bases[i]) for 0 <= i < n. */
+void decaf_521_multiscalarmul_non_secret (
+    decaf_521_point_t combo,
+    const decaf_521_point_t *bases,
+    const decaf_521_scalar_t *scalars,
+    size_t n
+) API_VIS NONNULL1 NOINLINE;
+
+/** Test that a point is valid, for debugging purposes. */
+decaf_bool_t decaf_521_point_valid (
+    const decaf_521_point_t toTest
+) API_VIS WARN_UNUSED NONNULL1 NOINLINE;
+
+/** 2-torque a point, for debugging purposes. */
+void decaf_521_point_debugging_2torque (
+     decaf_521_point_t q,
+     const decaf_521_point_t p
+) API_VIS NONNULL2 NOINLINE;
+
+/** Almost-Elligator-like hash to curve. */
+unsigned char
+decaf_521_point_from_hash_nonuniform (
+    decaf_521_point_t pt,
+    const unsigned char hashed_data[DECAF_521_SER_BYTES]
+) API_VIS NONNULL2 NOINLINE;
+
+/** Inverse of elligator-like hash to curve. */
+decaf_bool_t
+decaf_521_invert_elligator_nonuniform (
+    unsigned char recovered_hash[DECAF_521_SER_BYTES],
+    const decaf_521_point_t pt,
+    unsigned char hint
+) API_VIS NONNULL2 NOINLINE WARN_UNUSED;
+
+/** Inverse of elligator-like hash to curve, uniform. */
+decaf_bool_t
+decaf_521_invert_elligator_uniform (
+    unsigned char recovered_hash[2*DECAF_521_SER_BYTES],
+    const decaf_521_point_t pt,
+    unsigned char hint
+) API_VIS NONNULL2 NOINLINE WARN_UNUSED;
+
+/** Indifferentiable hash function encoding to curve. */
+unsigned char decaf_521_point_from_hash_uniform (
+    decaf_521_point_t pt,
+    const unsigned char hashed_data[2*DECAF_521_SER_BYTES]
+) API_VIS NONNULL2 NOINLINE;
+
+/** The name of the field arithmetic backend, eg "arch_x86_64". */
+const char *decaf_521_field_backend (void) WARN_UNUSED API_VIS NOINLINE;
+
+/** Overwrite scalar with zeros. */
+void decaf_521_scalar_destroy (
+  decaf_521_scalar_t scalar
+) NONNULL1 API_VIS;
+
+/** Overwrite point with zeros. */
+void decaf_521_point_destroy (
+  decaf_521_point_t point
+) NONNULL1 API_VIS;
+
+/** Overwrite point with zeros. */
+void decaf_521_precomputed_destroy (
+  decaf_521_precomputed_s *pre
+) NONNULL1 API_VIS;
+
+/** Overwrite a precomputed comb table with zeros. */
+void decaf_521_precomputed_comb_destroy (
+  decaf_521_precomputed_comb_s *pre
+) NONNULL1 API_VIS;
+
+/** Overwrite a precomputed wNAF table with zeros. */
+void decaf_521_precomputed_wnaf_destroy (
+  decaf_521_precomputed_wnaf_s *pre
+) NONNULL1 API_VIS;
+
+/* TODO: functions to invert point_from_hash?? */
+
+#undef API_VIS
+#undef WARN_UNUSED
+#undef NOINLINE
+#undef NONNULL1
+#undef NONNULL2
+#undef NONNULL3
+#undef NONNULL4
+#undef NONNULL5
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __DECAF_521_H__ */
@@ -55,6 +55,12 @@ typedef struct {
   /** A private key (gmp array[1] style). */
   decaf_448_private_key_t[1];
 
+/** A decoded public key with a precomputed table, for fast repeated verification. */
+typedef struct decaf_448_prepared_public_key_s decaf_448_prepared_public_key_s;
+
+/** A bounded least-recently-used cache of prepared public keys. */
+typedef struct decaf_448_public_key_cache_s decaf_448_public_key_cache_s;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -141,6 +147,28 @@ decaf_448_sign (
     size_t message_len
 ) NONNULL3 API_VIS;
 
+/**
+ * @brief Sign many messages at once.
+ *
+ * Produces the same signatures as calling decaf_448_sign on each message,
+ * but shares the work of encoding the nonce points, which makes each
+ * signature cheaper.
+ *
+ * @param [out] sigs The signatures.
+ * @param [in] privs The private key for each message.
+ * @param [in] messages The messages.
+ * @param [in] message_lens The messages' lengths.
+ * @param [in] n The number of messages.
+ */
+void
+decaf_448_sign_batch (
+    decaf_448_signature_t *sigs,
+    const decaf_448_private_key_s *const *privs,
+    const unsigned char *const *messages,
+    const size_t *message_lens,
+    size_t n
+) API_VIS;
+
 /**
  * @brief Verify a signed message from its SHAKE context.
  *
@@ -170,7 +198,145 @@ decaf_448_verify (
     const unsigned char *message,
     size_t message_len
 ) NONNULL3 API_VIS WARN_UNUSED;
-    
+
+/**
+ * @brief Verify many signed messages at once.
+ *
+ * The signatures are checked together with a random linear combination,
+ * which is much faster per signature than calling decaf_448_verify on each
+ * one.  The random coefficients are derived by hashing the whole batch, so
+ * the result is deterministic.
+ *
+ * If the combined check fails and results is non-NULL, the batch is split
+ * recursively to find out which signatures are bad.
+ *
+ * @param [out] results If non-NULL, results[i] is set to DECAF_SUCCESS or
+ * DECAF_FAILURE for each signature.
+ * @param [in] sigs The signatures.
+ * @param [in] pubs The public keys.
+ * @param [in] messages The messages.
+ * @param [in] message_lens The messages' lengths.
+ * @param [in] n The number of signatures.
+ *
+ * @retval DECAF_SUCCESS Every signature in the batch is valid.
+ * @retval DECAF_FAILURE At least one signature is invalid.
+ */
+decaf_bool_t
+decaf_448_verify_batch (
+    decaf_bool_t *results,
+    const decaf_448_signature_t *sigs,
+    const decaf_448_public_key_t *pubs,
+    const unsigned char *const *messages,
+    const size_t *message_lens,
+    size_t n
+) API_VIS WARN_UNUSED;
+
+/**
+ * @brief Decode a public key and precompute a table for verifying many
+ * signatures under it.
+ *
+ * @param [in] pub The public key.
+ * @return The prepared key, or NULL if pub is invalid or memory is short.
+ */
+decaf_448_prepared_public_key_s *
+decaf_448_prepared_public_key_create (
+    const decaf_448_public_key_t pub
+) NONNULL1 API_VIS WARN_UNUSED;
+
+/**
+ * @brief Destroy and free a prepared public key.  NULL is ignored.
+ */
+void decaf_448_prepared_public_key_destroy (
+    decaf_448_prepared_public_key_s *prep
+) API_VIS;
+
+/**
+ * @brief Verify a signed message from its SHAKE context, under a prepared
+ * public key.  Same result as decaf_448_verify_shake, but faster.
+ *
+ * @param [in] sig The signature.
+ * @param [in] prep The prepared public key.
+ * @param [in] shake A SHAKE256 context with the message.
+ */
+decaf_bool_t
+decaf_448_verify_prepared_shake (
+    const decaf_448_signature_t sig,
+    const decaf_448_prepared_public_key_s *prep,
+    const keccak_sponge_t shake
+) NONNULL3 API_VIS WARN_UNUSED;
+
+/**
+ * @brief Verify a signed message under a prepared public key.
+ * Same result as decaf_448_verify, but faster.
+ *
+ * @param [in] sig The signature.
+ * @param [in] prep The prepared public key.
+ * @param [in] message The message.
+ * @param [in] message_len The message's length.
+ */
+decaf_bool_t
+decaf_448_verify_prepared (
+    const decaf_448_signature_t sig,
+    const decaf_448_prepared_public_key_s *prep,
+    const unsigned char *message,
+    size_t message_len
+) NONNULL3 API_VIS WARN_UNUSED;
+
+/**
+ * @brief Create a cache holding up to capacity prepared public keys.
+ *
+ * When the cache is full, the least recently used key is evicted.
+ *
+ * @warning The cache is not thread-safe.  Use one per thread, or lock it.
+ *
+ * @param [in] capacity The maximum number of keys, which must be nonzero.
+ * @return The cache, or NULL if memory is short.
+ */
+decaf_448_public_key_cache_s *
+decaf_448_public_key_cache_create (
+    size_t capacity
+) API_VIS WARN_UNUSED;
+
+/**
+ * @brief Destroy and free a public key cache.  NULL is ignored.
+ */
+void decaf_448_public_key_cache_destroy (
+    decaf_448_public_key_cache_s *cache
+) API_VIS;
+
+/**
+ * @brief Look up a public key in the cache, preparing it on a miss.
+ *
+ * @param [in] cache The cache.
+ * @param [in] pub The public key.
+ * @return The prepared key, or NULL if pub is invalid or memory is short.
+ * It remains valid until the next call on the same cache.
+ */
+const decaf_448_prepared_public_key_s *
+decaf_448_public_key_cache_get (
+    decaf_448_public_key_cache_s *cache,
+    const decaf_448_public_key_t pub
+) NONNULL2 API_VIS WARN_UNUSED;
+
+/**
+ * @brief Verify a signed message, preparing the public key through a cache.
+ * Same result as decaf_448_verify.
+ *
+ * @param [in] cache The cache.
+ * @param [in] sig The signature.
+ * @param [in] pub The public key.
+ * @param [in] message The message.
+ * @param [in] message_len The message's length.
+ */
+decaf_bool_t
+decaf_448_verify_cached (
+    decaf_448_public_key_cache_s *cache,
+    const decaf_448_signature_t sig,
+    const decaf_448_public_key_t pub,
+    const unsigned char *message,
+    size_t message_len
+) NONNULL3 API_VIS WARN_UNUSED;
+
 #undef API_VIS
 #undef WARN_UNUSED
 #undef NONNULL1
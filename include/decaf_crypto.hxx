@@ -0,0 +1,153 @@
+/**
+ * @file decaf_crypto.hxx
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Example Decaf crypto routines, C++ wrapper.
+ * @warning Experimental!  The names, parameter orders etc are likely to change.
+ */
+
+#ifndef __DECAF_CRYPTO_HXX__
+#define __DECAF_CRYPTO_HXX__ 1
+
+#include "decaf.hxx"
+#include "decaf_crypto.h"
+#include <vector>
+
+/** @cond internal */
+#if __cplusplus >= 201103L
+#define NOEXCEPT noexcept
+#else
+#define NOEXCEPT throw()
+#endif
+/** @endcond */
+
+namespace decaf {
+
+/**
+ * @brief A batch of signatures to be verified together.
+ *
+ * The messages are not copied, so they must remain valid until the
+ * batch is verified or cleared.
+ */
+class SignatureBatch {
+private:
+    /** @cond internal */
+    std::vector<unsigned char> sigs_, pubs_;
+    std::vector<const unsigned char *> messages_;
+    std::vector<size_t> lens_;
+    /** @endcond */
+
+public:
+    /** @brief Add a signature to the batch. */
+    inline void add(
+        const Block &sig, const Block &pub, const Block &message
+    ) throw(LengthException) {
+        if (sig.size() != sizeof(decaf_448_signature_t)
+            || pub.size() != sizeof(decaf_448_public_key_t)) throw LengthException();
+        sigs_.insert(sigs_.end(), sig.data(), sig.data() + sig.size());
+        pubs_.insert(pubs_.end(), pub.data(), pub.data() + pub.size());
+        messages_.push_back(message.data());
+        lens_.push_back(message.size());
+    }
+
+    /** @brief Number of signatures in the batch. */
+    inline size_t size() const NOEXCEPT { return lens_.size(); }
+
+    /** @brief Empty the batch. */
+    inline void clear() NOEXCEPT {
+        sigs_.clear(); pubs_.clear(); messages_.clear(); lens_.clear();
+    }
+
+    /** @brief Return true if every signature in the batch is valid. */
+    inline bool verify() const NOEXCEPT {
+        if (!size()) return true;
+        return !!decaf_448_verify_batch(NULL,
+            (const decaf_448_signature_t *)&sigs_[0], (const decaf_448_public_key_t *)&pubs_[0],
+            &messages_[0], &lens_[0], size());
+    }
+
+    /**
+     * @brief Return true if every signature in the batch is valid,
+     * and set results[i] to whether the ith signature is valid.
+     */
+    inline bool verify(std::vector<bool> &results) const {
+        results.assign(size(), true);
+        if (!size()) return true;
+        std::vector<decaf_bool_t> rs(size());
+        decaf_bool_t ret = decaf_448_verify_batch(&rs[0],
+            (const decaf_448_signature_t *)&sigs_[0], (const decaf_448_public_key_t *)&pubs_[0],
+            &messages_[0], &lens_[0], size());
+        for (size_t i=0; i<size(); i++) results[i] = !!rs[i];
+        return !!ret;
+    }
+};
+
+/**
+ * @brief A decoded public key with a precomputed table, for verifying
+ * many signatures under the same key.
+ */
+class PreparedPublicKey {
+private:
+    /** @cond internal */
+    decaf_448_prepared_public_key_s *prep_;
+    PreparedPublicKey(const PreparedPublicKey &);            /* not copyable */
+    PreparedPublicKey &operator=(const PreparedPublicKey &); /* not copyable */
+    /** @endcond */
+
+public:
+    /** @brief Decode and prepare a public key. */
+    inline explicit PreparedPublicKey(const Block &pub)
+        throw(LengthException, CryptoException) : prep_(NULL) {
+        if (pub.size() != sizeof(decaf_448_public_key_t)) throw LengthException();
+        prep_ = decaf_448_prepared_public_key_create(pub.data());
+        if (!prep_) throw CryptoException();
+    }
+
+    /** @brief Destructor securely erases the table. */
+    inline ~PreparedPublicKey() NOEXCEPT { decaf_448_prepared_public_key_destroy(prep_); }
+
+    /** @brief Return true if sig is a valid signature on message. */
+    inline bool verify(const Block &sig, const Block &message) const NOEXCEPT {
+        if (sig.size() != sizeof(decaf_448_signature_t)) return false;
+        return !!decaf_448_verify_prepared(sig.data(), prep_, message.data(), message.size());
+    }
+};
+
+/**
+ * @brief A bounded least-recently-used cache of prepared public keys.
+ * @warning Not thread-safe.
+ */
+class PublicKeyCache {
+private:
+    /** @cond internal */
+    decaf_448_public_key_cache_s *cache_;
+    PublicKeyCache(const PublicKeyCache &);            /* not copyable */
+    PublicKeyCache &operator=(const PublicKeyCache &); /* not copyable */
+    /** @endcond */
+
+public:
+    /** @brief Create a cache holding up to capacity keys. */
+    inline explicit PublicKeyCache(size_t capacity) throw(std::bad_alloc)
+        : cache_(decaf_448_public_key_cache_create(capacity)) {
+        if (!cache_) throw std::bad_alloc();
+    }
+
+    /** @brief Destructor frees all the prepared keys. */
+    inline ~PublicKeyCache() NOEXCEPT { decaf_448_public_key_cache_destroy(cache_); }
+
+    /** @brief Return true if sig is a valid signature on message under pub. */
+    inline bool verify(const Block &sig, const Block &pub, const Block &message) NOEXCEPT {
+        if (sig.size() != sizeof(decaf_448_signature_t)
+            || pub.size() != sizeof(decaf_448_public_key_t)) return false;
+        return !!decaf_448_verify_cached(cache_, sig.data(), pub.data(),
+            message.data(), message.size());
+    }
+};
+
+} /* namespace decaf */
+
+#undef NOEXCEPT
+
+#endif /* __DECAF_CRYPTO_HXX__ */
@@ -0,0 +1,218 @@
+/**
+ * @file decaf_crypto_521.h
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Example Decaf crypto routines, on E-521.
+ *
+ * The same API as decaf_crypto.h; see there for the documentation.
+ * @warning Experimental!  The names, parameter orders etc are likely to change.
+ */
+
+#ifndef __DECAF_CRYPTO_521_H__
+#define __DECAF_CRYPTO_521_H__ 1
+
+#include "decaf_521.h"
+#include "shake.h"
+
+/** Number of bytes for a symmetric key (expanded to full key) */
+#define DECAF_521_SYMMETRIC_KEY_BYTES 32
+
+/** @cond internal */
+#define API_VIS __attribute__((visibility("default"))) __attribute__((noinline)) // TODO: synergize with decaf.h
+#define WARN_UNUSED __attribute__((warn_unused_result))
+#define NONNULL1 __attribute__((nonnull(1)))
+#define NONNULL2 __attribute__((nonnull(1,2)))
+#define NONNULL3 __attribute__((nonnull(1,2,3)))
+#define NONNULL134 __attribute__((nonnull(1,3,4)))
+#define NONNULL5 __attribute__((nonnull(1,2,3,4,5)))
+/** @endcond */
+
+/** A symmetric key, the compressed point of a private key. */
+typedef unsigned char decaf_521_symmetric_key_t[DECAF_521_SYMMETRIC_KEY_BYTES];
+
+/** An encoded public key. */
+typedef unsigned char decaf_521_public_key_t[DECAF_521_SER_BYTES];
+
+/** A signature. */
+typedef unsigned char decaf_521_signature_t[DECAF_521_SER_BYTES + DECAF_521_SCALAR_BYTES];
+
+typedef struct {
+    /** @cond intetrnal */
+    /** The symmetric key from which everything is expanded */
+    decaf_521_symmetric_key_t sym;
+    
+    /** The scalar x */
+    decaf_521_scalar_t secret_scalar;
+    
+    /** x*Base */
+    decaf_521_public_key_t pub;
+    /** @endcond */
+} /** Private key structure for pointers. */
+  decaf_521_private_key_s,
+  /** A private key (gmp array[1] style). */
+  decaf_521_private_key_t[1];
+
+/** A decoded public key with a precomputed table, for fast repeated verification. */
+typedef struct decaf_521_prepared_public_key_s decaf_521_prepared_public_key_s;
+
+/** A bounded least-recently-used cache of prepared public keys. */
+typedef struct decaf_521_public_key_cache_s decaf_521_public_key_cache_s;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+/** Derive a key from its compressed form. */
+void decaf_521_derive_private_key (
+    decaf_521_private_key_t priv,
+    const decaf_521_symmetric_key_t proto
+) NONNULL2 API_VIS;
+
+/** Destroy a private key. */
+void decaf_521_destroy_private_key (
+    decaf_521_private_key_t priv
+) NONNULL1 API_VIS;
+
+/** Convert a private key to a public one. */
+void decaf_521_private_to_public (
+    decaf_521_public_key_t pub,
+    const decaf_521_private_key_t priv
+) NONNULL2 API_VIS;
+    
+/** Compute a Diffie-Hellman shared secret. */
+decaf_bool_t
+decaf_521_shared_secret (
+    uint8_t *shared,
+    size_t shared_bytes,
+    const decaf_521_private_key_t my_privkey,
+    const decaf_521_public_key_t your_pubkey
+) NONNULL134 WARN_UNUSED API_VIS;
+   
+/** Sign a message from its SHAKE context. */
+void
+decaf_521_sign_shake (
+    decaf_521_signature_t sig,
+    const decaf_521_private_key_t priv,
+    const keccak_sponge_t shake
+) NONNULL3 API_VIS;
+
+/** Sign a message. */
+void
+decaf_521_sign (
+    decaf_521_signature_t sig,
+    const decaf_521_private_key_t priv,
+    const unsigned char *message,
+    size_t message_len
+) NONNULL3 API_VIS;
+
+/** Sign many messages at once. */
+void
+decaf_521_sign_batch (
+    decaf_521_signature_t *sigs,
+    const decaf_521_private_key_s *const *privs,
+    const unsigned char *const *messages,
+    const size_t *message_lens,
+    size_t n
+) API_VIS;
+
+/** Verify a signed message from its SHAKE context. */
+decaf_bool_t
+decaf_521_verify_shake (
+    const decaf_521_signature_t sig,
+    const decaf_521_public_key_t pub,
+    const keccak_sponge_t shake
+) NONNULL3 API_VIS WARN_UNUSED;
+
+/** Verify a signed message. */
+decaf_bool_t
+decaf_521_verify (
+    const decaf_521_signature_t sig,
+    const decaf_521_public_key_t pub,
+    const unsigned char *message,
+    size_t message_len
+) NONNULL3 API_VIS WARN_UNUSED;
+
+/** Verify many signed messages at once. */
+decaf_bool_t
+decaf_521_verify_batch (
+    decaf_bool_t *results,
+    const decaf_521_signature_t *sigs,
+    const decaf_521_public_key_t *pubs,
+    const unsigned char *const *messages,
+    const size_t *message_lens,
+    size_t n
+) API_VIS WARN_UNUSED;
+
+/** Decode a public key and precompute a table for verifying many signatures under it. */
+decaf_521_prepared_public_key_s *
+decaf_521_prepared_public_key_create (
+    const decaf_521_public_key_t pub
+) NONNULL1 API_VIS WARN_UNUSED;
+
+/** Destroy and free a prepared public key.  NULL is ignored. */
+void decaf_521_prepared_public_key_destroy (
+    decaf_521_prepared_public_key_s *prep
+) API_VIS;
+
+/** Verify a signed message from its SHAKE context, under a prepared public key.  Same result as decaf_521_verify_shake, but faster. */
+decaf_bool_t
+decaf_521_verify_prepared_shake (
+    const decaf_521_signature_t sig,
+    const decaf_521_prepared_public_key_s *prep,
+    const keccak_sponge_t shake
+) NONNULL3 API_VIS WARN_UNUSED;
+
+/** Verify a signed message under a prepared public key. */
+decaf_bool_t
+decaf_521_verify_prepared (
+    const decaf_521_signature_t sig,
+    const decaf_521_prepared_public_key_s *prep,
+    const unsigned char *message,
+    size_t message_len
+) NONNULL3 API_VIS WARN_UNUSED;
+
+/** Create a cache holding up to capacity prepared public keys. */
+decaf_521_public_key_cache_s *
+decaf_521_public_key_cache_create (
+    size_t capacity
+) API_VIS WARN_UNUSED;
+
+/** Destroy and free a public key cache.  NULL is ignored. */
+void decaf_521_public_key_cache_destroy (
+    decaf_521_public_key_cache_s *cache
+) API_VIS;
+
+/** Look up a public key in the cache, preparing it on a miss. */
+const decaf_521_prepared_public_key_s *
+decaf_521_public_key_cache_get (
+    decaf_521_public_key_cache_s *cache,
+    const decaf_521_public_key_t pub
+) NONNULL2 API_VIS WARN_UNUSED;
+
+/** Verify a signed message, preparing the public key through a cache. */
+decaf_bool_t
+decaf_521_verify_cached (
+    decaf_521_public_key_cache_s *cache,
+    const decaf_521_signature_t sig,
+    const decaf_521_public_key_t pub,
+    const unsigned char *message,
+    size_t message_len
+) NONNULL3 API_VIS WARN_UNUSED;
+
+#undef API_VIS
+#undef WARN_UNUSED
+#undef NONNULL1
+#undef NONNULL2
+#undef NONNULL3
+#undef NONNULL134
+#undef NONNULL5
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __DECAF_CRYPTO_521_H__ */
+
+
@@ -0,0 +1,173 @@
+/**
+ * @file decaf_engine.h
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Multithreaded signing and verification engine.
+ *
+ * Requests are submitted to a lock-free queue, and worker threads take them
+ * off in batches, so that they can use decaf_448_sign_batch and
+ * decaf_448_verify_batch.  Results are returned through a callback.
+ *
+ * @warning Experimental!  The names, parameter orders etc are likely to change.
+ */
+
+#ifndef __DECAF_ENGINE_H__
+#define __DECAF_ENGINE_H__ 1
+
+#include "decaf_crypto.h"
+
+/** @cond internal */
+#define API_VIS __attribute__((visibility("default"))) __attribute__((noinline)) // TODO: synergize with decaf.h
+#define WARN_UNUSED __attribute__((warn_unused_result))
+#define NONNULL1 __attribute__((nonnull(1)))
+#define NONNULL2 __attribute__((nonnull(1,2)))
+/** @endcond */
+
+/** Number of buckets in the latency histograms. */
+#define DECAF_448_ENGINE_LATENCY_BUCKETS 32
+
+/** The largest batch a worker will take off the queue at once. */
+#define DECAF_448_ENGINE_MAX_BATCH 64
+
+/** Operations the engine can perform. */
+typedef enum {
+    DECAF_448_ENGINE_SIGN = 0,  /**< Sign a message */
+    DECAF_448_ENGINE_VERIFY = 1 /**< Verify a signature */
+} decaf_448_engine_op_t;
+
+/** A signing engine. */
+typedef struct decaf_448_engine_s decaf_448_engine_s;
+
+/** A request to the engine. */
+typedef struct decaf_448_engine_request_s decaf_448_engine_request_s;
+
+/**
+ * Completion callback.  It runs on a worker thread, so it should be quick;
+ * it may submit more requests.
+ */
+typedef void (*decaf_448_engine_callback_t)(decaf_448_engine_request_s *req);
+
+/**
+ * A request to the engine.  The caller owns it, and everything it points to,
+ * until its callback has been called.
+ */
+struct decaf_448_engine_request_s {
+    /** What to do. */
+    decaf_448_engine_op_t op;
+
+    /** SIGN: the private key to sign with. */
+    const decaf_448_private_key_s *priv;
+
+    /** VERIFY: the public key, DECAF_448_SER_BYTES long. */
+    const unsigned char *pub;
+
+    /** The message. */
+    const unsigned char *message;
+
+    /** The message's length. */
+    size_t message_len;
+
+    /** SIGN: where to write the signature.  VERIFY: the signature. */
+    unsigned char *sig;
+
+    /** Set before the callback: DECAF_SUCCESS or DECAF_FAILURE. */
+    decaf_bool_t result;
+
+    /** Called once the request is done. */
+    decaf_448_engine_callback_t callback;
+
+    /** For the caller's use. */
+    void *user;
+
+    /** @cond internal */
+    uint64_t submitted_ns;
+    /** @endcond */
+};
+
+/** Engine statistics. */
+typedef struct {
+    uint64_t submitted; /**< Requests accepted by decaf_448_engine_submit */
+    uint64_t rejected;  /**< Requests refused because the queue was full */
+    uint64_t completed; /**< Requests whose callbacks have been called */
+    uint64_t batches;   /**< Batches taken off the queue */
+    uint64_t queue_depth;     /**< Requests waiting in the queue now */
+    uint64_t max_queue_depth; /**< Most requests ever waiting in the queue */
+
+    /**
+     * Latency histograms from submission to callback, by operation.
+     * Bucket 0 counts requests that took under 2 microseconds, and bucket
+     * k > 0 those that took [2^k, 2^(k+1)) microseconds.
+     */
+    uint64_t latency[2][DECAF_448_ENGINE_LATENCY_BUCKETS];
+} decaf_448_engine_stats_s;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create an engine and start its worker threads.
+ *
+ * @param [in] threads The number of worker threads, or 0 for one per CPU.
+ * @param [in] queue_size The queue's capacity, rounded up to a power of 2.
+ * @param [in] batch_size The largest batch a worker takes at once, at most
+ * DECAF_448_ENGINE_MAX_BATCH, or 0 for the maximum.
+ *
+ * @return The engine, or NULL if it could not be started.
+ */
+decaf_448_engine_s *
+decaf_448_engine_create (
+    unsigned int threads,
+    size_t queue_size,
+    unsigned int batch_size
+) API_VIS WARN_UNUSED;
+
+/**
+ * @brief Submit a request.  Safe to call from any thread.
+ *
+ * Workers don't wait for a batch to fill up: a request that arrives at an
+ * idle engine is handled right away.
+ *
+ * @param [in] engine The engine.
+ * @param [in] req The request.
+ *
+ * @retval DECAF_SUCCESS The request was queued.
+ * @retval DECAF_FAILURE The queue was full; try again later.
+ */
+decaf_bool_t
+decaf_448_engine_submit (
+    decaf_448_engine_s *engine,
+    decaf_448_engine_request_s *req
+) NONNULL2 API_VIS WARN_UNUSED;
+
+/**
+ * @brief Read the engine's statistics.  The counters are read one at a
+ * time, so they may be slightly inconsistent while the engine is busy.
+ */
+void
+decaf_448_engine_stats (
+    decaf_448_engine_s *engine,
+    decaf_448_engine_stats_s *stats
+) NONNULL2 API_VIS;
+
+/**
+ * @brief Finish all queued requests, stop the workers and free the engine.
+ * There must be no concurrent calls to decaf_448_engine_submit.
+ */
+void
+decaf_448_engine_destroy (
+    decaf_448_engine_s *engine
+) NONNULL1 API_VIS;
+
+#undef API_VIS
+#undef WARN_UNUSED
+#undef NONNULL1
+#undef NONNULL2
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __DECAF_ENGINE_H__ */
@@ -15,7 +15,7 @@
 #include <stdint.h>
 #include <sys/types.h>
 
-#include "decaf.h" /* TODO: orly? */
+#include "decaf_common.h"
 
 /* TODO: unify with other headers (maybe all into one??); add nonnull attributes */
 /** @cond internal */
@@ -115,6 +115,47 @@ void sponge_hash (
     const struct kparams_s *params
 ) API_VIS;
 
+/**
+ * @brief Hash four independent messages at once.
+ *
+ * On AVX2 targets the four sponges share one interleaved permutation,
+ * which is much faster than four calls to sponge_hash.  Inputs of similar
+ * length work best, since every lane runs as many permutations as the
+ * longest one.
+ *
+ * @param [in] in The four messages.
+ * @param [in] inlen The lengths of the four messages.
+ * @param [out] out Four output buffers.
+ * @param [in] outlen The length of each output.
+ * @param [in] params The parameters of the sponge hash.
+ */
+void sponge_hash_x4 (
+    const uint8_t *const in[4],
+    const size_t inlen[4],
+    uint8_t *const out[4],
+    size_t outlen,
+    const struct kparams_s *params
+) API_VIS;
+
+/**
+ * @brief Hash n independent messages, four at a time where possible.
+ *
+ * @param [in] n The number of messages.
+ * @param [in] in The messages.
+ * @param [in] inlen The lengths of the messages.
+ * @param [out] out The output buffers.
+ * @param [in] outlen The length of each output.
+ * @param [in] params The parameters of the sponge hash.
+ */
+void sponge_hash_many (
+    size_t n,
+    const uint8_t *const *in,
+    const size_t *inlen,
+    uint8_t *const *out,
+    size_t outlen,
+    const struct kparams_s *params
+) API_VIS;
+
 /* TODO: expand/doxygenate individual SHAKE/SHA3 instances? */
 
 /** @cond internal */
@@ -164,6 +205,68 @@ DECSHA3(256)
 DECSHA3(384)
 DECSHA3(512)
 
+/** @cond internal */
+#define DECTURBOSHAKE(n) \
+    extern const struct kparams_s TurboSHAKE##n##_params_s API_VIS; \
+    static inline void NONNULL1 turboshake##n##_init(keccak_sponge_t sponge) { \
+        sponge_init(sponge, &TurboSHAKE##n##_params_s); \
+    } \
+    static inline void NONNULL2 turboshake##n##_update(keccak_sponge_t sponge, const uint8_t *in, size_t inlen ) { \
+        sha3_update(sponge, in, inlen); \
+    } \
+    static inline void NONNULL2 turboshake##n##_final(keccak_sponge_t sponge, uint8_t *out, size_t outlen ) { \
+        sha3_output(sponge, out, outlen); \
+        sponge_init(sponge, &TurboSHAKE##n##_params_s); \
+    } \
+    static inline void NONNULL13 turboshake##n##_hash(uint8_t *out, size_t outlen, const uint8_t *in, size_t inlen) { \
+        sponge_hash(in,inlen,out,outlen,&TurboSHAKE##n##_params_s); \
+    } \
+    static inline void NONNULL1 turboshake##n##_destroy( keccak_sponge_t sponge ) { \
+        sponge_destroy(sponge); \
+    }
+/** @endcond */
+
+DECTURBOSHAKE(128)
+DECTURBOSHAKE(256)
+
+/**
+ * @brief Initialize a TurboSHAKE context with a domain separation byte.
+ * The turboshake128_* and turboshake256_* shortcuts use the default, 0x1F.
+ *
+ * @param [out] sponge The context.
+ * @param [in] params TurboSHAKE128_params_s or TurboSHAKE256_params_s.
+ * @param [in] domain The domain separation byte, from 0x01 to 0x7F.
+ */
+void turboshake_init (
+    keccak_sponge_t sponge,
+    const struct kparams_s *params,
+    uint8_t domain
+) NONNULL2 API_VIS;
+
+/**
+ * @brief Hash (in) to (out) with KangarooTwelve.
+ *
+ * Inputs longer than 8kiB are split into leaves, which are hashed by
+ * up to (threads) threads and, on AVX2 targets, four at a time.
+ *
+ * @param [out] out A buffer for the output data.
+ * @param [in] outlen The length of the output data.
+ * @param [in] in The input data.
+ * @param [in] inlen The length of the input data.
+ * @param [in] custom The customization string, or NULL if customlen is 0.
+ * @param [in] customlen The length of the customization string.
+ * @param [in] threads The most threads to use; 0 for one per online CPU.
+ */
+void k12_hash (
+    uint8_t *out,
+    size_t outlen,
+    const uint8_t *in,
+    size_t inlen,
+    const uint8_t *custom,
+    size_t customlen,
+    unsigned int threads
+) API_VIS;
+
 /**
  * @brief Initialize a sponge-based CSPRNG from a buffer.
  *
@@ -88,6 +88,12 @@ const struct decaf_448_precomputed_s *decaf_448_precomputed_base =
 const size_t sizeof_decaf_448_precomputed_s = sizeof(struct decaf_448_precomputed_s);
 const size_t alignof_decaf_448_precomputed_s = 32;
 
+struct decaf_448_precomputed_comb_s { unsigned int n, t, s; decaf_448_point_t p[1]; };
+
+struct decaf_448_precomputed_wnaf_s { decaf_448_point_t p[1]; };
+const size_t sizeof_decaf_448_precomputed_wnaf_s = sizeof(struct decaf_448_precomputed_wnaf_s);
+const size_t alignof_decaf_448_precomputed_wnaf_s = 32;
+
 #ifdef __clang__
 #if 100*__clang_major__ + __clang_minor__ > 305
 #define VECTORIZE _Pragma("clang loop unroll(disable) vectorize(enable) vectorize_width(8)")
@@ -462,6 +468,20 @@ void decaf_448_point_encode( unsigned char ser[DECAF_448_SER_BYTES], const decaf
     });
 }
 
+void decaf_448_point_double_and_encode_batch (
+    uint8_t *ser,
+    const decaf_448_point_t *pts,
+    size_t n
+) {
+    decaf_448_point_t tmp;
+    size_t i;
+    for (i=0; i<n; i++) {
+        decaf_448_point_double(tmp, pts[i]);
+        decaf_448_point_encode(&ser[i*DECAF_448_SER_BYTES], tmp);
+    }
+    decaf_448_point_destroy(tmp);
+}
+
 /**
  * Deserialize a bool, return TRUE if < p.
  */
@@ -974,6 +994,82 @@ void decaf_448_precomputed_scalarmul (
     decaf_448_point_scalarmul(a,b->p[0],scalar);
 }
 
+static int comb_params_ok (
+    unsigned int n,
+    unsigned int t,
+    unsigned int s
+) {
+    return n >= 1 && n <= DECAF_448_SCALAR_BITS
+        && t >= 2 && t <= 8
+        && s >= 1 && s <= DECAF_448_SCALAR_BITS
+        && n*t*s >= DECAF_448_SCALAR_BITS;
+}
+
+size_t decaf_448_sizeof_precomputed_comb (
+    unsigned int n,
+    unsigned int t,
+    unsigned int s
+) {
+    return comb_params_ok(n,t,s) ? sizeof(struct decaf_448_precomputed_comb_s) : 0;
+}
+
+size_t decaf_448_alignof_precomputed_comb (void) {
+    return 32;
+}
+
+decaf_bool_t decaf_448_precompute_comb (
+    decaf_448_precomputed_comb_s *a,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
+    const decaf_448_point_t b
+) {
+    if (!comb_params_ok(n,t,s)) return DECAF_FAILURE;
+    a->n = n;
+    a->t = t;
+    a->s = s;
+    decaf_448_point_copy(a->p[0],b);
+    return DECAF_SUCCESS;
+}
+
+void decaf_448_precomputed_comb_scalarmul (
+    decaf_448_point_t a,
+    const decaf_448_precomputed_comb_s *b,
+    const decaf_448_scalar_t scalar
+) {
+    decaf_448_point_scalarmul(a,b->p[0],scalar);
+}
+
+decaf_bool_t decaf_448_precomputed_base_comb_scalarmul (
+    decaf_448_point_t a,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
+    const decaf_448_scalar_t scalar
+) {
+    if (!comb_params_ok(n,t,s)) return DECAF_FAILURE;
+    decaf_448_point_scalarmul(a,decaf_448_point_base,scalar);
+    return DECAF_SUCCESS;
+}
+
+void decaf_448_point_scalarmul_non_secret (
+    decaf_448_point_t scaled,
+    const decaf_448_point_t base,
+    const decaf_448_scalar_t scalar
+) {
+    decaf_448_point_scalarmul(scaled, base, scalar);
+}
+
+void decaf_448_point_double_scalarmul_non_secret (
+    decaf_448_point_t combo,
+    const decaf_448_point_t base1,
+    const decaf_448_scalar_t scalar1,
+    const decaf_448_point_t base2,
+    const decaf_448_scalar_t scalar2
+) {
+    decaf_448_point_double_scalarmul(combo, base1, scalar1, base2, scalar2);
+}
+
 void decaf_448_base_double_scalarmul_non_secret (
     decaf_448_point_t combo,
     const decaf_448_scalar_t scalar1,
@@ -983,6 +1079,38 @@ void decaf_448_base_double_scalarmul_non_secret (
     decaf_448_point_double_scalarmul(combo, decaf_448_point_base, scalar1, base2, scalar2);
 }
 
+void decaf_448_precompute_wnaf (
+    decaf_448_precomputed_wnaf_s *a,
+    const decaf_448_point_t b
+) {
+    decaf_448_point_copy(a->p[0],b);
+}
+
+void decaf_448_base_double_scalarmul_wnaf_non_secret (
+    decaf_448_point_t combo,
+    const decaf_448_scalar_t scalar1,
+    const decaf_448_precomputed_wnaf_s *base2,
+    const decaf_448_scalar_t scalar2
+) {
+    decaf_448_base_double_scalarmul_non_secret(combo, scalar1, base2->p[0], scalar2);
+}
+
+void decaf_448_multiscalarmul_non_secret (
+    decaf_448_point_t combo,
+    const decaf_448_point_t *bases,
+    const decaf_448_scalar_t *scalars,
+    size_t n
+) {
+    decaf_448_point_t acc, tmp;
+    size_t i;
+    decaf_448_point_copy(acc, decaf_448_point_identity);
+    for (i=0; i<n; i++) {
+        decaf_448_point_scalarmul(tmp, bases[i], scalars[i]);
+        decaf_448_point_add(acc, acc, tmp);
+    }
+    decaf_448_point_copy(combo, acc);
+}
+
 void decaf_448_point_destroy (
   decaf_448_point_t point
 ) {
@@ -1003,8 +1131,24 @@ decaf_bool_t decaf_memeq (
     return (((decaf_dword_t)ret) - 1) >> 8;
 }
 
+const char *decaf_448_field_backend (void) {
+    return "decaf.c"; /* Uses its own portable field arithmetic */
+}
+
 void decaf_448_precomputed_destroy (
   decaf_448_precomputed_s *pre
 ) {
     decaf_bzero(pre, sizeof_decaf_448_precomputed_s);
 }
+
+void decaf_448_precomputed_comb_destroy (
+  decaf_448_precomputed_comb_s *pre
+) {
+    decaf_bzero(pre, sizeof(struct decaf_448_precomputed_comb_s));
+}
+
+void decaf_448_precomputed_wnaf_destroy (
+  decaf_448_precomputed_wnaf_s *pre
+) {
+    decaf_bzero(pre, sizeof_decaf_448_precomputed_wnaf_s);
+}
@@ -8,63 +8,65 @@
  * @brief Example Decaf cyrpto routines.
  */
 
-#include "decaf_crypto.h"
+#define _XOPEN_SOURCE 600 /* for posix_memalign */
+#include "decaf_curve.h"
 #include <string.h>
+#include <stdlib.h>
 
-static const unsigned int DECAF_448_SCALAR_OVERKILL_BYTES = DECAF_448_SCALAR_BYTES + 8;
+static const unsigned int SCALAR_OVERKILL_BYTES = SCALAR_BYTES + 8;
 
-void decaf_448_derive_private_key (
-    decaf_448_private_key_t priv,
-    const decaf_448_symmetric_key_t proto
+void API_NS(derive_private_key) (
+    API_NS(private_key_t) priv,
+    const API_NS(symmetric_key_t) proto
 ) {
-    const char *magic = "decaf_448_derive_private_key";
-    uint8_t encoded_scalar[DECAF_448_SCALAR_OVERKILL_BYTES];
-    decaf_448_point_t pub;
+    const char *magic = API_NAME "_derive_private_key";
+    uint8_t encoded_scalar[SCALAR_OVERKILL_BYTES];
+    API_NS(point_t) pub;
 
     keccak_sponge_t sponge;
     shake256_init(sponge);
-    shake256_update(sponge, proto, sizeof(decaf_448_symmetric_key_t));
+    shake256_update(sponge, proto, sizeof(API_NS(symmetric_key_t)));
     shake256_update(sponge, (const unsigned char *)magic, strlen(magic));
     shake256_final(sponge, encoded_scalar, sizeof(encoded_scalar));
     shake256_destroy(sponge);
     
-    memcpy(priv->sym, proto, sizeof(decaf_448_symmetric_key_t));
-    decaf_448_scalar_decode_long(priv->secret_scalar, encoded_scalar, sizeof(encoded_scalar));
+    memcpy(priv->sym, proto, sizeof(API_NS(symmetric_key_t)));
+    API_NS(scalar_decode_long)(priv->secret_scalar, encoded_scalar, sizeof(encoded_scalar));
     
-    decaf_448_precomputed_scalarmul(pub, decaf_448_precomputed_base, priv->secret_scalar);
-    decaf_448_point_encode(priv->pub, pub);
+    API_NS(precomputed_scalarmul)(pub, API_NS(precomputed_base), priv->secret_scalar);
+    API_NS(point_encode)(priv->pub, pub);
     
     decaf_bzero(encoded_scalar, sizeof(encoded_scalar));
 }
 
 void
-decaf_448_destroy_private_key (
-    decaf_448_private_key_t priv
+API_NS(destroy_private_key) (
+    API_NS(private_key_t) priv
 )  {
-    decaf_bzero((void*)priv, sizeof(decaf_448_private_key_t));
+    decaf_bzero((void*)priv, sizeof(API_NS(private_key_t)));
 }
 
-void decaf_448_private_to_public (
-    decaf_448_public_key_t pub,
-    const decaf_448_private_key_t priv
+void API_NS(private_to_public) (
+    API_NS(public_key_t) pub,
+    const API_NS(private_key_t) priv
 ) {
-    memcpy(pub, priv->pub, sizeof(decaf_448_public_key_t));
+    memcpy(pub, priv->pub, sizeof(API_NS(public_key_t)));
 }
 
 decaf_bool_t
-decaf_448_shared_secret (
+API_NS(shared_secret) (
     uint8_t *shared,
     size_t shared_bytes,
-    const decaf_448_private_key_t my_privkey,
-    const decaf_448_public_key_t your_pubkey
+    const API_NS(private_key_t) my_privkey,
+    const API_NS(public_key_t) your_pubkey
 ) {
-    uint8_t ss_ser[DECAF_448_SER_BYTES];
-    const char *nope = "decaf_448_ss_invalid";
+    uint8_t ss_ser[SER_BYTES];
+    const char *nope = API_NAME "_ss_invalid";
     
     unsigned i;
     /* Lexsort keys.  Less will be -1 if mine is less, and 0 otherwise. */
     uint16_t less = 0;
-    for (i=0; i<DECAF_448_SER_BYTES; i++) {
+    for (i=0; i<SER_BYTES; i++) {
         uint16_t delta = my_privkey->pub[i];
         delta -= your_pubkey[i];
         /* Case:
@@ -92,7 +94,7 @@ decaf_448_shared_secret (
     }
     shake256_update(sponge, ss_ser, sizeof(ss_ser));
     
-    decaf_bool_t ret = decaf_448_direct_scalarmul(ss_ser, your_pubkey, my_privkey->secret_scalar, DECAF_FALSE, DECAF_TRUE);
+    decaf_bool_t ret = API_NS(direct_scalarmul)(ss_ser, your_pubkey, my_privkey->secret_scalar, DECAF_FALSE, DECAF_TRUE);
     /* If invalid, then replace ... */
     for (i=0; i<sizeof(ss_ser); i++) {
         ss_ser[i] &= ret;
@@ -114,16 +116,16 @@ decaf_448_shared_secret (
 }
 
 void
-decaf_448_sign_shake (
-    decaf_448_signature_t sig,
-    const decaf_448_private_key_t priv,
+API_NS(sign_shake) (
+    API_NS(signature_t) sig,
+    const API_NS(private_key_t) priv,
     const keccak_sponge_t shake
 ) {
-    const char *magic = "decaf_448_sign_shake";
+    const char *magic = API_NAME "_sign_shake";
 
-    uint8_t overkill[DECAF_448_SCALAR_OVERKILL_BYTES], encoded[DECAF_448_SER_BYTES];
-    decaf_448_point_t point;
-    decaf_448_scalar_t nonce, challenge;
+    uint8_t overkill[SCALAR_OVERKILL_BYTES], encoded[SER_BYTES];
+    API_NS(point_t) point;
+    API_NS(scalar_t) nonce, challenge;
     
     /* Derive nonce */
     keccak_sponge_t ctx;
@@ -132,9 +134,9 @@ decaf_448_sign_shake (
     shake256_update(ctx, (const unsigned char *)magic, strlen(magic));
     shake256_final(ctx, overkill, sizeof(overkill));
     
-    decaf_448_scalar_decode_long(nonce, overkill, sizeof(overkill));
-    decaf_448_precomputed_scalarmul(point, decaf_448_precomputed_base, nonce);
-    decaf_448_point_encode(encoded, point);
+    API_NS(scalar_decode_long)(nonce, overkill, sizeof(overkill));
+    API_NS(precomputed_scalarmul)(point, API_NS(precomputed_base), nonce);
+    API_NS(point_encode)(encoded, point);
 
     /* Derive challenge */
     memcpy(ctx, shake, sizeof(ctx));
@@ -142,83 +144,570 @@ decaf_448_sign_shake (
     shake256_update(ctx, encoded, sizeof(encoded));
     shake256_final(ctx, overkill, sizeof(overkill));
     shake256_destroy(ctx);
-    decaf_448_scalar_decode_long(challenge, overkill, sizeof(overkill));
+    API_NS(scalar_decode_long)(challenge, overkill, sizeof(overkill));
     
     /* Respond */
-    decaf_448_scalar_mul(challenge, challenge, priv->secret_scalar);
-    decaf_448_scalar_sub(nonce, nonce, challenge);
+    API_NS(scalar_mul)(challenge, challenge, priv->secret_scalar);
+    API_NS(scalar_sub)(nonce, nonce, challenge);
     
     /* Save results */
     memcpy(sig, encoded, sizeof(encoded));
-    decaf_448_scalar_encode(&sig[sizeof(encoded)], nonce);
+    API_NS(scalar_encode)(&sig[sizeof(encoded)], nonce);
     
     /* Clean up */
-    decaf_448_scalar_destroy(nonce);
-    decaf_448_scalar_destroy(challenge);
+    API_NS(scalar_destroy)(nonce);
+    API_NS(scalar_destroy)(challenge);
     decaf_bzero(overkill,sizeof(overkill));
     decaf_bzero(encoded,sizeof(encoded));
 }
 
 decaf_bool_t
-decaf_448_verify_shake (
-    const decaf_448_signature_t sig,
-    const decaf_448_public_key_t pub,
+API_NS(verify_shake) (
+    const API_NS(signature_t) sig,
+    const API_NS(public_key_t) pub,
     const keccak_sponge_t shake
 ) {
     decaf_bool_t ret;
 
-    uint8_t overkill[DECAF_448_SCALAR_OVERKILL_BYTES];
-    decaf_448_point_t point, pubpoint;
-    decaf_448_scalar_t challenge, response;
+    uint8_t overkill[SCALAR_OVERKILL_BYTES];
+    API_NS(point_t) point, pubpoint;
+    API_NS(scalar_t) challenge, response;
     
     /* Derive challenge */
     keccak_sponge_t ctx;
     memcpy(ctx, shake, sizeof(ctx));
-    shake256_update(ctx, pub, sizeof(decaf_448_public_key_t));
-    shake256_update(ctx, sig, DECAF_448_SER_BYTES);
+    shake256_update(ctx, pub, sizeof(API_NS(public_key_t)));
+    shake256_update(ctx, sig, SER_BYTES);
     shake256_final(ctx, overkill, sizeof(overkill));
     shake256_destroy(ctx);
-    decaf_448_scalar_decode_long(challenge, overkill, sizeof(overkill));
+    API_NS(scalar_decode_long)(challenge, overkill, sizeof(overkill));
 
     /* Decode points. */
-    ret  = decaf_448_point_decode(point, sig, DECAF_TRUE);
-    ret &= decaf_448_point_decode(pubpoint, pub, DECAF_FALSE);
-    ret &= decaf_448_scalar_decode(response, &sig[DECAF_448_SER_BYTES]);
+    ret  = API_NS(point_decode)(point, sig, DECAF_TRUE);
+    ret &= API_NS(point_decode)(pubpoint, pub, DECAF_FALSE);
+    ret &= API_NS(scalar_decode)(response, &sig[SER_BYTES]);
 
-    decaf_448_base_double_scalarmul_non_secret (
+    API_NS(base_double_scalarmul_non_secret) (
         pubpoint, response, pubpoint, challenge
     );
 
-    ret &= decaf_448_point_eq(pubpoint, point);
+    ret &= API_NS(point_eq)(pubpoint, point);
     
     return ret;
 }
 
 void
-decaf_448_sign (
-    decaf_448_signature_t sig,
-    const decaf_448_private_key_t priv,
+API_NS(sign) (
+    API_NS(signature_t) sig,
+    const API_NS(private_key_t) priv,
     const unsigned char *message,
     size_t message_len
 ) {
     keccak_sponge_t ctx;
     shake256_init(ctx);
     shake256_update(ctx, message, message_len);
-    decaf_448_sign_shake(sig, priv, ctx);
+    API_NS(sign_shake)(sig, priv, ctx);
     shake256_destroy(ctx);
 }
 
+/** Number of nonce points encoded together in batch signing. */
+#define SIGN_BATCH_SIZE 64
+
+/** half = (q+1)/2, so that 2*(nonce*half)*base = nonce*base */
+static void scalar_half (
+    API_NS(scalar_t) half
+) {
+    unsigned char ser[SCALAR_BYTES];
+    unsigned int i;
+    API_NS(scalar_sub)(half, API_NS(scalar_zero), API_NS(scalar_one));
+    API_NS(scalar_encode)(ser, half);
+    
+    /* (q-1)/2 + 1, since q is odd */
+    for (i=0; i<SCALAR_BYTES-1; i++) {
+        ser[i] = ser[i]>>1 | ser[i+1]<<7;
+    }
+    ser[i] >>= 1;
+    API_NS(scalar_decode_long)(half, ser, sizeof(ser));
+    API_NS(scalar_add)(half, half, API_NS(scalar_one));
+}
+
+void
+API_NS(sign_batch) (
+    API_NS(signature_t) *sigs,
+    const API_NS(private_key_s) *const *privs,
+    const unsigned char *const *messages,
+    const size_t *message_lens,
+    size_t n
+) {
+    const char *magic = API_NAME "_sign_shake";
+
+    uint8_t overkill[SCALAR_OVERKILL_BYTES];
+    uint8_t encoded[SIGN_BATCH_SIZE*SER_BYTES];
+    API_NS(point_t) points[SIGN_BATCH_SIZE];
+    API_NS(scalar_t) nonces[SIGN_BATCH_SIZE], challenge, half;
+    keccak_sponge_t shakes[SIGN_BATCH_SIZE], ctx;
+    size_t i, j, m;
+    
+    scalar_half(half);
+    
+    for (i=0; i<n; i+=m) {
+        m = (n-i < SIGN_BATCH_SIZE) ? n-i : SIGN_BATCH_SIZE;
+        
+        /* Derive nonces, as in sign_shake, but compute half the
+         * nonce points so that they can be encoded together.
+         */
+        for (j=0; j<m; j++) {
+            const API_NS(private_key_s) *priv = privs[i+j];
+            shake256_init(shakes[j]);
+            shake256_update(shakes[j], messages[i+j], message_lens[i+j]);
+            
+            memcpy(ctx, shakes[j], sizeof(ctx));
+            shake256_update(ctx, priv->sym, sizeof(priv->sym));
+            shake256_update(ctx, (const unsigned char *)magic, strlen(magic));
+            shake256_final(ctx, overkill, sizeof(overkill));
+            
+            API_NS(scalar_decode_long)(nonces[j], overkill, sizeof(overkill));
+            API_NS(scalar_mul)(challenge, nonces[j], half);
+            API_NS(precomputed_scalarmul)(points[j], API_NS(precomputed_base), challenge);
+        }
+        API_NS(point_double_and_encode_batch)(encoded, (const API_NS(point_t) *)points, m);
+        
+        for (j=0; j<m; j++) {
+            const API_NS(private_key_s) *priv = privs[i+j];
+            const uint8_t *enc = &encoded[j*SER_BYTES];
+            
+            /* Derive challenge */
+            shake256_update(shakes[j], priv->pub, sizeof(priv->pub));
+            shake256_update(shakes[j], enc, SER_BYTES);
+            shake256_final(shakes[j], overkill, sizeof(overkill));
+            shake256_destroy(shakes[j]);
+            API_NS(scalar_decode_long)(challenge, overkill, sizeof(overkill));
+            
+            /* Respond */
+            API_NS(scalar_mul)(challenge, challenge, priv->secret_scalar);
+            API_NS(scalar_sub)(nonces[j], nonces[j], challenge);
+            
+            /* Save results */
+            memcpy(sigs[i+j], enc, SER_BYTES);
+            API_NS(scalar_encode)(&sigs[i+j][SER_BYTES], nonces[j]);
+        }
+    }
+    
+    /* Clean up */
+    shake256_destroy(ctx);
+    API_NS(scalar_destroy)(challenge);
+    decaf_bzero(nonces,sizeof(nonces));
+    decaf_bzero(points,sizeof(points));
+    decaf_bzero(overkill,sizeof(overkill));
+}
+
 decaf_bool_t
-decaf_448_verify (
-    const decaf_448_signature_t sig,
-    const decaf_448_public_key_t pub,
+API_NS(verify) (
+    const API_NS(signature_t) sig,
+    const API_NS(public_key_t) pub,
     const unsigned char *message,
     size_t message_len
 ) {
     keccak_sponge_t ctx;
     shake256_init(ctx);
     shake256_update(ctx, message, message_len);
-    decaf_bool_t ret = decaf_448_verify_shake(sig, pub, ctx);
+    decaf_bool_t ret = API_NS(verify_shake)(sig, pub, ctx);
+    shake256_destroy(ctx);
+    return ret;
+}
+
+/** Number of signatures combined into one random linear combination. */
+#define VERIFY_BATCH_SIZE 64
+
+/** Size of the random coefficients in batch verification. */
+#define VERIFY_BATCH_Z_BYTES 16
+
+/**
+ * Compute sum(zs[i])*base + sum(scalars[j]*points[j]) over the signatures
+ * [lo,hi), where signature i owns points 2i (pubkey) and 2i+1 (nonce).
+ */
+static void verify_batch_combo (
+    API_NS(point_t) combo,
+    const API_NS(point_t) *points,
+    const API_NS(scalar_t) *scalars,
+    const API_NS(scalar_t) *zs,
+    size_t lo,
+    size_t hi
+) {
+    API_NS(scalar_t) sum;
+    API_NS(point_t) based;
+    size_t i;
+    
+    API_NS(scalar_copy)(sum, API_NS(scalar_zero));
+    for (i=lo; i<hi; i++) {
+        API_NS(scalar_add)(sum, sum, zs[i]);
+    }
+    API_NS(precomputed_scalarmul)(based, API_NS(precomputed_base), sum);
+    API_NS(multiscalarmul_non_secret)(combo, &points[2*lo], &scalars[2*lo], 2*(hi-lo));
+    API_NS(point_add)(combo, combo, based);
+}
+
+/**
+ * Given the combination over [lo,hi), find the bad signatures by bisection.
+ * The right half's combination is the whole minus the left half's.
+ */
+static void verify_batch_bisect (
+    decaf_bool_t *results,
+    const API_NS(point_t) *points,
+    const API_NS(scalar_t) *scalars,
+    const API_NS(scalar_t) *zs,
+    size_t lo,
+    size_t hi,
+    const API_NS(point_t) combo
+) {
+    size_t i, mid = lo + (hi-lo)/2;
+    API_NS(point_t) left, right;
+    
+    if (API_NS(point_eq)(combo, API_NS(point_identity))) {
+        for (i=lo; i<hi; i++) results[i] = DECAF_SUCCESS;
+        return;
+    } else if (hi-lo == 1) {
+        results[lo] = DECAF_FAILURE;
+        return;
+    }
+    
+    verify_batch_combo(left, points, scalars, zs, lo, mid);
+    API_NS(point_sub)(right, combo, left);
+    verify_batch_bisect(results, points, scalars, zs, lo, mid, left);
+    verify_batch_bisect(results, points, scalars, zs, mid, hi, right);
+}
+
+decaf_bool_t
+API_NS(verify_batch) (
+    decaf_bool_t *results,
+    const API_NS(signature_t) *sigs,
+    const API_NS(public_key_t) *pubs,
+    const unsigned char *const *messages,
+    const size_t *message_lens,
+    size_t n
+) {
+    const char *magic = API_NAME "_verify_batch";
+    decaf_bool_t ret = DECAF_SUCCESS, ok, valid[VERIFY_BATCH_SIZE];
+    
+    uint8_t overkill[SCALAR_OVERKILL_BYTES];
+    uint8_t zbytes[VERIFY_BATCH_SIZE*VERIFY_BATCH_Z_BYTES];
+    API_NS(point_t) points[2*VERIFY_BATCH_SIZE], combo;
+    API_NS(scalar_t) scalars[2*VERIFY_BATCH_SIZE], zs[VERIFY_BATCH_SIZE], z;
+    keccak_sponge_t ctx, zctx;
+    size_t i, j, m;
+    
+    for (i=0; i<n; i+=m) {
+        m = (n-i < VERIFY_BATCH_SIZE) ? n-i : VERIFY_BATCH_SIZE;
+        
+        shake256_init(zctx);
+        shake256_update(zctx, (const unsigned char *)magic, strlen(magic));
+        
+        for (j=0; j<m; j++) {
+            /* Derive challenge, as in verify_shake */
+            shake256_init(ctx);
+            shake256_update(ctx, messages[i+j], message_lens[i+j]);
+            shake256_update(ctx, pubs[i+j], sizeof(API_NS(public_key_t)));
+            shake256_update(ctx, sigs[i+j], SER_BYTES);
+            shake256_final(ctx, overkill, sizeof(overkill));
+            API_NS(scalar_decode_long)(scalars[2*j], overkill, sizeof(overkill));
+            
+            /* Decode points and response. */
+            valid[j]  = API_NS(point_decode)(points[2*j], pubs[i+j], DECAF_FALSE);
+            valid[j] &= API_NS(point_decode)(points[2*j+1], sigs[i+j], DECAF_TRUE);
+            valid[j] &= API_NS(scalar_decode)(zs[j], &sigs[i+j][SER_BYTES]);
+            
+            /* Everything goes into the randomizers. */
+            shake256_update(zctx, sigs[i+j], sizeof(API_NS(signature_t)));
+            shake256_update(zctx, pubs[i+j], sizeof(API_NS(public_key_t)));
+            shake256_update(zctx, overkill, sizeof(overkill));
+        }
+        shake256_final(zctx, zbytes, m*VERIFY_BATCH_Z_BYTES);
+        
+        /* Weight response*base + challenge*pub - nonce = 0 by a nonzero z.
+         * Invalid encodings are dropped from the sum, and fail below.
+         */
+        for (j=0; j<m; j++) {
+            zbytes[j*VERIFY_BATCH_Z_BYTES] |= 1;
+            API_NS(scalar_decode_long)(z, &zbytes[j*VERIFY_BATCH_Z_BYTES], VERIFY_BATCH_Z_BYTES);
+            if (!valid[j]) {
+                /* A failed decode may leave an off-curve point behind. */
+                API_NS(scalar_copy)(z, API_NS(scalar_zero));
+                API_NS(point_copy)(points[2*j], API_NS(point_identity));
+                API_NS(point_copy)(points[2*j+1], API_NS(point_identity));
+            }
+            
+            API_NS(scalar_mul)(scalars[2*j], scalars[2*j], z);
+            API_NS(scalar_sub)(scalars[2*j+1], API_NS(scalar_zero), z);
+            API_NS(scalar_mul)(zs[j], zs[j], z);
+        }
+        
+        verify_batch_combo(combo, (const API_NS(point_t) *)points,
+            (const API_NS(scalar_t) *)scalars, (const API_NS(scalar_t) *)zs, 0, m);
+        ok = API_NS(point_eq)(combo, API_NS(point_identity));
+        
+        if (results) {
+            verify_batch_bisect(&results[i], (const API_NS(point_t) *)points,
+                (const API_NS(scalar_t) *)scalars, (const API_NS(scalar_t) *)zs, 0, m, combo);
+            for (j=0; j<m; j++) results[i+j] &= valid[j];
+        }
+        for (j=0; j<m; j++) ok &= valid[j];
+        
+        ret &= ok;
+        if (!ret && !results) break;
+    }
+    
     shake256_destroy(ctx);
+    shake256_destroy(zctx);
+    return ret;
+}
+
+struct API_NS(prepared_public_key_s) {
+    /** The encoded public key, which is hashed into the challenge. */
+    API_NS(public_key_t) pub;
+    
+    /** wNAF table of the decoded public key. */
+    API_NS(precomputed_wnaf_s) *table;
+};
+
+/** Decode pub and build its table into an already-allocated prepared key. */
+static decaf_bool_t prepare_public_key (
+    API_NS(prepared_public_key_s) *prep,
+    const API_NS(public_key_t) pub
+) {
+    API_NS(point_t) pubpoint;
+    decaf_bool_t ret = API_NS(point_decode)(pubpoint, pub, DECAF_FALSE);
+    if (!ret) return ret;
+    memcpy(prep->pub, pub, sizeof(API_NS(public_key_t)));
+    API_NS(precompute_wnaf)(prep->table, pubpoint);
+    API_NS(point_destroy)(pubpoint);
     return ret;
 }
+
+API_NS(prepared_public_key_s) *
+API_NS(prepared_public_key_create) (
+    const API_NS(public_key_t) pub
+) {
+    API_NS(prepared_public_key_s) *prep =
+        (API_NS(prepared_public_key_s) *)malloc(sizeof(*prep));
+    if (!prep) return NULL;
+    if (posix_memalign((void **)&prep->table, API_NS2(alignof,precomputed_wnaf_s),
+            API_NS2(sizeof,precomputed_wnaf_s))) {
+        free(prep);
+        return NULL;
+    }
+    if (!prepare_public_key(prep, pub)) {
+        API_NS(prepared_public_key_destroy)(prep);
+        return NULL;
+    }
+    return prep;
+}
+
+void API_NS(prepared_public_key_destroy) (
+    API_NS(prepared_public_key_s) *prep
+) {
+    if (!prep) return;
+    API_NS(precomputed_wnaf_destroy)(prep->table);
+    free(prep->table);
+    free(prep);
+}
+
+decaf_bool_t
+API_NS(verify_prepared_shake) (
+    const API_NS(signature_t) sig,
+    const API_NS(prepared_public_key_s) *prep,
+    const keccak_sponge_t shake
+) {
+    decaf_bool_t ret;
+
+    uint8_t overkill[SCALAR_OVERKILL_BYTES];
+    API_NS(point_t) point, combo;
+    API_NS(scalar_t) challenge, response;
+    
+    /* Derive challenge */
+    keccak_sponge_t ctx;
+    memcpy(ctx, shake, sizeof(ctx));
+    shake256_update(ctx, prep->pub, sizeof(API_NS(public_key_t)));
+    shake256_update(ctx, sig, SER_BYTES);
+    shake256_final(ctx, overkill, sizeof(overkill));
+    shake256_destroy(ctx);
+    API_NS(scalar_decode_long)(challenge, overkill, sizeof(overkill));
+
+    /* Decode the nonce and response; the public key is already decoded. */
+    ret  = API_NS(point_decode)(point, sig, DECAF_TRUE);
+    ret &= API_NS(scalar_decode)(response, &sig[SER_BYTES]);
+
+    API_NS(base_double_scalarmul_wnaf_non_secret) (
+        combo, response, prep->table, challenge
+    );
+
+    ret &= API_NS(point_eq)(combo, point);
+    
+    return ret;
+}
+
+decaf_bool_t
+API_NS(verify_prepared) (
+    const API_NS(signature_t) sig,
+    const API_NS(prepared_public_key_s) *prep,
+    const unsigned char *message,
+    size_t message_len
+) {
+    keccak_sponge_t ctx;
+    shake256_init(ctx);
+    shake256_update(ctx, message, message_len);
+    decaf_bool_t ret = API_NS(verify_prepared_shake)(sig, prep, ctx);
+    shake256_destroy(ctx);
+    return ret;
+}
+
+/** End of a list in the public key cache. */
+#define CACHE_NIL ((size_t)-1)
+
+/** A slot in the public key cache. */
+struct cache_entry {
+    API_NS(prepared_public_key_s) *prep;
+    size_t hash_next; /**< Next slot in the same hash bucket */
+    size_t newer, older; /**< Neighbors in recency order */
+};
+
+struct API_NS(public_key_cache_s) {
+    struct cache_entry *entries;
+    size_t *buckets;
+    size_t capacity, used, nbuckets;
+    size_t newest, oldest;
+};
+
+static size_t cache_hash (
+    const API_NS(public_key_cache_s) *cache,
+    const API_NS(public_key_t) pub
+) {
+    /* Public keys are uniform enough that their first bytes make a fine hash. */
+    uint64_t h = 0;
+    unsigned int i;
+    for (i=0; i<8; i++) h |= (uint64_t)pub[i] << (8*i);
+    return (size_t)(h % cache->nbuckets);
+}
+
+static void cache_unlink_lru (
+    API_NS(public_key_cache_s) *cache,
+    size_t i
+) {
+    struct cache_entry *e = &cache->entries[i];
+    if (e->newer != CACHE_NIL) cache->entries[e->newer].older = e->older;
+    else cache->newest = e->older;
+    if (e->older != CACHE_NIL) cache->entries[e->older].newer = e->newer;
+    else cache->oldest = e->newer;
+}
+
+static void cache_push_newest (
+    API_NS(public_key_cache_s) *cache,
+    size_t i
+) {
+    struct cache_entry *e = &cache->entries[i];
+    e->newer = CACHE_NIL;
+    e->older = cache->newest;
+    if (cache->newest != CACHE_NIL) cache->entries[cache->newest].newer = i;
+    else cache->oldest = i;
+    cache->newest = i;
+}
+
+API_NS(public_key_cache_s) *
+API_NS(public_key_cache_create) (
+    size_t capacity
+) {
+    API_NS(public_key_cache_s) *cache;
+    size_t i;
+    
+    if (capacity == 0) return NULL;
+    cache = (API_NS(public_key_cache_s) *)malloc(sizeof(*cache));
+    if (!cache) return NULL;
+    
+    cache->capacity = capacity;
+    cache->used = 0;
+    cache->nbuckets = 2*capacity+1;
+    cache->newest = cache->oldest = CACHE_NIL;
+    cache->entries = (struct cache_entry *)calloc(capacity, sizeof(struct cache_entry));
+    cache->buckets = (size_t *)malloc(cache->nbuckets * sizeof(size_t));
+    if (!cache->entries || !cache->buckets) {
+        free(cache->entries);
+        free(cache->buckets);
+        free(cache);
+        return NULL;
+    }
+    for (i=0; i<cache->nbuckets; i++) cache->buckets[i] = CACHE_NIL;
+    return cache;
+}
+
+void API_NS(public_key_cache_destroy) (
+    API_NS(public_key_cache_s) *cache
+) {
+    size_t i;
+    if (!cache) return;
+    for (i=0; i<cache->used; i++) {
+        API_NS(prepared_public_key_destroy)(cache->entries[i].prep);
+    }
+    free(cache->entries);
+    free(cache->buckets);
+    free(cache);
+}
+
+const API_NS(prepared_public_key_s) *
+API_NS(public_key_cache_get) (
+    API_NS(public_key_cache_s) *cache,
+    const API_NS(public_key_t) pub
+) {
+    size_t h = cache_hash(cache, pub), i, *link;
+    struct cache_entry *e;
+    
+    /* Public keys aren't secret, so a variable-time lookup is fine. */
+    for (i = cache->buckets[h]; i != CACHE_NIL; i = cache->entries[i].hash_next) {
+        if (!memcmp(cache->entries[i].prep->pub, pub, sizeof(API_NS(public_key_t)))) {
+            cache_unlink_lru(cache, i);
+            cache_push_newest(cache, i);
+            return cache->entries[i].prep;
+        }
+    }
+    
+    if (cache->used < cache->capacity) {
+        /* Fill a fresh slot. */
+        API_NS(prepared_public_key_s) *prep = API_NS(prepared_public_key_create)(pub);
+        if (!prep) return NULL;
+        i = cache->used++;
+        cache->entries[i].prep = prep;
+    } else {
+        /* Evict the least recently used key, and reuse its table. */
+        API_NS(prepared_public_key_s) tmp;
+        i = cache->oldest;
+        e = &cache->entries[i];
+        
+        tmp.table = e->prep->table;
+        if (!prepare_public_key(&tmp, pub)) return NULL;
+        
+        for (link = &cache->buckets[cache_hash(cache, e->prep->pub)];
+             *link != i;
+             link = &cache->entries[*link].hash_next)
+            ;
+        *link = e->hash_next;
+        cache_unlink_lru(cache, i);
+        memcpy(e->prep->pub, tmp.pub, sizeof(API_NS(public_key_t)));
+    }
+    
+    e = &cache->entries[i];
+    e->hash_next = cache->buckets[h];
+    cache->buckets[h] = i;
+    cache_push_newest(cache, i);
+    return e->prep;
+}
+
+decaf_bool_t
+API_NS(verify_cached) (
+    API_NS(public_key_cache_s) *cache,
+    const API_NS(signature_t) sig,
+    const API_NS(public_key_t) pub,
+    const unsigned char *message,
+    size_t message_len
+) {
+    const API_NS(prepared_public_key_s) *prep = API_NS(public_key_cache_get)(cache, pub);
+    if (!prep) return DECAF_FAILURE;
+    return API_NS(verify_prepared)(sig, prep, message, message_len);
+}
@@ -0,0 +1,337 @@
+/**
+ * @cond internal
+ * @file decaf_engine.c
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Multithreaded signing and verification engine.
+ */
+
+#define _XOPEN_SOURCE 600 /* for clock_gettime, sysconf */
+#include "decaf_engine.h"
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Keep hot counters on separate cache lines. */
+#define CACHE_LINE 64
+
+/**
+ * A slot in the bounded MPMC queue (after Vyukov).  seq == pos means
+ * the slot is free for the producer at position pos; seq == pos+1
+ * means it holds the request for the consumer at pos.
+ */
+struct engine_cell {
+    size_t seq;
+    decaf_448_engine_request_s *req;
+};
+
+struct decaf_448_engine_s {
+    struct engine_cell *cells;
+    size_t mask;
+    unsigned int batch_size, nthreads;
+    pthread_t *threads;
+
+    /* Idle workers sleep here.  The queue itself takes no locks. */
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    unsigned int sleepers;
+    int stopping;
+
+    char pad0[CACHE_LINE];
+    size_t enqueue_pos;
+    char pad1[CACHE_LINE];
+    size_t dequeue_pos;
+    char pad2[CACHE_LINE];
+
+    /* Statistics */
+    uint64_t submitted, rejected, completed, batches, dequeued, max_depth;
+    uint64_t latency[2][DECAF_448_ENGINE_LATENCY_BUCKETS];
+};
+
+static uint64_t engine_now_ns (void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static decaf_bool_t queue_push (
+    decaf_448_engine_s *e,
+    decaf_448_engine_request_s *req
+) {
+    size_t pos = __atomic_load_n(&e->enqueue_pos, __ATOMIC_RELAXED);
+    struct engine_cell *cell;
+    for (;;) {
+        cell = &e->cells[pos & e->mask];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&e->enqueue_pos, &pos, pos+1, 1,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (dif < 0) {
+            return DECAF_FAILURE; /* full */
+        } else {
+            pos = __atomic_load_n(&e->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    cell->req = req;
+    __atomic_store_n(&cell->seq, pos+1, __ATOMIC_RELEASE);
+    return DECAF_SUCCESS;
+}
+
+/* Returns NULL if empty, or if the next slot is claimed but not yet filled. */
+static decaf_448_engine_request_s *queue_pop (
+    decaf_448_engine_s *e
+) {
+    size_t pos = __atomic_load_n(&e->dequeue_pos, __ATOMIC_RELAXED);
+    struct engine_cell *cell;
+    for (;;) {
+        cell = &e->cells[pos & e->mask];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        intptr_t dif = (intptr_t)seq - (intptr_t)(pos+1);
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&e->dequeue_pos, &pos, pos+1, 1,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (dif < 0) {
+            return NULL;
+        } else {
+            pos = __atomic_load_n(&e->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    decaf_448_engine_request_s *req = cell->req;
+    __atomic_store_n(&cell->seq, pos + e->mask + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&e->dequeued, 1, __ATOMIC_RELAXED);
+    return req;
+}
+
+static void engine_complete (
+    decaf_448_engine_s *e,
+    decaf_448_engine_request_s *req,
+    uint64_t now
+) {
+    uint64_t us = (now - req->submitted_ns) / 1000;
+    unsigned int bucket = 0;
+    while (us > 1 && bucket < DECAF_448_ENGINE_LATENCY_BUCKETS-1) {
+        us >>= 1;
+        bucket++;
+    }
+    __atomic_fetch_add(&e->latency[req->op == DECAF_448_ENGINE_VERIFY][bucket], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&e->completed, 1, __ATOMIC_RELAXED);
+    if (req->callback) req->callback(req);
+}
+
+/** Run one batch, using the batch primitives for each kind of request. */
+static void engine_run_batch (
+    decaf_448_engine_s *e,
+    decaf_448_engine_request_s **batch,
+    unsigned int n
+) {
+    decaf_448_signature_t sigs[DECAF_448_ENGINE_MAX_BATCH];
+    decaf_448_public_key_t pubs[DECAF_448_ENGINE_MAX_BATCH];
+    const decaf_448_private_key_s *privs[DECAF_448_ENGINE_MAX_BATCH];
+    const unsigned char *messages[DECAF_448_ENGINE_MAX_BATCH];
+    size_t lens[DECAF_448_ENGINE_MAX_BATCH];
+    decaf_bool_t results[DECAF_448_ENGINE_MAX_BATCH];
+    decaf_448_engine_request_s *signs[DECAF_448_ENGINE_MAX_BATCH], *verifies[DECAF_448_ENGINE_MAX_BATCH];
+    unsigned int i, ns = 0, nv = 0;
+    uint64_t now;
+
+    /* Sort the batch before any callback runs: a callback may free its request. */
+    for (i=0; i<n; i++) {
+        if (batch[i]->op == DECAF_448_ENGINE_SIGN) signs[ns++] = batch[i];
+        else verifies[nv++] = batch[i];
+    }
+
+    if (ns) {
+        for (i=0; i<ns; i++) {
+            privs[i] = signs[i]->priv;
+            messages[i] = signs[i]->message;
+            lens[i] = signs[i]->message_len;
+        }
+        decaf_448_sign_batch(sigs, privs, messages, lens, ns);
+        now = engine_now_ns();
+        for (i=0; i<ns; i++) {
+            memcpy(signs[i]->sig, sigs[i], sizeof(sigs[i]));
+            signs[i]->result = DECAF_SUCCESS;
+            engine_complete(e, signs[i], now);
+        }
+    }
+
+    if (nv) {
+        for (i=0; i<nv; i++) {
+            memcpy(sigs[i], verifies[i]->sig, sizeof(sigs[i]));
+            memcpy(pubs[i], verifies[i]->pub, sizeof(pubs[i]));
+            messages[i] = verifies[i]->message;
+            lens[i] = verifies[i]->message_len;
+        }
+        if (nv == 1) {
+            results[0] = decaf_448_verify(sigs[0], pubs[0], messages[0], lens[0]);
+        } else {
+            decaf_bool_t ret = decaf_448_verify_batch(results,
+                (const decaf_448_signature_t *)sigs, (const decaf_448_public_key_t *)pubs,
+                messages, lens, nv);
+            (void)ret;
+        }
+        now = engine_now_ns();
+        for (i=0; i<nv; i++) {
+            verifies[i]->result = results[i];
+            engine_complete(e, verifies[i], now);
+        }
+    }
+}
+
+static void *engine_worker (void *arg) {
+    decaf_448_engine_s *e = (decaf_448_engine_s *)arg;
+    decaf_448_engine_request_s *batch[DECAF_448_ENGINE_MAX_BATCH], *req;
+    unsigned int n;
+
+    for (;;) {
+        /* Take whatever is queued, up to a batch, without waiting for more */
+        for (n=0; n < e->batch_size && (req = queue_pop(e)); n++) batch[n] = req;
+        if (n) {
+            __atomic_fetch_add(&e->batches, 1, __ATOMIC_RELAXED);
+            engine_run_batch(e, batch, n);
+            continue;
+        }
+
+        /* Idle.  Submitters check for sleepers after pushing, so re-check
+         * the queue after announcing ourselves to avoid missing a wakeup.
+         */
+        pthread_mutex_lock(&e->lock);
+        __atomic_fetch_add(&e->sleepers, 1, __ATOMIC_SEQ_CST);
+        while (!(req = queue_pop(e)) && !e->stopping) {
+            pthread_cond_wait(&e->wake, &e->lock);
+        }
+        __atomic_fetch_sub(&e->sleepers, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&e->lock);
+
+        if (!req) break; /* Stopping, and the queue is drained. */
+
+        batch[0] = req;
+        for (n=1; n < e->batch_size && (req = queue_pop(e)); n++) batch[n] = req;
+        __atomic_fetch_add(&e->batches, 1, __ATOMIC_RELAXED);
+        engine_run_batch(e, batch, n);
+    }
+    return NULL;
+}
+
+decaf_448_engine_s *
+decaf_448_engine_create (
+    unsigned int threads,
+    size_t queue_size,
+    unsigned int batch_size
+) {
+    decaf_448_engine_s *e;
+    size_t size = 2, i;
+
+    if (threads == 0) {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (ncpu > 0) ? (unsigned int)ncpu : 1;
+    }
+    if (batch_size == 0 || batch_size > DECAF_448_ENGINE_MAX_BATCH) {
+        batch_size = DECAF_448_ENGINE_MAX_BATCH;
+    }
+    while (size < queue_size) size <<= 1;
+
+    e = (decaf_448_engine_s *)calloc(1, sizeof(*e));
+    if (!e) return NULL;
+    e->cells = (struct engine_cell *)calloc(size, sizeof(struct engine_cell));
+    e->threads = (pthread_t *)calloc(threads, sizeof(pthread_t));
+    if (!e->cells || !e->threads) goto fail;
+    for (i=0; i<size; i++) e->cells[i].seq = i;
+    e->mask = size-1;
+    e->batch_size = batch_size;
+
+    if (pthread_mutex_init(&e->lock, NULL)) goto fail;
+    if (pthread_cond_init(&e->wake, NULL)) {
+        pthread_mutex_destroy(&e->lock);
+        goto fail;
+    }
+
+    for (e->nthreads=0; e->nthreads<threads; e->nthreads++) {
+        if (pthread_create(&e->threads[e->nthreads], NULL, engine_worker, e)) break;
+    }
+    if (!e->nthreads) {
+        decaf_448_engine_destroy(e);
+        return NULL;
+    }
+    return e;
+
+fail:
+    free(e->cells);
+    free(e->threads);
+    free(e);
+    return NULL;
+}
+
+decaf_bool_t
+decaf_448_engine_submit (
+    decaf_448_engine_s *e,
+    decaf_448_engine_request_s *req
+) {
+    req->submitted_ns = engine_now_ns();
+    if (!queue_push(e, req)) {
+        __atomic_fetch_add(&e->rejected, 1, __ATOMIC_RELAXED);
+        return DECAF_FAILURE;
+    }
+
+    uint64_t sub = __atomic_add_fetch(&e->submitted, 1, __ATOMIC_RELAXED);
+    uint64_t dequeued = __atomic_load_n(&e->dequeued, __ATOMIC_RELAXED);
+    uint64_t depth = (sub > dequeued) ? sub - dequeued : 0;
+    uint64_t max = __atomic_load_n(&e->max_depth, __ATOMIC_RELAXED);
+    while (depth > max && !__atomic_compare_exchange_n(&e->max_depth, &max, depth, 1,
+            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+
+    /* Pairs with the sleeper count in engine_worker */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&e->sleepers, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&e->lock);
+        pthread_cond_signal(&e->wake);
+        pthread_mutex_unlock(&e->lock);
+    }
+    return DECAF_SUCCESS;
+}
+
+void
+decaf_448_engine_stats (
+    decaf_448_engine_s *e,
+    decaf_448_engine_stats_s *stats
+) {
+    unsigned int i, j;
+    stats->submitted = __atomic_load_n(&e->submitted, __ATOMIC_RELAXED);
+    stats->rejected = __atomic_load_n(&e->rejected, __ATOMIC_RELAXED);
+    stats->completed = __atomic_load_n(&e->completed, __ATOMIC_RELAXED);
+    stats->batches = __atomic_load_n(&e->batches, __ATOMIC_RELAXED);
+    stats->max_queue_depth = __atomic_load_n(&e->max_depth, __ATOMIC_RELAXED);
+    uint64_t dequeued = __atomic_load_n(&e->dequeued, __ATOMIC_RELAXED);
+    stats->queue_depth = (stats->submitted > dequeued) ? stats->submitted - dequeued : 0;
+    for (i=0; i<2; i++) {
+        for (j=0; j<DECAF_448_ENGINE_LATENCY_BUCKETS; j++) {
+            stats->latency[i][j] = __atomic_load_n(&e->latency[i][j], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+void
+decaf_448_engine_destroy (
+    decaf_448_engine_s *e
+) {
+    unsigned int i;
+
+    pthread_mutex_lock(&e->lock);
+    e->stopping = 1;
+    pthread_cond_broadcast(&e->wake);
+    pthread_mutex_unlock(&e->lock);
+
+    for (i=0; i<e->nthreads; i++) pthread_join(e->threads[i], NULL);
+
+    pthread_cond_destroy(&e->wake);
+    pthread_mutex_destroy(&e->lock);
+    free(e->cells);
+    free(e->threads);
+    free(e);
+}
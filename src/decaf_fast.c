@@ -10,24 +10,13 @@
 
 #define _XOPEN_SOURCE 600 /* for posix_memalign */
 #define __STDC_WANT_LIB_EXT1__ 1 /* for memset_s */
-#include "decaf.h"
 #include <string.h>
 #include "field.h"
-#include "decaf_448_config.h"
+#include "modinv.h"
+#include "decaf_curve.h"
 
 #define WBITS DECAF_WORD_BITS
 
-/* Rename table for eventual factoring into .c.inc, MSR ECC style */
-#define SCALAR_LIMBS DECAF_448_SCALAR_LIMBS
-#define SCALAR_BITS DECAF_448_SCALAR_BITS
-#define NLIMBS DECAF_448_LIMBS
-#define API_NS(_id) decaf_448_##_id
-#define API_NS2(_pref,_id) _pref##_decaf_448_##_id
-#define scalar_t decaf_448_scalar_t
-#define point_t decaf_448_point_t
-#define precomputed_s decaf_448_precomputed_s
-#define SER_BYTES DECAF_448_SER_BYTES
-
 #if WBITS == 64
 typedef __int128_t decaf_sdword_t;
 #define SC_LIMB(x) (x##ull)
@@ -45,37 +34,45 @@ typedef int64_t decaf_sdword_t;
 #define siv static inline void __attribute__((always_inline))
 static const gf ZERO = {{{0}}}, ONE = {{{1}}}, TWO = {{{2}}};
 
-static const int EDWARDS_D = -39081;
+static const int EDWARDS_D = CURVE_EDWARDS_D;
 
-static const scalar_t sc_p = {{{
-    SC_LIMB(0x2378c292ab5844f3),
-    SC_LIMB(0x216cc2728dc58f55),
-    SC_LIMB(0xc44edb49aed63690),
-    SC_LIMB(0xffffffff7cca23e9),
-    SC_LIMB(0xffffffffffffffff),
-    SC_LIMB(0xffffffffffffffff),
-    SC_LIMB(0x3fffffffffffffff)
-}}};
+static const scalar_t sc_p = {{{ CURVE_SC_P }}};
 
 const scalar_t API_NS(scalar_one) = {{{1}}}, API_NS(scalar_zero) = {{{0}}};
 extern const scalar_t sc_r2;
 extern const decaf_word_t MONTGOMERY_FACTOR;
 
-/* sqrt(5) = 2phi-1 from the curve spec.  Not exported, but used by pregen tool. */
-const unsigned char base_point_ser_for_pregen[SER_BYTES] = {
-    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,1
-};
+/* Not exported, but used by pregen tool. */
+const unsigned char base_point_ser_for_pregen[SER_BYTES] = { CURVE_BASE_POINT_SER };
 
 extern const point_t API_NS(point_base);
 
+/* The public gf type must be the field's, padding and all */
+typedef char gf_is_field_t[sizeof(gf) == sizeof(field_t) ? 1 : -1];
+
 /* Projective Niels coordinates */
 typedef struct { gf a, b, c; } niels_s, niels_t[1];
 typedef struct { niels_t n; gf z; } pniels_s, pniels_t[1];
 
+/*
+ * [P]niels points as stored in the tables which are scanned in constant
+ * time.  Where the field has padding limbs, the entries leave them out,
+ * so that there is less to scan.
+ */
+#ifdef FIELD_PACKED_LIMBS
+#define table_fe_t field_packed_t
+typedef struct { field_packed_t a, b, c; } tniels_s, tniels_t[1];
+typedef struct { tniels_t n; field_packed_t z; } __attribute__((aligned(32))) tpniels_s, tpniels_t[1];
+#else
+#define table_fe_t field_t
+typedef niels_s tniels_s, tniels_t[1];
+typedef pniels_s tpniels_s, tpniels_t[1];
+#endif
+
 /* Precomputed base */
-struct precomputed_s { niels_t table [DECAF_COMBS_N<<(DECAF_COMBS_T-1)]; };
+struct precomputed_s { tniels_t table [DECAF_COMBS_N<<(DECAF_COMBS_T-1)]; };
 
-extern const field_t API_NS(precomputed_base_as_fe)[];
+extern const table_fe_t API_NS(precomputed_base_as_fe)[];
 const precomputed_s *API_NS(precomputed_base) =
     (const precomputed_s *) &API_NS(precomputed_base_as_fe);
 
@@ -103,6 +100,18 @@ siv gf_mul (gf c, const gf a, const gf b) {
     field_mul((field_t *)c, (const field_t *)a, (const field_t *)b);
 }
 
+/** c = a*b + d*e, with one reduction where the field supports it. */
+siv gf_mul_add (gf c, const gf a, const gf b, const gf d, const gf e) {
+    field_mul_add((field_t *)c, (const field_t *)a, (const field_t *)b,
+        (const field_t *)d, (const field_t *)e);
+}
+
+/** c = a*b - d*e, with one reduction where the field supports it. */
+siv gf_mul_sub (gf c, const gf a, const gf b, const gf d, const gf e) {
+    field_mul_sub((field_t *)c, (const field_t *)a, (const field_t *)b,
+        (const field_t *)d, (const field_t *)e);
+}
+
 /** Dedicated square */
 siv gf_sqr (gf c, const gf a) {
     field_sqr((field_t *)c, (const field_t *)a);
@@ -113,14 +122,9 @@ siv gf_isqrt(gf y, const gf x) {
     field_isr((field_t *)y, (const field_t *)x);
 }
 
-/** Inverse.  TODO: adapt to 5-mod-8 fields? */
-sv gf_invert(gf y, const gf x) {
-    gf t1, t2;
-    gf_sqr(t1, x); // o^2
-    gf_isqrt(t2, t1); // +-1/sqrt(o^2) = +-1/o
-    gf_sqr(t1, t2);
-    gf_mul(t2, t1, x); // not direct to y in case of alias.
-    gf_cpy(y, t2);
+/** Inverse.  Constant-time safegcd on 64-bit platforms; see modinv.c. */
+siv gf_invert(gf y, const gf x) {
+    field_inverse((field_t *)y, (const field_t *)x);
 }
 
 /** Add mod p.  Conservatively always weak-reduce. */
@@ -194,14 +198,16 @@ siv cond_swap(gf x, gf_s *__restrict__ y, decaf_bool_t swap) {
 
 /**
  * Mul by signed int.  Not constant-time WRT the sign of that int.
- * Just uses a full mul (PERF)
+ * For negative w, negates a lazily first, so it's still one mulw and
+ * no reduction besides the one mulw does.
  */
 siv gf_mlw(gf c, const gf a, int w) {
     if (w>0) {
         field_mulw((field_t *)c, (const field_t *)a, w);
     } else {
-        field_mulw((field_t *)c, (const field_t *)a, -w);
-        gf_sub(c,ZERO,c);
+        gf na;
+        gf_sub_nr(na,ZERO,a);
+        field_mulw((field_t *)c, (const field_t *)na, -w);
     }
 }
 
@@ -221,13 +227,25 @@ static decaf_word_t __attribute__((noinline)) gf_eq(const gf a, const gf b) {
     return ((decaf_dword_t)ret - 1) >> WBITS;
 }
 
+/**
+ * Inverse square root and inverse, from one exponentiation.  Returns
+ * whether x is square, or zero if allow_zero.
+ *
+ * y^2 = x^((p-3)/2) = chi(x)/x, so inv is 1/x if x is a nonzero square,
+ * -1/x if it isn't square, and 0 if x is 0.
+ */
+static decaf_bool_t gf_isqrt_inv_chk(gf y, gf inv, const gf x, decaf_bool_t allow_zero) {
+    gf tmp;
+    field_isr((field_t *)y, (const field_t *)x);
+    gf_sqr(inv,y);
+    gf_mul(tmp,inv,x);
+    return gf_eq(tmp,ONE) | (allow_zero & gf_eq(tmp,ZERO));
+}
+
 /** Inverse square root using addition chain. */
 static decaf_bool_t gf_isqrt_chk(gf y, const gf x, decaf_bool_t allow_zero) {
-    gf tmp0, tmp1;
-    field_isr((field_t *)y, (const field_t *)x);
-    gf_sqr(tmp0,y);
-    gf_mul(tmp1,tmp0,x);
-    return gf_eq(tmp1,ONE) | (allow_zero & gf_eq(tmp1,ZERO));
+    gf inv;
+    return gf_isqrt_inv_chk(y,inv,x,allow_zero);
 }
 
 /** Return high bit of x = low bit of 2x mod p */
@@ -324,6 +342,21 @@ decaf_bool_t API_NS(scalar_invert) (
     scalar_t out,
     const scalar_t a
 ) {
+#if MODINV62
+    static const modinv62_modulus_t sc_modinv = {
+        CURVE_SC_MODINV62, MODINV62_BATCHES(SCALAR_BITS)
+    };
+    unsigned char ser[SCALAR_BYTES];
+    modinv62_t t;
+    API_NS(scalar_encode)(ser, a);
+    modinv62_from_bytes(&t, ser, sizeof(ser));
+    modinv62(&t, &sc_modinv);
+    modinv62_to_bytes(ser, sizeof(ser), &t);
+    decaf_bool_t ok = API_NS(scalar_decode)(out, ser);
+    (void)ok; /* Always canonical */
+    decaf_bzero(ser, sizeof(ser));
+    decaf_bzero(&t, sizeof(t));
+#elif SCALAR_BITS == 446
     /* FIELD MAGIC */
     scalar_t chain[7], tmp;
     sc_montmul(chain[0],a,sc_r2);
@@ -370,6 +403,40 @@ decaf_bool_t API_NS(scalar_invert) (
     for (i=0; i<sizeof(chain)/sizeof(chain[0]); i++) {
         API_NS(scalar_destroy)(chain[i]);
     }
+#else
+    /* No addition chain for this curve: a^(q-2) with a fixed 4-bit window.
+     * The exponent is public, so it's OK to branch on it.
+     */
+    scalar_t table[15], e, tmp;
+    decaf_sdword_t chain = -2;
+    unsigned int i, j;
+    for (i=0; i<SCALAR_LIMBS; i++) {
+        chain += sc_p->limb[i];
+        e->limb[i] = chain;
+        chain >>= WBITS;
+    }
+
+    sc_montmul(table[0],a,sc_r2);
+    for (i=1; i<15; i++) {
+        sc_montmul(table[i],table[i-1],table[0]);
+    }
+
+    sc_montmul(tmp,API_NS(scalar_one),sc_r2);
+    for (i=SCALAR_LIMBS*WBITS; i; ) {
+        i -= 4;
+        unsigned int nib = (e->limb[i/WBITS] >> (i%WBITS)) & 15;
+        for (j=0; j<4; j++) {
+            sc_montsqr(tmp,tmp);
+        }
+        if (nib) sc_montmul(tmp,tmp,table[nib-1]);
+    }
+
+    sc_montmul(out,tmp,API_NS(scalar_one));
+    API_NS(scalar_destroy)(tmp);
+    for (i=0; i<sizeof(table)/sizeof(table[0]); i++) {
+        API_NS(scalar_destroy)(table[i]);
+    }
+#endif
     return ~API_NS(scalar_eq)(out,API_NS(scalar_zero));
 }
 
@@ -444,35 +511,47 @@ static void gf_encode ( unsigned char ser[SER_BYTES], gf a ) {
     field_serialize(ser, (field_t *)a);
 }
 
-static void deisogenize(
+/**
+ * Second half of deisogenize, given r = 1/sqrt((a-d)(Z+Y)(Z-Y)).
+ * Either sign of r gives the same result.
+ */
+siv deisogenize_finish(
     gf_s *__restrict__ s,
     gf_s *__restrict__ minus_t_over_s,
     const point_t p,
+    const gf r,
     decaf_bool_t toggle_hibit_s,
     decaf_bool_t toggle_hibit_t_over_s
 ) {
-    /* Can shave off one mul here; not important but makes consistent with paper */
-    gf b, d;
+    gf b, d, e;
     gf_s *a = s, *c = minus_t_over_s;
     gf_mlw ( a, p->y, 1-EDWARDS_D );
-    gf_mul ( c, a, p->t );     /* -dYT, with EDWARDS_D = d-1 */
-    gf_mul ( a, p->x, p->z ); 
-    gf_sub ( d, c, a );  /* aXZ-dYT with a=-1 */
+    gf_mul_sub ( d, a, p->t, p->x, p->z ); /* aXZ-dYT with a=-1, EDWARDS_D = d-1 */
+    gf_mlw ( b, r, -EDWARDS_D ); /* u in the paper */
+    gf_mul ( e, b, r ); /* ur */
+    gf_add ( a, b, b );  /* 2u = -2au since a=-1 */
+    gf_mul ( c, a, p->z ); /* 2uZ */
+    cond_neg ( b, toggle_hibit_t_over_s ^ ~hibit(c) ); /* u <- -u if negative. */
+    cond_neg ( c, toggle_hibit_t_over_s ^ ~hibit(c) ); /* u <- -u if negative. */
+    gf_mul_add ( s, e, d, b, p->y ); /* ur (aZX-dYT) + uY */
+    cond_neg ( s, toggle_hibit_s ^ hibit(s) );
+}
+
+static void deisogenize(
+    gf_s *__restrict__ s,
+    gf_s *__restrict__ minus_t_over_s,
+    const point_t p,
+    decaf_bool_t toggle_hibit_s,
+    decaf_bool_t toggle_hibit_t_over_s
+) {
+    /* Can shave off one mul here; not important but makes consistent with paper */
+    gf a, b, c;
     gf_add ( a, p->z, p->y ); 
     gf_sub ( b, p->z, p->y ); 
     gf_mul ( c, b, a );
     gf_mlw ( b, c, -EDWARDS_D ); /* (a-d)(Z+Y)(Z-Y) */
     gf_isqrt ( a, b ); /* r in the paper */
-    gf_mlw ( b, a, -EDWARDS_D ); /* u in the paper */
-    gf_mul ( c, b, a ); /* ur */
-    gf_mul ( a, c, d ); /* ur (aZX-dYT) */
-    gf_add ( d, b, b );  /* 2u = -2au since a=-1 */
-    gf_mul ( c, d, p->z ); /* 2uZ */
-    cond_neg ( b, toggle_hibit_t_over_s ^ ~hibit(c) ); /* u <- -u if negative. */
-    cond_neg ( c, toggle_hibit_t_over_s ^ ~hibit(c) ); /* u <- -u if negative. */
-    gf_mul ( d, b, p->y ); 
-    gf_add ( s, a, d );
-    cond_neg ( s, toggle_hibit_s ^ hibit(s) );
+    deisogenize_finish(s, minus_t_over_s, p, a, toggle_hibit_s, toggle_hibit_t_over_s);
 }
 
 void API_NS(point_encode)( unsigned char ser[SER_BYTES], const point_t p ) {
@@ -607,7 +686,7 @@ void API_NS(point_negate) (
 
 siv scalar_decode_short (
     scalar_t s,
-    const unsigned char ser[SER_BYTES],
+    const unsigned char ser[SCALAR_BYTES],
     unsigned int nbytes
 ) {
     unsigned int i,j,k=0;
@@ -622,10 +701,10 @@ siv scalar_decode_short (
 
 decaf_bool_t API_NS(scalar_decode)(
     scalar_t s,
-    const unsigned char ser[SER_BYTES]
+    const unsigned char ser[SCALAR_BYTES]
 ) {
     unsigned int i;
-    scalar_decode_short(s, ser, SER_BYTES);
+    scalar_decode_short(s, ser, SCALAR_BYTES);
     decaf_sdword_t accum = 0;
     for (i=0; i<SCALAR_LIMBS; i++) {
         accum = (accum + s->limb[i] - sc_p->limb[i]) >> WBITS;
@@ -678,21 +757,18 @@ void API_NS(scalar_decode_long)(
     size_t i;
     scalar_t t1, t2;
 
-    i = ser_len - (ser_len%SER_BYTES);
-    if (i==ser_len) i -= SER_BYTES;
+    i = ser_len - (ser_len%SCALAR_BYTES);
+    if (i==ser_len) i -= SCALAR_BYTES;
     
     scalar_decode_short(t1, &ser[i], ser_len-i);
 
-    if (ser_len == sizeof(scalar_t)) {
-        assert(i==0);
-        /* ham-handed reduce */
-        API_NS(scalar_mul)(s,t1,API_NS(scalar_one));
-        API_NS(scalar_destroy)(t1);
-        return;
+    if (8*(ser_len-i) > SCALAR_BITS) {
+        /* The top chunk might not be reduced: ham-handed reduce */
+        API_NS(scalar_mul)(t1,t1,API_NS(scalar_one));
     }
 
     while (i) {
-        i -= SER_BYTES;
+        i -= SCALAR_BYTES;
         sc_montmul(t1,t1,sc_r2);
         ignore_result( API_NS(scalar_decode)(t2, ser+i) );
         API_NS(scalar_add)(t1, t1, t2);
@@ -704,12 +780,12 @@ void API_NS(scalar_decode_long)(
 }
 
 void API_NS(scalar_encode)(
-    unsigned char ser[SER_BYTES],
+    unsigned char ser[SCALAR_BYTES],
     const scalar_t s
 ) {
     unsigned int i,j,k=0;
     for (i=0; i<SCALAR_LIMBS; i++) {
-        for (j=0; j<sizeof(decaf_word_t); j++,k++) {
+        for (j=0; j<sizeof(decaf_word_t) && k<SCALAR_BYTES; j++,k++) {
             ser[k] = s->limb[i] >> (8*j);
         }
     }
@@ -821,6 +897,34 @@ sv sub_pniels_from_pt (
     sub_niels_from_pt( p, pn->n, before_double );
 }
 
+/* To and from table entries */
+#ifdef FIELD_PACKED_LIMBS
+siv niels_store ( tniels_t out, const niels_t in ) {
+    field_pack(&out->a, (const field_t *)in->a);
+    field_pack(&out->b, (const field_t *)in->b);
+    field_pack(&out->c, (const field_t *)in->c);
+}
+
+siv niels_load ( niels_t out, const tniels_t in ) {
+    field_unpack((field_t *)out->a, &in->a);
+    field_unpack((field_t *)out->b, &in->b);
+    field_unpack((field_t *)out->c, &in->c);
+}
+
+siv pniels_store ( tpniels_t out, const pniels_t in ) {
+    niels_store(out->n, in->n);
+    field_pack(&out->z, (const field_t *)in->z);
+}
+
+siv pniels_load ( pniels_t out, const tpniels_t in ) {
+    niels_load(out->n, in->n);
+    field_unpack((field_t *)out->z, &in->z);
+}
+#else
+siv niels_store ( tniels_t out, const niels_t in ) { out[0] = in[0]; }
+siv pniels_store ( tpniels_t out, const pniels_t in ) { out[0] = in[0]; }
+#endif
+
 extern const scalar_t API_NS(point_scalarmul_adjustment);
 
 /* TODO: get rid of big_register_t dependencies? */
@@ -848,24 +952,149 @@ siv constant_time_lookup_xx (
     }
 }
 
+siv constant_time_lookup_xx_pniels (
+    pniels_s *__restrict__ pn,
+    const void *table, /* tpniels_t[nelts] */
+    int nelts,
+    int idx
+) {
+#ifdef FIELD_PACKED_LIMBS
+    tpniels_t packed;
+    constant_time_lookup_xx(packed, table, sizeof(tpniels_s), nelts, idx);
+    pniels_load(pn, packed);
+#else
+    constant_time_lookup_xx(pn, table, sizeof(pniels_s), nelts, idx);
+#endif
+}
+
+static void gf_batch_invert (
+    gf *__restrict__ out,
+    /* const */ gf *in,
+    unsigned int n
+) {
+    gf t1;
+    assert(n>1);
+  
+    gf_cpy(out[1], in[0]);
+    int i;
+    for (i=1; i<(int) (n-1); i++) {
+        gf_mul(out[i+1], out[i], in[i]);
+    }
+    gf_mul(out[0], out[n-1], in[n-1]);
+
+    gf_invert(out[0], out[0]);
+
+    for (i=n-1; i>0; i--) {
+        gf_mul(t1, out[i], out[0]);
+        gf_cpy(out[i], t1);
+        gf_mul(t1, out[0], in[i]);
+        gf_cpy(out[0], t1);
+    }
+}
+
+static void batch_normalize_niels (
+    niels_t *table,
+    gf *zs,
+    gf *zis,
+    int n
+) {
+    int i;
+    gf product;
+    gf_batch_invert(zis, zs, n);
+
+    for (i=0; i<n; i++) {
+        gf_mul(product, table[i]->a, zis[i]);
+        gf_canon(product);
+        gf_cpy(table[i]->a, product);
+        
+        gf_mul(product, table[i]->b, zis[i]);
+        gf_canon(product);
+        gf_cpy(table[i]->b, product);
+        
+        gf_mul(product, table[i]->c, zis[i]);
+        gf_canon(product);
+        gf_cpy(table[i]->c, product);
+    }
+}
+
+siv constant_time_lookup_xx_niels (
+    niels_s *__restrict__ ni,
+    const tniels_t *table,
+    int nelts,
+    int idx
+) {
+#ifdef FIELD_PACKED_LIMBS
+    /* Not a multiple of the vector size, so the generic lookup */
+    tniels_t packed;
+    constant_time_lookup(packed, table, sizeof(tniels_s), nelts, idx);
+    niels_load(ni, packed);
+#else
+    constant_time_lookup_xx(ni, table, sizeof(niels_s), nelts, idx);
+#endif
+}
+
+/*
+ * Normalizing the fixed window table to niels costs an inversion plus about
+ * six multiplies per entry.  Each window then saves the multiply by z in the
+ * add, and a quarter of its lookup (worth about another quarter multiply).
+ */
+#define WINDOW_NIELS_PAYS(window) \
+    (5*((SCALAR_BITS+(window)-1)/(window)) > \
+        4*(DECAF_INVERT_MULS + 6*(1<<((window)-1))))
+
+#ifndef DECAF_WINDOW_NIELS
+#define DECAF_WINDOW_NIELS WINDOW_NIELS_PAYS(DECAF_WINDOW_BITS)
+#endif
+
+#if !DECAF_WINDOW_NIELS || !DECAF_JOINT_WINDOW_BITS
 snv prepare_fixed_window(
-    pniels_t *multiples,
+    tpniels_t *multiples,
     const point_t b,
     int ntable
 ) {
     point_t tmp;
-    pniels_t pn;
+    pniels_t pn, pm;
     int i;
     
     point_double_internal(tmp, b, 0);
     pt_to_pniels(pn, tmp);
-    pt_to_pniels(multiples[0], b);
+    pt_to_pniels(pm, b);
+    pniels_store(multiples[0], pm);
     API_NS(point_copy)(tmp, b);
     for (i=1; i<ntable; i++) {
         add_pniels_to_pt(tmp, pn, 0);
-        pt_to_pniels(multiples[i], tmp);
+        pt_to_pniels(pm, tmp);
+        pniels_store(multiples[i], pm);
     }
 }
+#endif
+
+#if DECAF_WINDOW_NIELS
+snv prepare_fixed_window_niels (
+    tniels_t *multiples,
+    const point_t b,
+    int ntable
+) {
+    point_t tmp;
+    pniels_t pn, pm;
+    niels_t entries[ntable];
+    gf zs[ntable], zis[ntable];
+    int i;
+    
+    point_double_internal(tmp, b, 0);
+    pt_to_pniels(pn, tmp);
+    API_NS(point_copy)(tmp, b);
+    for (i=0; i<ntable; i++) {
+        if (i) add_pniels_to_pt(tmp, pn, 0);
+        pt_to_pniels(pm, tmp);
+        memcpy(entries[i], pm->n, sizeof(pm->n));
+        gf_cpy(zs[i], pm->z);
+    }
+    
+    batch_normalize_niels(entries, zs, zis, ntable);
+    for (i=0; i<ntable; i++) niels_store(multiples[i], entries[i]);
+}
+#endif
 
 void API_NS(point_scalarmul) (
     point_t a,
@@ -882,9 +1111,16 @@ void API_NS(point_scalarmul) (
     sc_halve(scalar1x,scalar1x,sc_p);
     
     /* Set up a precomputed table with odd multiples of b. */
-    pniels_t pn, multiples[NTABLE];
     point_t tmp;
+#if DECAF_WINDOW_NIELS
+    niels_t ni;
+    tniels_t multiples[NTABLE];
+    prepare_fixed_window_niels(multiples, b, NTABLE);
+#else
+    pniels_t pn;
+    tpniels_t multiples[NTABLE];
     prepare_fixed_window(multiples, b, NTABLE);
+#endif
 
     /* Initialize. */
     int i,j,first=1;
@@ -901,10 +1137,20 @@ void API_NS(point_scalarmul) (
         bits ^= inv;
     
         /* Add in from table.  Compute t only on last iteration. */
-        constant_time_lookup_xx(pn, multiples, sizeof(pn), NTABLE, bits & WINDOW_T_MASK);
+#if DECAF_WINDOW_NIELS
+        constant_time_lookup_xx_niels(ni, (const tniels_t *)multiples, NTABLE,
+            bits & WINDOW_T_MASK);
+        cond_neg_niels(ni, inv);
+#else
+        constant_time_lookup_xx_pniels(pn, multiples, NTABLE, bits & WINDOW_T_MASK);
         cond_neg_niels(pn->n, inv);
+#endif
         if (first) {
+#if DECAF_WINDOW_NIELS
+            niels_to_pt(tmp, ni);
+#else
             pniels_to_pt(tmp, pn);
+#endif
             first = 0;
         } else {
            /* Using Hisil et al's lookahead method instead of extensible here
@@ -914,7 +1160,11 @@ void API_NS(point_scalarmul) (
             for (j=0; j<WINDOW-1; j++)
                 point_double_internal(tmp, tmp, -1);
             point_double_internal(tmp, tmp, 0);
+#if DECAF_WINDOW_NIELS
+            add_niels_to_pt(tmp, ni, i ? -1 : 0);
+#else
             add_pniels_to_pt(tmp, pn, i ? -1 : 0);
+#endif
         }
     }
     
@@ -922,6 +1172,7 @@ void API_NS(point_scalarmul) (
     API_NS(point_copy)(a,tmp);
 }
 
+#if !DECAF_JOINT_WINDOW_BITS
 void API_NS(point_double_scalarmul) (
     point_t a,
     const point_t b,
@@ -941,7 +1192,8 @@ void API_NS(point_double_scalarmul) (
     sc_halve(scalar2x,scalar2x,sc_p);
     
     /* Set up a precomputed table with odd multiples of b. */
-    pniels_t pn, multiples1[NTABLE], multiples2[NTABLE];
+    pniels_t pn;
+    tpniels_t multiples1[NTABLE], multiples2[NTABLE];
     point_t tmp;
     prepare_fixed_window(multiples1, b, NTABLE);
     prepare_fixed_window(multiples2, c, NTABLE);
@@ -966,7 +1218,7 @@ void API_NS(point_double_scalarmul) (
         bits2 ^= inv2;
     
         /* Add in from table.  Compute t only on last iteration. */
-        constant_time_lookup_xx(pn, multiples1, sizeof(pn), NTABLE, bits1 & WINDOW_T_MASK);
+        constant_time_lookup_xx_pniels(pn, multiples1, NTABLE, bits1 & WINDOW_T_MASK);
         cond_neg_niels(pn->n, inv1);
         if (first) {
             pniels_to_pt(tmp, pn);
@@ -981,7 +1233,7 @@ void API_NS(point_double_scalarmul) (
             point_double_internal(tmp, tmp, 0);
             add_pniels_to_pt(tmp, pn, 0);
         }
-        constant_time_lookup_xx(pn, multiples2, sizeof(pn), NTABLE, bits2 & WINDOW_T_MASK);
+        constant_time_lookup_xx_pniels(pn, multiples2, NTABLE, bits2 & WINDOW_T_MASK);
         cond_neg_niels(pn->n, inv2);
         add_pniels_to_pt(tmp, pn, i?-1:0);
     }
@@ -989,6 +1241,7 @@ void API_NS(point_double_scalarmul) (
     /* Write out the answer */
     API_NS(point_copy)(a,tmp);
 }
+#endif /* !DECAF_JOINT_WINDOW_BITS */
 
 decaf_bool_t API_NS(point_eq) ( const point_t p, const point_t q ) {
     /* equality mod 2-torsion compares x/y */
@@ -1080,7 +1333,7 @@ unsigned char API_NS(point_from_hash_nonuniform) (
 
 decaf_bool_t
 API_NS(invert_elligator_nonuniform) (
-    unsigned char recovered_hash[DECAF_448_SER_BYTES],
+    unsigned char recovered_hash[SER_BYTES],
     const point_t p,
     unsigned char hint
 ) {
@@ -1176,68 +1429,39 @@ void API_NS(point_debugging_2torque) (
     gf_cpy(q->t,p->t);
 }
 
-static void gf_batch_invert (
-    gf *__restrict__ out,
-    /* const */ gf *in,
-    unsigned int n
-) {
-    gf t1;
-    assert(n>1);
-  
-    gf_cpy(out[1], in[0]);
-    int i;
-    for (i=1; i<(int) (n-1); i++) {
-        gf_mul(out[i+1], out[i], in[i]);
-    }
-    gf_mul(out[0], out[n-1], in[n-1]);
-
-    gf_invert(out[0], out[0]);
-
-    for (i=n-1; i>0; i--) {
-        gf_mul(t1, out[i], out[0]);
-        gf_cpy(out[i], t1);
-        gf_mul(t1, out[0], in[i]);
-        gf_cpy(out[0], t1);
-    }
-}
+/* Precomputed comb table with runtime parameters */
+struct precomputed_comb_s {
+    unsigned int n, t, s;
+    scalar_t adjustment; /* 2^(n*t*s) - 1 */
+    tniels_t table[];    /* n<<(t-1) entries */
+};
 
-static void batch_normalize_niels (
-    niels_t *table,
-    gf *zs,
-    gf *zis,
-    int n
+static int comb_params_ok (
+    unsigned int n,
+    unsigned int t,
+    unsigned int s
 ) {
-    int i;
-    gf product;
-    gf_batch_invert(zis, zs, n);
-
-    for (i=0; i<n; i++) {
-        gf_mul(product, table[i]->a, zis[i]);
-        gf_canon(product);
-        gf_cpy(table[i]->a, product);
-        
-        gf_mul(product, table[i]->b, zis[i]);
-        gf_canon(product);
-        gf_cpy(table[i]->b, product);
-        
-        gf_mul(product, table[i]->c, zis[i]);
-        gf_canon(product);
-        gf_cpy(table[i]->c, product);
-    }
+    return n >= 1 && n <= SCALAR_BITS
+        && t >= 2 && t <= DECAF_COMBS_MAX_T
+        && s >= 1 && s <= SCALAR_BITS
+        && n*t*s >= SCALAR_BITS;
 }
 
-void API_NS(precompute) (
-    precomputed_s *table,
+siv comb_precompute (
+    tniels_t *table,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
     const point_t base
 ) { 
-    const unsigned int n = DECAF_COMBS_N, t = DECAF_COMBS_T, s = DECAF_COMBS_S;
     assert(n*t*s >= SCALAR_BITS);
   
     point_t working, start, doubles[t-1];
     API_NS(point_copy)(working, base);
     pniels_t pn_tmp;
   
-    gf zs[n<<(t-1)], zis[n<<(t-1)];
+    gf zs[1<<(t-1)], zis[1<<(t-1)];
+    niels_t comb[1<<(t-1)];
   
     unsigned int i,j,k;
     
@@ -1261,10 +1485,10 @@ void API_NS(precompute) (
         /* Gray-code phase */
         for (j=0;; j++) {
             int gray = j ^ (j>>1);
-            int idx = (((i+1)<<(t-1))-1) ^ gray;
+            int idx = ((1<<(t-1))-1) ^ gray;
 
             pt_to_pniels(pn_tmp, start);
-            memcpy(table->table[idx], pn_tmp->n, sizeof(pn_tmp->n));
+            memcpy(comb[idx], pn_tmp->n, sizeof(pn_tmp->n));
             gf_cpy(zs[idx], pn_tmp->z);
 			
             if (j >= (1u<<(t-1)) - 1) break;
@@ -1279,33 +1503,258 @@ void API_NS(precompute) (
                 API_NS(point_sub)(start, start, doubles[k]);
             }
         }
+        
+        /* Normalize each comb separately, to bound the stack use */
+        batch_normalize_niels(comb,zs,zis,1<<(t-1));
+        for (j=0; j<1u<<(t-1); j++)
+            niels_store(table[(i<<(t-1)) + j], comb[j]);
+    }
+}
+
+/** Number of points sharing one inversion in batch encoding. */
+#define ENCODE_BATCH_SIZE 64
+
+void API_NS(point_double_and_encode_batch) (
+    unsigned char *ser,
+    const point_t *points,
+    size_t n
+) {
+    point_t doubled[ENCODE_BATCH_SIZE];
+    gf ws[ENCODE_BATCH_SIZE], wis[ENCODE_BATCH_SIZE], r, tmp;
+    decaf_bool_t zero[ENCODE_BATCH_SIZE];
+    size_t i, j, m;
+    
+    for (i=0; i<n; i+=m) {
+        m = (n-i < ENCODE_BATCH_SIZE) ? n-i : ENCODE_BATCH_SIZE;
+        
+        for (j=0; j<m; j++) {
+            const struct point_s *q = points[i+j];
+            
+            /* Same as point_double_internal, so that for G = 2XY and
+             * D = Y^2-X^2, (a-d)(Z+Y)(Z-Y) of the double is (EDWARDS_D*G*D)^2.
+             * So there is no square root left to take, only an inverse.
+             */
+            point_double_internal(doubled[j], q, 0);
+            gf_sqr ( tmp, q->x );
+            gf_sqr ( r, q->y );
+            gf_sub ( ws[j], r, tmp ); /* D */
+            gf_mul ( tmp, q->x, q->y );
+            gf_mul ( r, tmp, ws[j] );
+            gf_mlw ( ws[j], r, -2*EDWARDS_D ); /* W, up to sign */
+            
+            /* W = 0 only for the identity, which encodes as 0 */
+            zero[j] = gf_eq(ws[j], ZERO);
+            cond_sel(ws[j], ws[j], ONE, zero[j]);
+        }
+        
+        if (m > 1) {
+            gf_batch_invert(wis, ws, m);
+        } else {
+            gf_invert(wis[0], ws[0]);
+        }
+        
+        for (j=0; j<m; j++) {
+            cond_sel(r, wis[j], ZERO, zero[j]);
+            deisogenize_finish(ws[j], tmp, doubled[j], r, 0, 0);
+            gf_encode(&ser[(i+j)*SER_BYTES], ws[j]);
+        }
+    }
+    
+    decaf_bzero(doubled, sizeof(doubled));
+    decaf_bzero(ws, sizeof(ws));
+    decaf_bzero(wis, sizeof(wis));
+}
+
+void API_NS(precompute) (
+    precomputed_s *table,
+    const point_t base
+) { 
+    comb_precompute(table->table, DECAF_COMBS_N, DECAF_COMBS_T, DECAF_COMBS_S, base);
+}
+
+void API_NS(precompute_comb_table) (
+    tniels_t *table,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
+    const point_t base
+) __attribute__ ((visibility ("hidden")));
+
+void API_NS(precompute_comb_table) (
+    tniels_t *table,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
+    const point_t base
+) {
+    assert(comb_params_ok(n,t,s));
+    comb_precompute(table, n, t, s, base);
+}
+
+size_t API_NS(sizeof_precomputed_comb) (
+    unsigned int n,
+    unsigned int t,
+    unsigned int s
+) {
+    if (!comb_params_ok(n,t,s)) return 0;
+    return sizeof(precomputed_comb_s) + (n<<(t-1))*sizeof(tniels_t);
+}
+
+size_t API_NS(alignof_precomputed_comb) (void) {
+    return 32;
+}
+
+decaf_bool_t API_NS(precompute_comb) (
+    precomputed_comb_s *a,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
+    const point_t b
+) {
+    unsigned int i;
+    if (!comb_params_ok(n,t,s)) return DECAF_FAILURE;
+    
+    a->n = n;
+    a->t = t;
+    a->s = s;
+    API_NS(scalar_copy)(a->adjustment, API_NS(scalar_one));
+    for (i=0; i<n*t*s; i++) {
+        API_NS(scalar_add)(a->adjustment, a->adjustment, a->adjustment);
     }
+    API_NS(scalar_sub)(a->adjustment, a->adjustment, API_NS(scalar_one));
     
-    batch_normalize_niels(table->table,zs,zis,n<<(t-1));
+    comb_precompute(a->table, n, t, s, b);
+    return DECAF_SUCCESS;
 }
 
 extern const scalar_t API_NS(precomputed_scalarmul_adjustment);
 
-siv constant_time_lookup_xx_niels (
-    niels_s *__restrict__ ni,
-    const niels_t *table,
-    int nelts,
-    int idx
+#if DECAF_JOINT_WINDOW_BITS
+extern const scalar_t API_NS(point_double_scalarmul_adjustment);
+
+/**
+ * Joint table for b and c: entry (i<<window) + j is
+ * (2i+1)*b + (2j+1-2^window)*c, for 0 <= i < 2^(window-1), 0 <= j < 2^window.
+ */
+snv prepare_joint_window (
+    tniels_t *table,
+    const point_t b,
+    const point_t c,
+    unsigned int window
 ) {
-    constant_time_lookup_xx(ni, table, sizeof(niels_s), nelts, idx);
+    const unsigned int half = 1<<(window-1), n = half<<window;
+    point_t row, tmp;
+    pniels_t b2, c2, pn;
+    niels_t entries[n];
+    gf zs[n], zis[n];
+    unsigned int i, j;
+    
+    point_double_internal(tmp, b, 0);
+    pt_to_pniels(b2, tmp);
+    point_double_internal(tmp, c, 0);
+    pt_to_pniels(c2, tmp);
+    
+    /* row = b - (2^window-1)*c */
+    API_NS(point_copy)(tmp, c);
+    for (j=1; j<half; j++) add_pniels_to_pt(tmp, c2, 0);
+    API_NS(point_sub)(row, b, tmp);
+    
+    for (i=0; i<half; i++) {
+        if (i) add_pniels_to_pt(row, b2, 0);
+        API_NS(point_copy)(tmp, row);
+        for (j=0; j<1u<<window; j++) {
+            if (j) add_pniels_to_pt(tmp, c2, 0);
+            pt_to_pniels(pn, tmp);
+            memcpy(entries[(i<<window)+j], pn->n, sizeof(pn->n));
+            gf_cpy(zs[(i<<window)+j], pn->z);
+        }
+    }
+    
+    batch_normalize_niels(entries, zs, zis, n);
+    for (i=0; i<n; i++) niels_store(table[i], entries[i]);
 }
 
-void API_NS(precomputed_scalarmul) (
+void API_NS(point_double_scalarmul) (
+    point_t a,
+    const point_t b,
+    const scalar_t scalarb,
+    const point_t c,
+    const scalar_t scalarc
+) {
+    const int WINDOW = DECAF_JOINT_WINDOW_BITS,
+        WINDOW_MASK = (1<<WINDOW)-1,
+        WINDOW_T_MASK = WINDOW_MASK >> 1,
+        NTABLE = 1<<(2*WINDOW-1);
+        
+    scalar_t scalar1x, scalar2x;
+    API_NS(scalar_add)(scalar1x, scalarb, API_NS(point_double_scalarmul_adjustment));
+    sc_halve(scalar1x,scalar1x,sc_p);
+    API_NS(scalar_add)(scalar2x, scalarc, API_NS(point_double_scalarmul_adjustment));
+    sc_halve(scalar2x,scalar2x,sc_p);
+    
+    /* Set up a joint table of the combinations of odd multiples of b and c. */
+    niels_t ni;
+    tniels_t table[NTABLE];
+    point_t tmp;
+    prepare_joint_window(table, b, c, WINDOW);
+
+    /* Initialize. */
+    int i,j,first=1;
+    i = SCALAR_BITS - ((SCALAR_BITS-1) % WINDOW) - 1;
+
+    for (; i>=0; i-=WINDOW) {
+        /* Fetch another block of bits */
+        decaf_word_t bits1 = scalar1x->limb[i/WBITS] >> (i%WBITS),
+                     bits2 = scalar2x->limb[i/WBITS] >> (i%WBITS);
+        if (i%WBITS >= WBITS-WINDOW && i/WBITS<SCALAR_LIMBS-1) {
+            bits1 ^= scalar1x->limb[i/WBITS+1] << (WBITS - (i%WBITS));
+            bits2 ^= scalar2x->limb[i/WBITS+1] << (WBITS - (i%WBITS));
+        }
+        bits1 &= WINDOW_MASK;
+        bits2 &= WINDOW_MASK;
+        decaf_word_t inv1 = (bits1>>(WINDOW-1))-1;
+        decaf_word_t inv2 = (bits2>>(WINDOW-1))-1;
+        bits1 ^= inv1;
+        bits2 ^= inv2;
+        
+        /*
+         * The digits are +-(2*bits+1).  Look up b's digit made positive,
+         * with c's digit times the same sign, and negate the sum after.
+         */
+        decaf_word_t col = ((bits2 & WINDOW_T_MASK) ^ inv1 ^ inv2) + (WINDOW_T_MASK+1);
+        constant_time_lookup_xx_niels(ni, (const tniels_t *)table, NTABLE,
+            ((bits1 & WINDOW_T_MASK) << WINDOW) | (col & WINDOW_MASK));
+        cond_neg_niels(ni, inv1);
+        if (first) {
+            niels_to_pt(tmp, ni);
+            first = 0;
+        } else {
+            for (j=0; j<WINDOW-1; j++)
+                point_double_internal(tmp, tmp, -1);
+            point_double_internal(tmp, tmp, 0);
+            add_niels_to_pt(tmp, ni, i ? -1 : 0);
+        }
+    }
+    
+    /* Write out the answer */
+    API_NS(point_copy)(a,tmp);
+}
+#endif /* DECAF_JOINT_WINDOW_BITS */
+
+siv comb_scalarmul (
     point_t out,
-    const precomputed_s *table,
+    const tniels_t *table,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
+    const scalar_t adjustment,
     const scalar_t scalar
 ) {
     int i;
     unsigned j,k;
-    const unsigned int n = DECAF_COMBS_N, t = DECAF_COMBS_T, s = DECAF_COMBS_S;
     
     scalar_t scalar1x;
-    API_NS(scalar_add)(scalar1x, scalar, API_NS(precomputed_scalarmul_adjustment));
+    API_NS(scalar_add)(scalar1x, scalar, adjustment);
     sc_halve(scalar1x,scalar1x,sc_p);
     
     niels_t ni;
@@ -1327,10 +1776,10 @@ void API_NS(precomputed_scalarmul) (
             tab ^= invert;
             tab &= (1<<(t-1)) - 1;
 
-            constant_time_lookup_xx_niels(ni, &table->table[j<<(t-1)], 1<<(t-1), tab);
+            constant_time_lookup_xx_niels(ni, &table[j<<(t-1)], 1<<(t-1), tab);
 
             cond_neg_niels(ni, invert);
-            if ((i!=s-1)||j) {
+            if ((i!=(int)s-1)||j) {
                 add_niels_to_pt(out, ni, j==n-1 && i);
             } else {
                 niels_to_pt(out, ni);
@@ -1339,6 +1788,68 @@ void API_NS(precomputed_scalarmul) (
     }
 }
 
+/* Out-of-line version for runtime parameters */
+snv comb_scalarmul_var (
+    point_t out,
+    const tniels_t *table,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
+    const scalar_t adjustment,
+    const scalar_t scalar
+) {
+    comb_scalarmul(out, table, n, t, s, adjustment, scalar);
+}
+
+void API_NS(precomputed_scalarmul) (
+    point_t out,
+    const precomputed_s *table,
+    const scalar_t scalar
+) {
+    comb_scalarmul(out, table->table, DECAF_COMBS_N, DECAF_COMBS_T, DECAF_COMBS_S,
+        API_NS(precomputed_scalarmul_adjustment), scalar);
+}
+
+void API_NS(precomputed_comb_scalarmul) (
+    point_t out,
+    const precomputed_comb_s *table,
+    const scalar_t scalar
+) {
+    comb_scalarmul_var(out, table->table, table->n, table->t, table->s,
+        table->adjustment, scalar);
+}
+
+extern const table_fe_t API_NS(precomputed_base_combs_as_fe)[];
+extern const scalar_t API_NS(precomputed_base_comb_adjustments)[];
+static const unsigned int extra_base_combs[][3] = { DECAF_EXTRA_BASE_COMBS };
+
+decaf_bool_t API_NS(precomputed_base_comb_scalarmul) (
+    point_t out,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
+    const scalar_t scalar
+) {
+    const tniels_t *table = (const tniels_t *)API_NS(precomputed_base_combs_as_fe);
+    unsigned int i;
+    
+    if (n == DECAF_COMBS_N && t == DECAF_COMBS_T && s == DECAF_COMBS_S) {
+        API_NS(precomputed_scalarmul)(out, API_NS(precomputed_base), scalar);
+        return DECAF_SUCCESS;
+    }
+    
+    for (i=0; i<sizeof(extra_base_combs)/sizeof(extra_base_combs[0]); i++) {
+        const unsigned int *c = extra_base_combs[i];
+        if (n == c[0] && t == c[1] && s == c[2]) {
+            comb_scalarmul_var(out, table, n, t, s,
+                API_NS(precomputed_base_comb_adjustments)[i], scalar);
+            return DECAF_SUCCESS;
+        }
+        table += c[0] << (c[1]-1);
+    }
+    return DECAF_FAILURE;
+}
+
 #if DECAF_USE_MONTGOMERY_LADDER
 /** Return high bit of x/2 = low bit of x mod p */
 static inline decaf_word_t lobit(gf x) {
@@ -1429,14 +1940,12 @@ decaf_bool_t API_NS(direct_scalarmul) (
     /* Compute denominator = x0 xa za xd zd */
     gf_mul(L0, x0, xz_a);
     gf_mul(L1, L0, xz_d);
-    gf_isqrt(den, L1);
 
-    /* Check that the square root came out OK. */
-    gf_sqr(L2, den);
-    gf_mul(L3, L0, L2); /* x0 xa za den^2 = 1/xz_d, for later */
-    gf_mul(L0, L1, L2);
-    gf_add(L0, L0, ONE);
-    succ &= ~hibit(s0) & ~gf_eq(L0, ZERO);
+    /* Its inverse square root, checking that it's square (or zero), and
+     * its inverse from the same exponentiation.
+     */
+    succ &= ~hibit(s0) & gf_isqrt_inv_chk(den, L2, L1, DECAF_TRUE);
+    gf_mul(L3, L0, L2); /* x0 xa za / (x0 xa za xd zd) = 1/xz_d, for later */
 
     /* Compute y/x for input and output point. */
     gf_mul(L1, x0, xd);
@@ -1668,6 +2177,305 @@ void API_NS(base_double_scalarmul_non_secret) (
     assert(contp == ncb_pre); (void)ncb_pre;
 }
 
+/* Precomputed wNAF table for a variable base */
+struct precomputed_wnaf_s { niels_t table[1<<DECAF_WNAF_FIXED_TABLE_BITS]; };
+
+const size_t API_NS2(sizeof,precomputed_wnaf_s) = sizeof(precomputed_wnaf_s);
+const size_t API_NS2(alignof,precomputed_wnaf_s) = 32;
+
+void API_NS(precompute_wnaf) (
+    precomputed_wnaf_s *a,
+    const point_t b
+) {
+    API_NS(precompute_wnafs)(a->table, b);
+}
+
+void API_NS(base_double_scalarmul_wnaf_non_secret) (
+    point_t combo,
+    const scalar_t scalar1,
+    const precomputed_wnaf_s *base2,
+    const scalar_t scalar2
+) {
+    const int table_bits = DECAF_WNAF_FIXED_TABLE_BITS;
+    struct smvt_control control_var[SCALAR_BITS/(table_bits+1)+3];
+    struct smvt_control control_pre[SCALAR_BITS/(table_bits+1)+3];
+    const niels_t *table_var = base2->table;
+    
+    int ncb_pre = recode_wnaf(control_pre, scalar1, table_bits);
+    int ncb_var = recode_wnaf(control_var, scalar2, table_bits);
+  
+    int contp=0, contv=0, i = control_var[0].power;
+
+    if (i < 0 && control_pre[0].power < 0) {
+        API_NS(point_copy)(combo, API_NS(point_identity));
+        return;
+    } else if (i > control_pre[0].power) {
+        niels_to_pt(combo, table_var[control_var[0].addend >> 1]);
+        contv++;
+    } else if (i == control_pre[0].power) {
+        niels_to_pt(combo, table_var[control_var[0].addend >> 1]);
+        add_niels_to_pt(combo, API_NS(wnaf_base)[control_pre[0].addend >> 1], i);
+        contv++; contp++;
+    } else {
+        i = control_pre[0].power;
+        niels_to_pt(combo, API_NS(wnaf_base)[control_pre[0].addend >> 1]);
+        contp++;
+    }
+    
+    for (i--; i >= 0; i--) {
+        int cv = (i==control_var[contv].power), cp = (i==control_pre[contp].power);
+        point_double_internal(combo,combo,i && !(cv||cp));
+
+        if (cv) {
+            assert(control_var[contv].addend);
+
+            if (control_var[contv].addend > 0) {
+                add_niels_to_pt(combo, table_var[control_var[contv].addend >> 1], i&&!cp);
+            } else {
+                sub_niels_from_pt(combo, table_var[(-control_var[contv].addend) >> 1], i&&!cp);
+            }
+            contv++;
+        }
+
+        if (cp) {
+            assert(control_pre[contp].addend);
+
+            if (control_pre[contp].addend > 0) {
+                add_niels_to_pt(combo, API_NS(wnaf_base)[control_pre[contp].addend >> 1], i);
+            } else {
+                sub_niels_from_pt(combo, API_NS(wnaf_base)[(-control_pre[contp].addend) >> 1], i);
+            }
+            contp++;
+        }
+    }
+
+    assert(contv == ncb_var); (void)ncb_var;
+    assert(contp == ncb_pre); (void)ncb_pre;
+}
+
+void API_NS(point_scalarmul_non_secret) (
+    point_t out,
+    const point_t base,
+    const scalar_t scalar
+) {
+    const int table_bits = DECAF_WNAF_SCALARMUL_TABLE_BITS;
+    struct smvt_control control[SCALAR_BITS/(DECAF_WNAF_SCALARMUL_TABLE_BITS+1)+3];
+    pniels_t precmp[1<<DECAF_WNAF_SCALARMUL_TABLE_BITS];
+    
+    int ncb = recode_wnaf(control, scalar, table_bits);
+    int cont = 0, i = control[0].power;
+    
+    if (i < 0) {
+        API_NS(point_copy)(out, API_NS(point_identity));
+        return;
+    }
+    
+    /* The table is built before out is written, so they may alias */
+    prepare_wnaf_table(precmp, base, table_bits);
+    pniels_to_pt(out, precmp[control[0].addend >> 1]);
+    cont++;
+    
+    for (i--; i >= 0; i--) {
+        int c = (i==control[cont].power);
+        point_double_internal(out,out,i && !c);
+
+        if (c) {
+            assert(control[cont].addend);
+
+            if (control[cont].addend > 0) {
+                add_pniels_to_pt(out, precmp[control[cont].addend >> 1], i);
+            } else {
+                sub_pniels_from_pt(out, precmp[(-control[cont].addend) >> 1], i);
+            }
+            cont++;
+        }
+    }
+    
+    assert(cont == ncb); (void)ncb;
+}
+
+/**
+ * Straus' method over at most DECAF_MULTISCALAR_STRAUS_POINTS points:
+ * one wNAF table per point, batch-normalized to niels together, and one
+ * shared chain of doublings.
+ */
+static void multiscalarmul_straus (
+    point_t out,
+    const point_t *bases,
+    const scalar_t *scalars,
+    unsigned int n
+) {
+    const int table_bits = DECAF_WNAF_VAR_TABLE_BITS;
+    struct smvt_control control[DECAF_MULTISCALAR_STRAUS_POINTS]
+        [SCALAR_BITS/(DECAF_WNAF_VAR_TABLE_BITS+1)+3];
+    niels_t table[DECAF_MULTISCALAR_STRAUS_POINTS<<DECAF_WNAF_VAR_TABLE_BITS];
+    gf zs[DECAF_MULTISCALAR_STRAUS_POINTS<<DECAF_WNAF_VAR_TABLE_BITS],
+        zis[DECAF_MULTISCALAR_STRAUS_POINTS<<DECAF_WNAF_VAR_TABLE_BITS];
+    pniels_t tmp[1<<DECAF_WNAF_VAR_TABLE_BITS];
+    int cont[DECAF_MULTISCALAR_STRAUS_POINTS];
+    int i, top = -1;
+    unsigned int j, k;
+
+    assert(n <= DECAF_MULTISCALAR_STRAUS_POINTS);
+
+    for (j=0; j<n; j++) {
+        recode_wnaf(control[j], scalars[j], table_bits);
+        prepare_wnaf_table(tmp, bases[j], table_bits);
+        for (k=0; k<1u<<table_bits; k++) {
+            memcpy(table[(j<<table_bits)+k], tmp[k]->n, sizeof(niels_t));
+            gf_cpy(zs[(j<<table_bits)+k], tmp[k]->z);
+        }
+        if (control[j][0].power > top) top = control[j][0].power;
+        cont[j] = 0;
+    }
+
+    API_NS(point_copy)(out, API_NS(point_identity));
+    if (top < 0) return;
+    batch_normalize_niels(table, zs, zis, n<<table_bits);
+
+    for (i=top; i>=0; i--) {
+        int nadd = 0;
+        for (j=0; j<n; j++) nadd += (control[j][cont[j]].power == i);
+
+        /* t is only needed when an add follows, or on the way out. */
+        if (i != top) point_double_internal(out, out, i && !nadd);
+
+        for (j=0; j<n; j++) {
+            if (control[j][cont[j]].power != i) continue;
+            int addend = control[j][cont[j]].addend;
+            assert(addend);
+            nadd--;
+
+            if (addend > 0) {
+                add_niels_to_pt(out, table[(j<<table_bits) + (addend>>1)], i && !nadd);
+            } else {
+                sub_niels_from_pt(out, table[(j<<table_bits) + ((-addend)>>1)], i && !nadd);
+            }
+            cont[j]++;
+        }
+    }
+}
+
+/* Signed (Booth) digit of scalar at bits [pos,pos+c), in [-2^(c-1), 2^(c-1)] */
+static int booth_digit (
+    const scalar_t scalar,
+    int pos,
+    unsigned int c
+) {
+    unsigned int i, raw = 0;
+    for (i=0; i<=c; i++) {
+        int b = pos+(int)i-1;
+        if (b < 0 || b >= SCALAR_LIMBS*WBITS) continue;
+        raw |= ((scalar->limb[b/WBITS] >> (b%WBITS)) & 1) << i;
+    }
+    /* raw = window bits, shifted up by one, plus the borrow from below */
+    return (int)((raw>>1) + (raw&1)) - (int)((raw>>c)<<c);
+}
+
+static void multiscalarmul_pippenger (
+    point_t out,
+    const point_t *bases,
+    const scalar_t *scalars,
+    size_t n
+) {
+    point_t buckets[1<<(DECAF_MULTISCALAR_PIPPENGER_MAX_BITS-1)], run, sum;
+    unsigned char used[1<<(DECAF_MULTISCALAR_PIPPENGER_MAX_BITS-1)];
+    unsigned int c, k, best_c = 2, nbuckets;
+    double cost, best_cost = -1;
+    int w, nwin, have_run, have_sum;
+    size_t j;
+
+    /* Each window costs about one add per point plus two per bucket. */
+    for (c=2; c<=DECAF_MULTISCALAR_PIPPENGER_MAX_BITS; c++) {
+        cost = (double)(SCALAR_BITS/c+1) * ((double)n + (double)(1u<<c));
+        if (best_cost < 0 || cost < best_cost) { best_cost = cost; best_c = c; }
+    }
+    c = best_c;
+    nbuckets = 1u<<(c-1);
+    nwin = SCALAR_BITS/c+1;
+
+    API_NS(point_copy)(out, API_NS(point_identity));
+    for (w=nwin-1; w>=0; w--) {
+        if (w != nwin-1) {
+            for (k=0; k<c; k++) point_double_internal(out, out, k<c-1);
+        }
+
+        memset(used, 0, nbuckets);
+        for (j=0; j<n; j++) {
+            int d = booth_digit(scalars[j], w*c, c);
+            if (d == 0) continue;
+            k = (d > 0 ? d : -d) - 1;
+            if (!used[k]) {
+                if (d > 0) API_NS(point_copy)(buckets[k], bases[j]);
+                else API_NS(point_negate)(buckets[k], bases[j]);
+                used[k] = 1;
+            } else if (d > 0) {
+                API_NS(point_add)(buckets[k], buckets[k], bases[j]);
+            } else {
+                API_NS(point_sub)(buckets[k], buckets[k], bases[j]);
+            }
+        }
+
+        /* sum = sum_k (k+1)*buckets[k], by running sums from the top */
+        have_run = have_sum = 0;
+        for (k=nbuckets; k-->0; ) {
+            if (used[k]) {
+                if (have_run) API_NS(point_add)(run, run, buckets[k]);
+                else API_NS(point_copy)(run, buckets[k]);
+                have_run = 1;
+            }
+            if (have_run) {
+                if (have_sum) API_NS(point_add)(sum, sum, run);
+                else API_NS(point_copy)(sum, run);
+                have_sum = 1;
+            }
+        }
+        if (have_sum) API_NS(point_add)(out, out, sum);
+    }
+}
+
+void API_NS(multiscalarmul_non_secret) (
+    point_t combo,
+    const point_t *bases,
+    const scalar_t *scalars,
+    size_t n
+) {
+    point_t acc, tmp;
+    size_t i;
+
+    if (n >= DECAF_MULTISCALAR_PIPPENGER_THRESHOLD) {
+        multiscalarmul_pippenger(acc, bases, scalars, n);
+        API_NS(point_copy)(combo, acc);
+        return;
+    }
+
+    API_NS(point_copy)(acc, API_NS(point_identity));
+    for (i=0; i<n; i+=DECAF_MULTISCALAR_STRAUS_POINTS) {
+        unsigned int m = (n-i < DECAF_MULTISCALAR_STRAUS_POINTS)
+            ? n-i : DECAF_MULTISCALAR_STRAUS_POINTS;
+        multiscalarmul_straus(tmp, &bases[i], &scalars[i], m);
+        API_NS(point_add)(acc, acc, tmp);
+    }
+    API_NS(point_copy)(combo, acc);
+}
+
+void API_NS(point_double_scalarmul_non_secret) (
+    point_t combo,
+    const point_t base1,
+    const scalar_t scalar1,
+    const point_t base2,
+    const scalar_t scalar2
+) {
+    /* Interleaved wNAF, with both tables normalized in one batch */
+    point_t bases[2];
+    scalar_t scalars[2];
+    API_NS(point_copy)(bases[0], base1);
+    API_NS(point_copy)(bases[1], base2);
+    API_NS(scalar_copy)(scalars[0], scalar1);
+    API_NS(scalar_copy)(scalars[1], scalar2);
+    multiscalarmul_straus(combo, (const point_t *)bases, (const scalar_t *)scalars, 2);
+}
+
 void API_NS(point_destroy) (
   point_t point
 ) {
@@ -1688,8 +2496,24 @@ decaf_bool_t decaf_memeq (
     return (((decaf_dword_t)ret) - 1) >> 8;
 }
 
+const char *API_NS(field_backend) (void) {
+    return field_backend_name();
+}
+
 void API_NS(precomputed_destroy) (
   precomputed_s *pre
 ) {
     decaf_bzero(pre, API_NS2(sizeof,precomputed_s));
 }
+
+void API_NS(precomputed_comb_destroy) (
+  precomputed_comb_s *pre
+) {
+    decaf_bzero(pre, API_NS(sizeof_precomputed_comb)(pre->n, pre->t, pre->s));
+}
+
+void API_NS(precomputed_wnaf_destroy) (
+  precomputed_wnaf_s *pre
+) {
+    decaf_bzero(pre, API_NS2(sizeof,precomputed_wnaf_s));
+}
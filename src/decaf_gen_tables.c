@@ -11,20 +11,19 @@
 #define _XOPEN_SOURCE 600 /* for posix_memalign */
 #include <stdio.h>
 #include <stdlib.h>
-#include "decaf.h"
-#include "decaf_448_config.h" /* MAGIC */
 #include "field.h"
-
-#define API_NS(_id) decaf_448_##_id
-#define API_NS2(_pref,_id) _pref##_decaf_448_##_id
+#include "decaf_curve.h"
 
  /* To satisfy linker. */
 const field_t API_NS(precomputed_base_as_fe)[1];
+const field_t API_NS(precomputed_base_combs_as_fe)[1];
+const API_NS(scalar_t) API_NS(precomputed_base_comb_adjustments)[1];
 const API_NS(scalar_t) API_NS(precomputed_scalarmul_adjustment);
 const API_NS(scalar_t) API_NS(point_scalarmul_adjustment);
+const API_NS(scalar_t) API_NS(point_double_scalarmul_adjustment);
 const API_NS(scalar_t) sc_r2 = {{{0}}};
 const decaf_word_t MONTGOMERY_FACTOR = 0;
-const unsigned char base_point_ser_for_pregen[DECAF_448_SER_BYTES];
+const unsigned char base_point_ser_for_pregen[SER_BYTES];
 
 const API_NS(point_t) API_NS(point_base);
 
@@ -37,15 +36,46 @@ void API_NS(precompute_wnafs) (
     const API_NS(point_t) base
 );
 
+void API_NS(precompute_comb_table) (
+    struct niels_s *out,
+    unsigned int n,
+    unsigned int t,
+    unsigned int s,
+    const API_NS(point_t) base
+);
+
+static const unsigned int extra_base_combs[][3] = { DECAF_EXTRA_BASE_COMBS };
+
 /* TODO: use SC_LIMB? */
-static void scalar_print(const char *name, const API_NS(scalar_t) sc) {
-    printf("const API_NS(scalar_t) %s = {{{\n", name);
+static void scalar_print_limbs(const API_NS(scalar_t) sc) {
+    printf("{{{");
     unsigned i;
     for (i=0; i<sizeof(API_NS(scalar_t))/sizeof(decaf_word_t); i++) {
         if (i) printf(", ");
         printf("0x%0*llxull", (int)sizeof(decaf_word_t)*2, (unsigned long long)sc->limb[i] );
     }
-    printf("}}};\n\n");
+    printf("}}}");
+}
+
+static void scalar_print(const char *name, const API_NS(scalar_t) sc) {
+    printf("const API_NS(scalar_t) %s = ", name);
+    scalar_print_limbs(sc);
+    printf(";\n\n");
+}
+
+/* 2^bits - 1, the adjustment for signed combs covering that many bits */
+static void comb_adjustment(API_NS(scalar_t) smadj, unsigned int bits) {
+    unsigned int i;
+    API_NS(scalar_copy)(smadj,API_NS(scalar_one));
+    for (i=0; i<bits; i++) {
+        API_NS(scalar_add)(smadj,smadj,smadj);
+    }
+    API_NS(scalar_sub)(smadj, smadj, API_NS(scalar_one));
+}
+
+/* 2^bits - 1, for fixed windows covering SCALAR_BITS-1 bits rounded up to the window */
+static void window_adjustment(API_NS(scalar_t) smadj, unsigned int window) {
+    comb_adjustment(smadj, SCALAR_BITS-1 + window - ((SCALAR_BITS-1)%window));
 }
 
 static void field_print(const field_t *f) {
@@ -71,10 +101,42 @@ static void field_print(const field_t *f) {
     assert(b<8);
 }
 
+/* Print a comb table, in the layout of decaf_fast.c's tniels_s */
+static void comb_table_print(const char *name, const void *table, size_t size, int align) {
+#ifdef FIELD_PACKED_LIMBS
+    /* Packed without the padding limbs, and already canonical */
+    const field_packed_t *output = (const field_packed_t *)table;
+    size_t i;
+    unsigned int j;
+    printf("const field_packed_t API_NS(%s)[%d]\n", name, (int)(size / sizeof(field_packed_t)));
+    printf("__attribute__((aligned(%d),visibility(\"hidden\"))) = {\n  ", align);
+    for (i=0; i < size; i+=sizeof(field_packed_t), output++) {
+        if (i) printf(",\n  ");
+        printf("{{");
+        for (j=0; j<FIELD_PACKED_LIMBS; j++) {
+            if (j) printf(",");
+            printf("0x%016llx", (unsigned long long)output->limb[j]);
+        }
+        printf("}}");
+    }
+#else
+    const field_t *output = (const field_t *)table;
+    size_t i;
+    printf("const field_t API_NS(%s)[%d]\n", name, (int)(size / sizeof(field_t)));
+    printf("__attribute__((aligned(%d),visibility(\"hidden\"))) = {\n  ", align);
+    for (i=0; i < size; i+=sizeof(field_t)) {
+        if (i) printf(",\n  ");
+        field_print(output++);
+    }
+#endif
+    printf("\n};\n");
+}
+
 int main(int argc, char **argv) {
     (void)argc; (void)argv;
     
     API_NS(point_t) real_point_base;
+    unsigned i;
     int ret = API_NS(point_decode)(real_point_base,base_point_ser_for_pregen,0);
     if (!ret) return 1;
     
@@ -88,14 +150,30 @@ int main(int argc, char **argv) {
     if (ret || !preWnaf) return 1;
     API_NS(precompute_wnafs)(preWnaf, real_point_base);
 
+    const unsigned int n_extra = sizeof(extra_base_combs)/sizeof(extra_base_combs[0]);
+    const size_t niels_size = API_NS2(sizeof,precomputed_s) / (DECAF_COMBS_N<<(DECAF_COMBS_T-1));
+    size_t extra_size = 0;
+    for (i=0; i<n_extra; i++) {
+        const unsigned int *c = extra_base_combs[i];
+        if (!API_NS(sizeof_precomputed_comb)(c[0],c[1],c[2])) return 1;
+        extra_size += (size_t)(c[0] << (c[1]-1)) * niels_size;
+    }
+    
+    unsigned char *preExtra;
+    ret = posix_memalign((void**)&preExtra, API_NS2(alignof,precomputed_s), extra_size);
+    if (ret || !preExtra) return 1;
+    for (i=0, extra_size=0; i<n_extra; i++) {
+        const unsigned int *c = extra_base_combs[i];
+        API_NS(precompute_comb_table)((struct niels_s *)&preExtra[extra_size],
+            c[0], c[1], c[2], real_point_base);
+        extra_size += (size_t)(c[0] << (c[1]-1)) * niels_size;
+    }
+
     const field_t *output;
-    unsigned i;
     
     printf("/** @warning: this file was automatically generated. */\n");
     printf("#include \"field.h\"\n\n");
-    printf("#include \"decaf.h\"\n\n");
-    printf("#define API_NS(_id) decaf_448_##_id\n");
-    printf("#define API_NS2(_pref,_id) _pref##_decaf_448_##_id\n");
+    printf("#include \"decaf_curve.h\"\n\n");
     
     output = (const field_t *)real_point_base;
     printf("const API_NS(point_t) API_NS(point_base) = {{\n");
@@ -107,16 +185,8 @@ int main(int argc, char **argv) {
     }
     printf("\n}};\n");
     
-    output = (const field_t *)pre;
-    printf("const field_t API_NS(precomputed_base_as_fe)[%d]\n", 
-        (int)(API_NS2(sizeof,precomputed_s) / sizeof(field_t)));
-    printf("__attribute__((aligned(%d),visibility(\"hidden\"))) = {\n  ", (int)API_NS2(alignof,precomputed_s));
-    
-    for (i=0; i < API_NS2(sizeof,precomputed_s); i+=sizeof(field_t)) {
-        if (i) printf(",\n  ");
-        field_print(output++);
-    }
-    printf("\n};\n");
+    comb_table_print("precomputed_base_as_fe", pre, API_NS2(sizeof,precomputed_s),
+        (int)API_NS2(alignof,precomputed_s));
     
     output = (const field_t *)preWnaf;
     printf("const field_t API_NS(precomputed_wnaf_as_fe)[%d]\n", 
@@ -128,23 +198,30 @@ int main(int argc, char **argv) {
     }
     printf("\n};\n");
     
+    comb_table_print("precomputed_base_combs_as_fe", preExtra, extra_size,
+        (int)API_NS2(alignof,precomputed_s));
+    
     API_NS(scalar_t) smadj;
-    API_NS(scalar_copy)(smadj,API_NS(scalar_one));
-
-    for (i=0; i<DECAF_COMBS_N*DECAF_COMBS_T*DECAF_COMBS_S; i++) {
-        API_NS(scalar_add)(smadj,smadj,smadj);
+    printf("const API_NS(scalar_t) API_NS(precomputed_base_comb_adjustments)[%d] = {\n", n_extra);
+    for (i=0; i<n_extra; i++) {
+        const unsigned int *c = extra_base_combs[i];
+        comb_adjustment(smadj, c[0]*c[1]*c[2]);
+        printf("  ");
+        scalar_print_limbs(smadj);
+        printf(i<n_extra-1 ? ",\n" : "\n};\n\n");
     }
-    API_NS(scalar_sub)(smadj, smadj, API_NS(scalar_one));
+    
+    comb_adjustment(smadj, DECAF_COMBS_N*DECAF_COMBS_T*DECAF_COMBS_S);
     scalar_print("API_NS(precomputed_scalarmul_adjustment)", smadj);
     
-    API_NS(scalar_copy)(smadj,API_NS(scalar_one));
-    for (i=0; i<DECAF_448_SCALAR_BITS-1 + DECAF_WINDOW_BITS
-            - ((DECAF_448_SCALAR_BITS-1)%DECAF_WINDOW_BITS); i++) {
-        API_NS(scalar_add)(smadj,smadj,smadj);
-    }
-    API_NS(scalar_sub)(smadj, smadj, API_NS(scalar_one));
+    window_adjustment(smadj, DECAF_WINDOW_BITS);
     scalar_print("API_NS(point_scalarmul_adjustment)", smadj);
     
+#if DECAF_JOINT_WINDOW_BITS
+    window_adjustment(smadj, DECAF_JOINT_WINDOW_BITS);
+    scalar_print("API_NS(point_double_scalarmul_adjustment)", smadj);
+#endif
+    
     API_NS(scalar_copy)(smadj,API_NS(scalar_one));
     for (i=0; i<sizeof(API_NS(scalar_t))*8*2; i++) {
         API_NS(scalar_add)(smadj,smadj,smadj);
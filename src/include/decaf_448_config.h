@@ -31,9 +31,38 @@
 /** The comb spacing fixed base scalarmul. */
 #define DECAF_COMBS_S 18
 
+/** The largest number of teeth per comb in runtime-configured comb tables. */
+#define DECAF_COMBS_MAX_T 8
+
+/**
+ * Extra comb tables for the base point to build into the library, as a
+ * list of {n,t,s} triples.  See decaf_448_precomputed_base_comb_scalarmul.
+ * The defaults are a 7kB table for small caches and a 37kB one for servers;
+ * run "bench --combs" to compare shapes.
+ */
+#define DECAF_EXTRA_BASE_COMBS {2,5,45}, {6,6,13}
+
 /** Performance tuning: the width of the fixed window for scalar mul. */
 #define DECAF_WINDOW_BITS 5
 
+/**
+ * Performance tuning: the cost of a field inversion, in multiplications.
+ * Fixed-window scalarmul batch-normalizes its table to niels when the adds
+ * and lookups that saves are worth more than this.  Define
+ * DECAF_WINDOW_NIELS to 0 or 1 to override the choice.
+ */
+#define DECAF_INVERT_MULS 150
+
+/**
+ * Performance tuning: if nonzero, constant-time double scalarmul uses one
+ * joint table of the 2^(2*bits-1) combinations of odd multiples of both
+ * points, batch-normalized to niels, with one lookup and one add per
+ * window of this many bits.  If zero, it uses a table per point and two
+ * adds per DECAF_WINDOW_BITS window.  The mode is fixed at compile time, so
+ * the benchmarks time only the one that is built.
+ */
+#define DECAF_JOINT_WINDOW_BITS 3
+
 /**
  * The number of bits used for the precomputed table in variable-time
  * double scalarmul.
@@ -46,5 +75,31 @@
  */
 #define DECAF_WNAF_VAR_TABLE_BITS 3
 
+/**
+ * Performance tuning: bits used for the table in variable-time single
+ * scalarmul.  The table has 2^bits odd multiples of the point, and the
+ * recoding adds about SCALAR_BITS/(bits+2) of them.
+ */
+#define DECAF_WNAF_SCALARMUL_TABLE_BITS 4
+
+/**
+ * Performance tuning: the number of points whose wNAF tables are built
+ * (on the stack) and walked together in variable-time multi-scalar
+ * multiplication.  Larger groups share more doublings.
+ */
+#define DECAF_MULTISCALAR_STRAUS_POINTS 16
+
+/**
+ * Performance tuning: variable-time multi-scalar multiplication switches
+ * from Straus to Pippenger's bucket method at this many points.
+ */
+#define DECAF_MULTISCALAR_PIPPENGER_THRESHOLD 64
+
+/**
+ * Performance tuning: the largest Pippenger window.  The buckets, two
+ * to the (bits-1) points, live on the stack.
+ */
+#define DECAF_MULTISCALAR_PIPPENGER_MAX_BITS 8
+
 
 #endif /* __DECAF_448_CONFIG_H__ */
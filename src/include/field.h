@@ -41,11 +41,10 @@ field_isr (
 /**
  * Returns 1/x.
  * 
- * If x=0, returns 0.
+ * If x=0, returns 0.  Constant-time.
  *
- * TODO: this is currently unused in Decaf, but I've left a decl
- * for it because field_inverse is different (and simpler) than
- * field_isqrt for 5-mod-8 fields.
+ * On 64-bit platforms this uses safegcd (modinv.h), which is several
+ * times faster than an exponentiation.
  */
 void
 field_inverse (
@@ -54,7 +53,16 @@ field_inverse (
 );
     
 /**
- * Square x, n times.
+ * The name of the field backend, eg "arch_x86_64".  With runtime dispatch,
+ * this is the backend that was picked for this CPU.
+ */
+const char *
+field_backend_name (void);
+
+#ifndef field_sqrn
+/**
+ * Square x, n times.  Backends which can keep the value in registers
+ * across the squarings define field_sqrn themselves.
  */
 static __inline__ void
 __attribute__((unused,always_inline))
@@ -78,6 +86,7 @@ field_sqrn (
         field_sqr(y,tmp);
     }
 }
+#endif
 
 static __inline__ void
 field_subx_RAW (
@@ -111,6 +120,62 @@ field_add (
     field_weak_reduce ( d );
 }
 
+#ifdef field_mul_add
+/**
+ * out = a*b - c*d, as a*b + c*(-d) with one reduction.  d must be weakly
+ * reduced, so that 2p-d doesn't underflow.
+ */
+static __inline__ void
+__attribute__((unused,always_inline))
+field_mul_sub (
+    field_a_restrict_t out,
+    const field_a_t a,
+    const field_a_t b,
+    const field_a_t c,
+    const field_a_t d
+) {
+    field_a_t nd;
+    memset(nd, 0, sizeof(nd));
+    field_subx_RAW(nd, nd, d);
+    field_mul_add(out, a, b, c, nd);
+}
+#else
+/**
+ * out = a*b + c*d.  Backends which can do it with one reduction define
+ * field_mul_add themselves.
+ */
+static __inline__ void
+__attribute__((unused,always_inline))
+field_mul_add (
+    field_a_restrict_t out,
+    const field_a_t a,
+    const field_a_t b,
+    const field_a_t c,
+    const field_a_t d
+) {
+    field_a_t tmp;
+    field_mul(out, a, b);
+    field_mul(tmp, c, d);
+    field_add(out, out, tmp);
+}
+
+/** out = a*b - c*d. */
+static __inline__ void
+__attribute__((unused,always_inline))
+field_mul_sub (
+    field_a_restrict_t out,
+    const field_a_t a,
+    const field_a_t b,
+    const field_a_t c,
+    const field_a_t d
+) {
+    field_a_t tmp;
+    field_mul(out, a, b);
+    field_mul(tmp, c, d);
+    field_sub(out, out, tmp);
+}
+#endif
+
 /** Require the warning annotation on raw routines */
 #define ANALYZE_THIS_ROUTINE_CAREFULLY const int ANNOTATE___ANALYZE_THIS_ROUTINE_CAREFULLY = 0;
 #define MUST_BE_CAREFUL (void) ANNOTATE___ANALYZE_THIS_ROUTINE_CAREFULLY
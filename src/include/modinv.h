@@ -0,0 +1,73 @@
+/**
+ * @file modinv.h
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Constant-time modular inversion by safegcd (Bernstein-Yang divsteps).
+ *
+ * Numbers are held in signed radix 2^62: limbs 0..N-2 are in [0,2^62) and
+ * the top limb is signed.  This needs a 64x64->128-bit multiply, so it is
+ * only built when WORD_BITS == 64; 32-bit targets keep the exponentiation
+ * chains.
+ */
+
+#ifndef __MODINV_H__
+#define __MODINV_H__ 1
+
+#include "word.h"
+
+#if WORD_BITS == 64
+#define MODINV62 1
+
+/**
+ * Enough limbs for an odd modulus of up to 480 bits.  Bigger fields set it
+ * in their arch_config.h; 9 limbs cover p521.
+ */
+#ifndef MODINV62_LIMBS
+#define MODINV62_LIMBS 8
+#endif
+
+/** A number in signed radix 2^62. */
+typedef struct { int64_t v[MODINV62_LIMBS]; } modinv62_t;
+
+/** An odd modulus and its precomputed data. */
+typedef struct {
+    modinv62_t p;            /**< The modulus, with every limb in [0,2^62) */
+    uint64_t p_inv62;        /**< p^-1 mod 2^62 */
+    unsigned int batches;    /**< Batches of 62 divsteps; see MODINV62_BATCHES */
+} modinv62_modulus_t;
+
+/**
+ * Batches of 62 divsteps needed for a modulus of the given bit length
+ * (at least 46), using the bound (49d+57)/17 from Bernstein and Yang,
+ * "Fast constant-time gcd computation and modular inversion", Thm 11.2.
+ */
+#define MODINV62_BATCHES(bits) (((49*(bits)+57+16)/17 + 61) / 62)
+
+/**
+ * x = x^-1 mod p, in constant time.  x must be in [0,p); the result is in
+ * [0,p), and 0 maps to 0.
+ */
+void modinv62 (
+    modinv62_t *x,
+    const modinv62_modulus_t *p
+);
+
+/** Read a little-endian number of at most 62*MODINV62_LIMBS - 1 bits. */
+void modinv62_from_bytes (
+    modinv62_t *x,
+    const uint8_t *in,
+    unsigned int nbytes
+);
+
+/** Write x, which must be nonnegative, as nbytes little-endian bytes. */
+void modinv62_to_bytes (
+    uint8_t *out,
+    unsigned int nbytes,
+    const modinv62_t *x
+);
+
+#endif /* WORD_BITS == 64 */
+
+#endif /* __MODINV_H__ */
@@ -0,0 +1,226 @@
+/**
+ * @cond internal
+ * @file modinv.c
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Constant-time modular inversion by safegcd.
+ *
+ * This follows Bernstein and Yang's divstep algorithm, in the form used by
+ * libsecp256k1's modinv64: batches of 62 divsteps are run on the low words
+ * of f and g, and the resulting 2x2 transition matrix is applied to the
+ * full-size f, g and to the Bezout coefficients d, e, with d and e kept in
+ * (-2p,p) by adding a multiple of p that clears their low 62 bits.
+ *
+ * Invariants: f = d*x and g = e*x mod p.  Once g reaches 0, f = +-1, so
+ * that d = +-1/x.
+ */
+
+#include "modinv.h"
+#include "decaf_common.h"
+
+#if MODINV62
+
+#define N MODINV62_LIMBS
+#define M62 (UINT64_MAX >> 2)
+
+/** The transition matrix of 62 divsteps, scaled by 2^62. */
+typedef struct { int64_t u, v, q, r; } trans_t;
+
+/**
+ * Run 62 divsteps on the low 64 bits of f and g, starting from
+ * eta = -delta.  Return the new eta.  Branch-free.
+ */
+static int64_t divsteps_62 (
+    int64_t eta,
+    uint64_t f,
+    uint64_t g,
+    trans_t *t
+) {
+    uint64_t u = 1, v = 0, q = 0, r = 1, c1, c2, x, y, z;
+    int i;
+    for (i=0; i<62; i++) {
+        c1 = eta >> 63;   /* delta > 0 */
+        c2 = -(g & 1);    /* g odd */
+        x = (f ^ c1) - c1;
+        y = (u ^ c1) - c1;
+        z = (v ^ c1) - c1;
+        g += x & c2;      /* g += (delta > 0) ? -f : f, if g is odd */
+        q += y & c2;
+        r += z & c2;
+        c1 &= c2;         /* swap: (f,g) = (g,g-f) */
+        eta = (eta ^ c1) - (c1 + 1);
+        f += g & c1;
+        u += q & c1;
+        v += r & c1;
+        g >>= 1;
+        u <<= 1;
+        v <<= 1;
+    }
+    t->u = (int64_t)u;
+    t->v = (int64_t)v;
+    t->q = (int64_t)q;
+    t->r = (int64_t)r;
+    return eta;
+}
+
+/** (f,g) = t*(f,g) / 2^62, which is exact. */
+static void update_fg (
+    modinv62_t *f,
+    modinv62_t *g,
+    const trans_t *t
+) {
+    const int64_t u = t->u, v = t->v, q = t->q, r = t->r;
+    __int128_t cf, cg;
+    int i;
+
+    cf = (__int128_t)u * f->v[0] + (__int128_t)v * g->v[0];
+    cg = (__int128_t)q * f->v[0] + (__int128_t)r * g->v[0];
+    cf >>= 62;
+    cg >>= 62;
+    for (i=1; i<N; i++) {
+        cf += (__int128_t)u * f->v[i] + (__int128_t)v * g->v[i];
+        cg += (__int128_t)q * f->v[i] + (__int128_t)r * g->v[i];
+        f->v[i-1] = (int64_t)cf & M62;
+        g->v[i-1] = (int64_t)cg & M62;
+        cf >>= 62;
+        cg >>= 62;
+    }
+    f->v[N-1] = (int64_t)cf;
+    g->v[N-1] = (int64_t)cg;
+}
+
+/**
+ * (d,e) = (t*(d,e) + p*(md,me)) / 2^62, choosing md and me to make the
+ * division exact and to keep d and e in (-2p,p).
+ */
+static void update_de (
+    modinv62_t *d,
+    modinv62_t *e,
+    const trans_t *t,
+    const modinv62_modulus_t *p
+) {
+    const int64_t u = t->u, v = t->v, q = t->q, r = t->r;
+    int64_t sd = d->v[N-1] >> 63, se = e->v[N-1] >> 63, md, me;
+    __int128_t cd, ce;
+    int i;
+
+    /* Start with p*(u,q) if d < 0, plus p*(v,r) if e < 0, to offset the negative inputs. */
+    md = (u & sd) + (v & se);
+    me = (q & sd) + (r & se);
+
+    cd = (__int128_t)u * d->v[0] + (__int128_t)v * e->v[0];
+    ce = (__int128_t)q * d->v[0] + (__int128_t)r * e->v[0];
+
+    /* Then adjust them so that the low 62 bits cancel. */
+    md -= (p->p_inv62 * (uint64_t)cd + md) & M62;
+    me -= (p->p_inv62 * (uint64_t)ce + me) & M62;
+
+    cd += (__int128_t)p->p.v[0] * md;
+    ce += (__int128_t)p->p.v[0] * me;
+    cd >>= 62;
+    ce >>= 62;
+    for (i=1; i<N; i++) {
+        cd += (__int128_t)u * d->v[i] + (__int128_t)v * e->v[i] + (__int128_t)p->p.v[i] * md;
+        ce += (__int128_t)q * d->v[i] + (__int128_t)r * e->v[i] + (__int128_t)p->p.v[i] * me;
+        d->v[i-1] = (int64_t)cd & M62;
+        e->v[i-1] = (int64_t)ce & M62;
+        cd >>= 62;
+        ce >>= 62;
+    }
+    d->v[N-1] = (int64_t)cd;
+    e->v[N-1] = (int64_t)ce;
+}
+
+/** Propagate signed carries so that limbs 0..N-2 are in [0,2^62). */
+static void carry_62 (
+    modinv62_t *x
+) {
+    int i;
+    for (i=0; i<N-1; i++) {
+        x->v[i+1] += x->v[i] >> 62;
+        x->v[i] &= M62;
+    }
+}
+
+/** Map d in (-2p,p) to sign*d mod p in [0,p), where sign = +-1. */
+static void normalize_62 (
+    modinv62_t *d,
+    int64_t sign,
+    const modinv62_modulus_t *p
+) {
+    int64_t mask = d->v[N-1] >> 63;
+    int i;
+
+    for (i=0; i<N; i++) d->v[i] += p->p.v[i] & mask; /* now in (-p,p) */
+    mask = sign >> 63;
+    for (i=0; i<N; i++) d->v[i] = (d->v[i] ^ mask) - mask;
+    carry_62(d);
+
+    mask = d->v[N-1] >> 63;
+    for (i=0; i<N; i++) d->v[i] += p->p.v[i] & mask; /* now in [0,p) */
+    carry_62(d);
+}
+
+void modinv62 (
+    modinv62_t *x,
+    const modinv62_modulus_t *p
+) {
+    modinv62_t d = {{0}}, e = {{1}}, f = p->p, g = *x;
+    int64_t eta = -1; /* delta = 1 */
+    trans_t t;
+    unsigned int i;
+
+    for (i=0; i<p->batches; i++) {
+        eta = divsteps_62(eta, f.v[0], g.v[0], &t);
+        update_de(&d, &e, &t, p);
+        update_fg(&f, &g, &t);
+    }
+
+    /* Now g = 0 and f = +-1, or f = p if x was 0, in which case d = 0. */
+    normalize_62(&d, f.v[N-1], p);
+    *x = d;
+
+    decaf_bzero(&e, sizeof(e));
+    decaf_bzero(&f, sizeof(f));
+    decaf_bzero(&t, sizeof(t));
+}
+
+void modinv62_from_bytes (
+    modinv62_t *x,
+    const uint8_t *in,
+    unsigned int nbytes
+) {
+    __uint128_t acc = 0;
+    unsigned int i, j = 0, bits = 0;
+    for (i=0; i<N; i++) {
+        while (bits < 62 && j < nbytes) {
+            acc |= (__uint128_t)in[j++] << bits;
+            bits += 8;
+        }
+        x->v[i] = (int64_t)(acc & M62);
+        acc >>= 62;
+        bits = (bits > 62) ? bits - 62 : 0;
+    }
+}
+
+void modinv62_to_bytes (
+    uint8_t *out,
+    unsigned int nbytes,
+    const modinv62_t *x
+) {
+    __uint128_t acc = 0;
+    unsigned int i = 0, j, bits = 0;
+    for (j=0; j<nbytes; j++) {
+        if (bits < 8 && i < N) {
+            acc |= (__uint128_t)(uint64_t)x->v[i++] << bits;
+            bits += 62;
+        }
+        out[j] = (uint8_t)acc;
+        acc >>= 8;
+        bits = (bits > 8) ? bits - 8 : 0;
+    }
+}
+
+#endif /* MODINV62 */
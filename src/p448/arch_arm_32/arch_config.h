@@ -1 +1,2 @@
 #define WORD_BITS 32
+#define ARCH_NAME "arch_arm_32"
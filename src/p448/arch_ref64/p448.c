@@ -16,25 +16,40 @@ static __inline__ uint64_t is_zero(uint64_t a) {
     return (((__uint128_t)a)-1)>>64;
 }
 
-void
-p448_mul (
-    p448_t *__restrict__ cs,
-    const p448_t *as,
-    const p448_t *bs
+/*
+ * c = the sum of n products a[k] * b[k], with one carry chain.  This is
+ * inlined with n constant, so the loops in the macros below unroll away.
+ */
+#define WIDEMUL(acc,x,i,y,j) do { \
+    int k_; \
+    acc = widemul(x[0][i], y[0][j]); \
+    for (k_=1; k_<n; k_++) acc += widemul(x[k_][i], y[k_][j]); \
+} while (0)
+#define MAC(acc,x,i,y,j) do { \
+    int k_; \
+    for (k_=0; k_<n; k_++) acc += widemul(x[k_][i], y[k_][j]); \
+} while (0)
+
+static __inline__ void __attribute__((always_inline))
+p448_mul_n (
+    uint64_t *__restrict__ c,
+    const uint64_t *const a[],
+    const uint64_t *const b[],
+    const int n
 ) {
-    const uint64_t *a = as->limb, *b = bs->limb;
-    uint64_t *c = cs->limb;
-
     __uint128_t accum0 = 0, accum1 = 0, accum2;
     uint64_t mask = (1ull<<56) - 1;  
 
-    uint64_t aa[4], bb[4], bbb[4];
+    uint64_t aa[2][4], bb[2][4], bbb[2][4];
 
     unsigned int i;
-    for (i=0; i<4; i++) {
-        aa[i]  = a[i] + a[i+4];
-        bb[i]  = b[i] + b[i+4];
-        bbb[i] = bb[i] + b[i+4];
+    int k;
+    for (k=0; k<n; k++) {
+        for (i=0; i<4; i++) {
+            aa[k][i]  = a[k][i] + a[k][i+4];
+            bb[k][i]  = b[k][i] + b[k][i+4];
+            bbb[k][i] = bb[k][i] + b[k][i+4];
+        }
     }
 
     int I_HATE_UNROLLED_LOOPS = 0;
@@ -48,14 +63,14 @@ p448_mul (
 
             unsigned int j;
             for (j=0; j<=i; j++) {
-                accum2 += widemul(a[j],   b[i-j]);
-                accum1 += widemul(aa[j], bb[i-j]);
-                accum0 += widemul(a[j+4], b[i-j+4]);
+                MAC(accum2, a,j, b,i-j);
+                MAC(accum1, aa,j, bb,i-j);
+                MAC(accum0, a,j+4, b,i-j+4);
             }
             for (; j<4; j++) {
-                accum2 += widemul(a[j],   b[i-j+8]);
-                accum1 += widemul(aa[j], bbb[i-j+4]);
-                accum0 += widemul(a[j+4], bb[i-j+4]);
+                MAC(accum2, a,j, b,i-j+8);
+                MAC(accum1, aa,j, bbb,i-j+4);
+                MAC(accum0, a,j+4, bb,i-j+4);
             }
 
             accum1 -= accum2;
@@ -68,21 +83,21 @@ p448_mul (
             accum1 >>= 56;
         }
     } else {
-        accum2  = widemul(a[0],  b[0]);
-        accum1 += widemul(aa[0], bb[0]);
-        accum0 += widemul(a[4],  b[4]);
+        WIDEMUL(accum2, a,0, b,0);
+        MAC(accum1, aa,0, bb,0);
+        MAC(accum0, a,4, b,4);
 
-        accum2 += widemul(a[1],  b[7]);
-        accum1 += widemul(aa[1], bbb[3]);
-        accum0 += widemul(a[5],  bb[3]);
+        MAC(accum2, a,1, b,7);
+        MAC(accum1, aa,1, bbb,3);
+        MAC(accum0, a,5, bb,3);
 
-        accum2 += widemul(a[2],  b[6]);
-        accum1 += widemul(aa[2], bbb[2]);
-        accum0 += widemul(a[6],  bb[2]);
+        MAC(accum2, a,2, b,6);
+        MAC(accum1, aa,2, bbb,2);
+        MAC(accum0, a,6, bb,2);
 
-        accum2 += widemul(a[3],  b[5]);
-        accum1 += widemul(aa[3], bbb[1]);
-        accum0 += widemul(a[7],  bb[1]);
+        MAC(accum2, a,3, b,5);
+        MAC(accum1, aa,3, bbb,1);
+        MAC(accum0, a,7, bb,1);
 
         accum1 -= accum2;
         accum0 += accum2;
@@ -93,21 +108,21 @@ p448_mul (
         accum0 >>= 56;
         accum1 >>= 56;
 
-        accum2  = widemul(a[0],  b[1]);
-        accum1 += widemul(aa[0], bb[1]);
-        accum0 += widemul(a[4],  b[5]);
+        WIDEMUL(accum2, a,0, b,1);
+        MAC(accum1, aa,0, bb,1);
+        MAC(accum0, a,4, b,5);
 
-        accum2 += widemul(a[1],  b[0]);
-        accum1 += widemul(aa[1], bb[0]);
-        accum0 += widemul(a[5],  b[4]);
+        MAC(accum2, a,1, b,0);
+        MAC(accum1, aa,1, bb,0);
+        MAC(accum0, a,5, b,4);
 
-        accum2 += widemul(a[2],  b[7]);
-        accum1 += widemul(aa[2], bbb[3]);
-        accum0 += widemul(a[6],  bb[3]);
+        MAC(accum2, a,2, b,7);
+        MAC(accum1, aa,2, bbb,3);
+        MAC(accum0, a,6, bb,3);
 
-        accum2 += widemul(a[3],  b[6]);
-        accum1 += widemul(aa[3], bbb[2]);
-        accum0 += widemul(a[7],  bb[2]);
+        MAC(accum2, a,3, b,6);
+        MAC(accum1, aa,3, bbb,2);
+        MAC(accum0, a,7, bb,2);
 
         accum1 -= accum2;
         accum0 += accum2;
@@ -118,21 +133,21 @@ p448_mul (
         accum0 >>= 56;
         accum1 >>= 56;
 
-        accum2  = widemul(a[0],  b[2]);
-        accum1 += widemul(aa[0], bb[2]);
-        accum0 += widemul(a[4],  b[6]);
+        WIDEMUL(accum2, a,0, b,2);
+        MAC(accum1, aa,0, bb,2);
+        MAC(accum0, a,4, b,6);
 
-        accum2 += widemul(a[1],  b[1]);
-        accum1 += widemul(aa[1], bb[1]);
-        accum0 += widemul(a[5],  b[5]);
+        MAC(accum2, a,1, b,1);
+        MAC(accum1, aa,1, bb,1);
+        MAC(accum0, a,5, b,5);
 
-        accum2 += widemul(a[2],  b[0]);
-        accum1 += widemul(aa[2], bb[0]);
-        accum0 += widemul(a[6],  b[4]);
+        MAC(accum2, a,2, b,0);
+        MAC(accum1, aa,2, bb,0);
+        MAC(accum0, a,6, b,4);
 
-        accum2 += widemul(a[3],  b[7]);
-        accum1 += widemul(aa[3], bbb[3]);
-        accum0 += widemul(a[7],  bb[3]);
+        MAC(accum2, a,3, b,7);
+        MAC(accum1, aa,3, bbb,3);
+        MAC(accum0, a,7, bb,3);
 
         accum1 -= accum2;
         accum0 += accum2;
@@ -143,21 +158,21 @@ p448_mul (
         accum0 >>= 56;
         accum1 >>= 56;
 
-        accum2  = widemul(a[0],  b[3]);
-        accum1 += widemul(aa[0], bb[3]);
-        accum0 += widemul(a[4],  b[7]);
+        WIDEMUL(accum2, a,0, b,3);
+        MAC(accum1, aa,0, bb,3);
+        MAC(accum0, a,4, b,7);
 
-        accum2 += widemul(a[1],  b[2]);
-        accum1 += widemul(aa[1], bb[2]);
-        accum0 += widemul(a[5],  b[6]);
+        MAC(accum2, a,1, b,2);
+        MAC(accum1, aa,1, bb,2);
+        MAC(accum0, a,5, b,6);
 
-        accum2 += widemul(a[2],  b[1]);
-        accum1 += widemul(aa[2], bb[1]);
-        accum0 += widemul(a[6],  b[5]);
+        MAC(accum2, a,2, b,1);
+        MAC(accum1, aa,2, bb,1);
+        MAC(accum0, a,6, b,5);
 
-        accum2 += widemul(a[3],  b[0]);
-        accum1 += widemul(aa[3], bb[0]);
-        accum0 += widemul(a[7],  b[4]);
+        MAC(accum2, a,3, b,0);
+        MAC(accum1, aa,3, bb,0);
+        MAC(accum0, a,7, b,4);
 
         accum1 -= accum2;
         accum0 += accum2;
@@ -182,6 +197,31 @@ p448_mul (
     c[1] += ((uint64_t)(accum1));
 }
 
+#undef WIDEMUL
+#undef MAC
+
+void
+p448_mul (
+    p448_t *__restrict__ cs,
+    const p448_t *as,
+    const p448_t *bs
+) {
+    const uint64_t *a[1] = { as->limb }, *b[1] = { bs->limb };
+    p448_mul_n(cs->limb, a, b, 1);
+}
+
+void
+p448_mul_add (
+    p448_t *__restrict__ cs,
+    const p448_t *as,
+    const p448_t *bs,
+    const p448_t *ds,
+    const p448_t *es
+) {
+    const uint64_t *a[2] = { as->limb, ds->limb }, *b[2] = { bs->limb, es->limb };
+    p448_mul_n(cs->limb, a, b, 2);
+}
+
 void
 p448_mulw (
     p448_t *__restrict__ cs,
@@ -211,14 +251,12 @@ p448_mulw (
     c[1] += accum4 >> 56;
 }
 
-void
-p448_sqr (
-    p448_t *__restrict__ cs,
-    const p448_t *as
+/* c = a^2.  Inlined into p448_sqr and p448_sqrn. */
+static __inline__ void __attribute__((always_inline))
+p448_sqr_inner (
+    uint64_t *__restrict__ c,
+    const uint64_t *a
 ) {
-    const uint64_t *a = as->limb;
-    uint64_t *c = cs->limb;
-
     __uint128_t accum0 = 0, accum1 = 0, accum2;
     uint64_t mask = (1ull<<56) - 1;  
 
@@ -326,6 +364,42 @@ p448_sqr (
     c[0] += ((uint64_t)(accum1));
 }
 
+void
+p448_sqr (
+    p448_t *__restrict__ cs,
+    const p448_t *as
+) {
+    p448_sqr_inner(cs->limb, as->limb);
+}
+
+#ifndef P448_BACKEND /* The dispatch build has no sqrn slot */
+void
+p448_sqrn (
+    p448_t *__restrict__ ys,
+    const p448_t *xs,
+    int n
+) {
+    /* Square locals with the kernel inlined, so that the limbs can stay in
+     * registers and the stores to *ys in between are dropped.  p448_sqr's
+     * output is a valid input, so no reduction is needed in between.
+     */
+    uint64_t x[8], y[8];
+    unsigned int i;
+    assert(n>0);
+
+    for (i=0; i<8; i++) x[i] = xs->limb[i];
+    for (; n>1; n-=2) {
+        p448_sqr_inner(y, x);
+        p448_sqr_inner(x, y);
+    }
+    if (n) {
+        p448_sqr_inner(ys->limb, x);
+    } else {
+        for (i=0; i<8; i++) ys->limb[i] = x[i];
+    }
+}
+#endif
+
 void
 p448_strong_reduce (
     p448_t *a
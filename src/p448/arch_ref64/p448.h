@@ -64,6 +64,20 @@ p448_mul (
     const p448_t *b
 );
 
+/**
+ * out = a*b + c*d, with one reduction instead of two.  The inputs have
+ * the same bounds as for p448_mul.
+ */
+#define P448_MUL_ADD 1
+void
+p448_mul_add (
+    p448_t *__restrict__ out,
+    const p448_t *a,
+    const p448_t *b,
+    const p448_t *c,
+    const p448_t *d
+);
+
 void
 p448_mulw (
     p448_t *__restrict__ out,
@@ -77,6 +91,18 @@ p448_sqr (
     const p448_t *a
 );
 
+/**
+ * out = a^(2^n), for n > 0.  This is p448_sqr n times, but keeps the
+ * intermediate values in registers.
+ */
+#define P448_SQRN 1
+void
+p448_sqrn (
+    p448_t *__restrict__ out,
+    const p448_t *a,
+    int n
+);
+
 void
 p448_serialize (
     uint8_t *serial,
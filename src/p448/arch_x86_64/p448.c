@@ -5,49 +5,62 @@
 #include "p448.h"
 #include "x86-64-arith.h"
 
-void
-p448_mul (
-    p448_t *__restrict__ cs,
-    const p448_t *as,
-    const p448_t *bs
+/*
+ * c = the sum of n products a[k] * b[k], with one carry chain.  This is inlined
+ * with n constant, so the loops in the macros below unroll away.
+ */
+#define WIDEMUL(acc,x,i,y,j) do { \
+    int k_; \
+    acc = widemul(&x[0][i],&y[0][j]); \
+    for (k_=1; k_<n; k_++) mac(&acc, &x[k_][i], &y[k_][j]); \
+} while (0)
+#define MAC(acc,x,i,y,j) do { \
+    int k_; \
+    for (k_=0; k_<n; k_++) mac(acc, &x[k_][i], &y[k_][j]); \
+} while (0)
+#define MSB(acc,x,i,y,j) do { \
+    int k_; \
+    for (k_=0; k_<n; k_++) msb(acc, &x[k_][i], &y[k_][j]); \
+} while (0)
+
+static __inline__ void __attribute__((always_inline))
+p448_mul_n (
+    uint64_t *__restrict__ c,
+    const uint64_t *const a[],
+    const uint64_t *const b[],
+    const int n
 ) {
-    const uint64_t *a = as->limb, *b = bs->limb;
-    uint64_t *c = cs->limb;
-
     __uint128_t accum0 = 0, accum1 = 0, accum2;
     uint64_t mask = (1ull<<56) - 1;  
 
-    uint64_t aa[4] __attribute__((aligned(32))), bb[4] __attribute__((aligned(32))), bbb[4] __attribute__((aligned(32)));
+    uint64_t aa[2][4] __attribute__((aligned(32))), bb[2][4] __attribute__((aligned(32))), bbb[2][4] __attribute__((aligned(32)));
 
     /* For some reason clang doesn't vectorize this without prompting? */
     unsigned int i;
-    for (i=0; i<sizeof(aa)/sizeof(uint64xn_t); i++) {
-        ((uint64xn_t*)aa)[i] = ((const uint64xn_t*)a)[i] + ((const uint64xn_t*)(&a[4]))[i];
-        ((uint64xn_t*)bb)[i] = ((const uint64xn_t*)b)[i] + ((const uint64xn_t*)(&b[4]))[i]; 
-        ((uint64xn_t*)bbb)[i] = ((const uint64xn_t*)bb)[i] + ((const uint64xn_t*)(&b[4]))[i];     
-    }
-    /*
-    for (int i=0; i<4; i++) {
-    aa[i] = a[i] + a[i+4];
-    bb[i] = b[i] + b[i+4];
+    int k;
+    for (k=0; k<n; k++) {
+        for (i=0; i<sizeof(aa[k])/sizeof(uint64xn_t); i++) {
+            ((uint64xn_t*)aa[k])[i] = ((const uint64xn_t*)a[k])[i] + ((const uint64xn_t*)(&a[k][4]))[i];
+            ((uint64xn_t*)bb[k])[i] = ((const uint64xn_t*)b[k])[i] + ((const uint64xn_t*)(&b[k][4]))[i]; 
+            ((uint64xn_t*)bbb[k])[i] = ((const uint64xn_t*)bb[k])[i] + ((const uint64xn_t*)(&b[k][4]))[i];     
+        }
     }
-    */
 
-    accum2  = widemul(&a[0],&b[3]);
-    accum0  = widemul(&aa[0],&bb[3]);
-    accum1  = widemul(&a[4],&b[7]);
+    WIDEMUL(accum2, a,0, b,3);
+    WIDEMUL(accum0, aa,0, bb,3);
+    WIDEMUL(accum1, a,4, b,7);
 
-    mac(&accum2, &a[1], &b[2]);
-    mac(&accum0, &aa[1], &bb[2]);
-    mac(&accum1, &a[5], &b[6]);
+    MAC(&accum2, a,1, b,2);
+    MAC(&accum0, aa,1, bb,2);
+    MAC(&accum1, a,5, b,6);
 
-    mac(&accum2, &a[2], &b[1]);
-    mac(&accum0, &aa[2], &bb[1]);
-    mac(&accum1, &a[6], &b[5]);
+    MAC(&accum2, a,2, b,1);
+    MAC(&accum0, aa,2, bb,1);
+    MAC(&accum1, a,6, b,5);
 
-    mac(&accum2, &a[3], &b[0]);
-    mac(&accum0, &aa[3], &bb[0]);
-    mac(&accum1, &a[7], &b[4]);
+    MAC(&accum2, a,3, b,0);
+    MAC(&accum0, aa,3, bb,0);
+    MAC(&accum1, a,7, b,4);
 
     accum0 -= accum2;
     accum1 += accum2;
@@ -58,23 +71,23 @@ p448_mul (
     accum0 >>= 56;
     accum1 >>= 56;
     
-    mac(&accum0, &aa[1],&bb[3]);
-    mac(&accum1, &a[5], &b[7]);
-    mac(&accum0, &aa[2], &bb[2]);
-    mac(&accum1, &a[6], &b[6]);
-    mac(&accum0, &aa[3], &bb[1]);
+    MAC(&accum0, aa,1, bb,3);
+    MAC(&accum1, a,5, b,7);
+    MAC(&accum0, aa,2, bb,2);
+    MAC(&accum1, a,6, b,6);
+    MAC(&accum0, aa,3, bb,1);
     accum1 += accum0;
 
-    accum2 = widemul(&a[0],&b[0]);
+    WIDEMUL(accum2, a,0, b,0);
     accum1 -= accum2;
     accum0 += accum2;
     
-    msb(&accum0, &a[1], &b[3]);
-    msb(&accum0, &a[2], &b[2]);
-    mac(&accum1, &a[7], &b[5]);
-    msb(&accum0, &a[3], &b[1]);
-    mac(&accum1, &aa[0], &bb[0]);
-    mac(&accum0, &a[4], &b[4]);
+    MSB(&accum0, a,1, b,3);
+    MSB(&accum0, a,2, b,2);
+    MAC(&accum1, a,7, b,5);
+    MSB(&accum0, a,3, b,1);
+    MAC(&accum1, aa,0, bb,0);
+    MAC(&accum0, a,4, b,4);
 
     c[0] = ((uint64_t)(accum0)) & mask;
     c[4] = ((uint64_t)(accum1)) & mask;
@@ -82,21 +95,21 @@ p448_mul (
     accum0 >>= 56;
     accum1 >>= 56;
 
-    accum2  = widemul(&a[2],&b[7]);
-    mac(&accum0, &a[6], &bb[3]);
-    mac(&accum1, &aa[2], &bbb[3]);
+    WIDEMUL(accum2, a,2, b,7);
+    MAC(&accum0, a,6, bb,3);
+    MAC(&accum1, aa,2, bbb,3);
 
-    mac(&accum2, &a[3], &b[6]);
-    mac(&accum0, &a[7], &bb[2]);
-    mac(&accum1, &aa[3], &bbb[2]);
+    MAC(&accum2, a,3, b,6);
+    MAC(&accum0, a,7, bb,2);
+    MAC(&accum1, aa,3, bbb,2);
 
-    mac(&accum2, &a[0],&b[1]);
-    mac(&accum1, &aa[0], &bb[1]);
-    mac(&accum0, &a[4], &b[5]);
+    MAC(&accum2, a,0, b,1);
+    MAC(&accum1, aa,0, bb,1);
+    MAC(&accum0, a,4, b,5);
 
-    mac(&accum2, &a[1], &b[0]);
-    mac(&accum1, &aa[1], &bb[0]);
-    mac(&accum0, &a[5], &b[4]);
+    MAC(&accum2, a,1, b,0);
+    MAC(&accum1, aa,1, bb,0);
+    MAC(&accum0, a,5, b,4);
 
     accum1 -= accum2;
     accum0 += accum2;
@@ -107,21 +120,21 @@ p448_mul (
     accum0 >>= 56;
     accum1 >>= 56;
 
-    accum2  = widemul(&a[3],&b[7]);
-    mac(&accum0, &a[7], &bb[3]);
-    mac(&accum1, &aa[3], &bbb[3]);
+    WIDEMUL(accum2, a,3, b,7);
+    MAC(&accum0, a,7, bb,3);
+    MAC(&accum1, aa,3, bbb,3);
 
-    mac(&accum2, &a[0],&b[2]);
-    mac(&accum1, &aa[0], &bb[2]);
-    mac(&accum0, &a[4], &b[6]);
+    MAC(&accum2, a,0, b,2);
+    MAC(&accum1, aa,0, bb,2);
+    MAC(&accum0, a,4, b,6);
 
-    mac(&accum2, &a[1], &b[1]);
-    mac(&accum1, &aa[1], &bb[1]);
-    mac(&accum0, &a[5], &b[5]);
+    MAC(&accum2, a,1, b,1);
+    MAC(&accum1, aa,1, bb,1);
+    MAC(&accum0, a,5, b,5);
 
-    mac(&accum2, &a[2], &b[0]);
-    mac(&accum1, &aa[2], &bb[0]);
-    mac(&accum0, &a[6], &b[4]);
+    MAC(&accum2, a,2, b,0);
+    MAC(&accum1, aa,2, bb,0);
+    MAC(&accum0, a,6, b,4);
 
     accum1 -= accum2;
     accum0 += accum2;
@@ -145,6 +158,32 @@ p448_mul (
     c[0] += ((uint64_t)(accum1));
 }
 
+#undef WIDEMUL
+#undef MAC
+#undef MSB
+
+void
+p448_mul (
+    p448_t *__restrict__ cs,
+    const p448_t *as,
+    const p448_t *bs
+) {
+    const uint64_t *a[1] = { as->limb }, *b[1] = { bs->limb };
+    p448_mul_n(cs->limb, a, b, 1);
+}
+
+void
+p448_mul_add (
+    p448_t *__restrict__ cs,
+    const p448_t *as,
+    const p448_t *bs,
+    const p448_t *ds,
+    const p448_t *es
+) {
+    const uint64_t *a[2] = { as->limb, ds->limb }, *b[2] = { bs->limb, es->limb };
+    p448_mul_n(cs->limb, a, b, 2);
+}
+
 void
 p448_mulw (
     p448_t *__restrict__ cs,
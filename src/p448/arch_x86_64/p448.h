@@ -63,6 +63,20 @@ p448_mul (
     const p448_t *b
 );
 
+/**
+ * out = a*b + c*d, with one reduction instead of two.  The inputs have
+ * the same bounds as for p448_mul.
+ */
+#define P448_MUL_ADD 1
+void
+p448_mul_add (
+    p448_t *__restrict__ out,
+    const p448_t *a,
+    const p448_t *b,
+    const p448_t *c,
+    const p448_t *d
+);
+
 void
 p448_mulw (
     p448_t *__restrict__ out,
@@ -0,0 +1,2 @@
+#define WORD_BITS 64
+#define ARCH_NAME "arch_x86_64_adx"
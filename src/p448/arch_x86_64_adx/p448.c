@@ -0,0 +1,323 @@
+/* Copyright (c) 2015 Cryptography Research, Inc.
+ * Released under the MIT License.  See LICENSE.txt for license information.
+ */
+
+#include "p448.h"
+
+/*
+ * The 7x7-word products are computed by rows, each of which is one word
+ * of a times all of b.  MULX leaves the flags alone, so each row runs two
+ * carry chains at once: ADOX adds the low halves of the partial products
+ * into the accumulator, and ADCX adds the high halves one word further up.
+ *
+ * The accumulator is a window of eight registers, r8-r15, which rotates
+ * by one per row: after row i, the bottom register holds the finished
+ * word i, which is stored and cleared to become the new top word.
+ */
+
+static const uint64_t ZERO_WORD = 0;
+
+#define W0 "%%r8"
+#define W1 "%%r9"
+#define W2 "%%r10"
+#define W3 "%%r11"
+#define W4 "%%r12"
+#define W5 "%%r13"
+#define W6 "%%r14"
+#define W7 "%%r15"
+
+/* Window += a[i] * b[j] at word j, with the high half at word j+1. */
+#define MULX_ACC(j,lo,hi) \
+    "mulxq " #j "*8(%%rcx), %%rax, %%rbx\n\t" \
+    "adoxq %%rax, " lo "\n\t" \
+    "adcxq %%rbx, " hi "\n\t"
+
+/* Finish a row: absorb the last OF carry, store word i and recycle its register. */
+#define ROW_END(i,w0,w7) \
+    "adoxq %[zero], " w7 "\n\t" \
+    "movq " w0 ", " #i "*8(%%rdi)\n\t" \
+    "xorq " w0 ", " w0 "\n\t"
+
+#define MUL_ROW(i,w0,w1,w2,w3,w4,w5,w6,w7) \
+    "movq " #i "*8(%%rsi), %%rdx\n\t" \
+    "xorl %%eax, %%eax\n\t" \
+    MULX_ACC(0,w0,w1) MULX_ACC(1,w1,w2) MULX_ACC(2,w2,w3) MULX_ACC(3,w3,w4) \
+    MULX_ACC(4,w4,w5) MULX_ACC(5,w5,w6) MULX_ACC(6,w6,w7) \
+    ROW_END(i,w0,w7)
+
+/* Squaring: row i only takes the products a[i]*a[j] for j > i. */
+#define SQR_ROW_START(i) \
+    "movq " #i "*8(%%rsi), %%rdx\n\t" \
+    "xorl %%eax, %%eax\n\t"
+
+#define SQR_ACC(j,lo,hi) \
+    "mulxq " #j "*8(%%rsi), %%rax, %%rbx\n\t" \
+    "adoxq %%rax, " lo "\n\t" \
+    "adcxq %%rbx, " hi "\n\t"
+
+/* Double the off-diagonal sum in memory and add a[i]^2, on two chains. */
+#define SQR_DIAG(i,lo,hi) \
+    "movq " #i "*8(%%rsi), %%rdx\n\t" \
+    "mulxq %%rdx, %%rax, %%rbx\n\t" \
+    "movq " #lo "*8(%%rdi), %%r8\n\t" \
+    "movq " #hi "*8(%%rdi), %%r9\n\t" \
+    "adcxq %%r8, %%r8\n\t" \
+    "adcxq %%r9, %%r9\n\t" \
+    "adoxq %%rax, %%r8\n\t" \
+    "adoxq %%rbx, %%r9\n\t" \
+    "movq %%r8, " #lo "*8(%%rdi)\n\t" \
+    "movq %%r9, " #hi "*8(%%rdi)\n\t"
+
+#define ZERO_WINDOW \
+    "xorq %%r8, %%r8\n\t"  "xorq %%r9, %%r9\n\t"  "xorq %%r10, %%r10\n\t" "xorq %%r11, %%r11\n\t" \
+    "xorq %%r12, %%r12\n\t" "xorq %%r13, %%r13\n\t" "xorq %%r14, %%r14\n\t" "xorq %%r15, %%r15\n\t"
+
+/*
+ * Reduce the 896-bit t mod p, to a value < 2^448, using 2^448 = 2^224+1.
+ * On entry the low half of t is at (%rdi) and the high half h is in
+ * r15,r8-r13.  The top half is folded in as h + h*2^224, where h*2^224 is
+ * h shifted up by 32 bits starting at word 3; the at most 225 bits which
+ * spill over 2^448 are folded the same way, and the carry of at most 3
+ * which is left is folded twice.  The result goes to *out.
+ */
+#define FOLD_R9 \
+    "movq %%r9, %%r10\n\t" \
+    "shlq $32, %%r10\n\t" \
+    "addq %%r9, %%r14\n\t" \
+    "adcq $0, %%rsi\n\t" \
+    "adcq $0, %%rcx\n\t" \
+    "adcq %%r10, %%rdx\n\t" \
+    "adcq $0, %%rbx\n\t" \
+    "adcq $0, %%r15\n\t" \
+    "adcq $0, %%r8\n\t" \
+    "movl $0, %%r9d\n\t" \
+    "adcq $0, %%r9\n\t"
+
+#define REDUCE \
+    /* s = lo + h, with the carry in rcx */ \
+    "xorl %%ecx, %%ecx\n\t" \
+    "addq %%r15, 0*8(%%rdi)\n\t" \
+    "adcq %%r8,  1*8(%%rdi)\n\t" \
+    "adcq %%r9,  2*8(%%rdi)\n\t" \
+    "adcq %%r10, 3*8(%%rdi)\n\t" \
+    "adcq %%r11, 4*8(%%rdi)\n\t" \
+    "adcq %%r12, 5*8(%%rdi)\n\t" \
+    "adcq %%r13, 6*8(%%rdi)\n\t" \
+    "adcq $0, %%rcx\n\t" \
+    /* h <<= 32, into r15,r8-r13,rax */ \
+    "movq %%r13, %%rax\n\t" \
+    "shrq $32, %%rax\n\t" \
+    "shldq $32, %%r12, %%r13\n\t" \
+    "shldq $32, %%r11, %%r12\n\t" \
+    "shldq $32, %%r10, %%r11\n\t" \
+    "shldq $32, %%r9, %%r10\n\t" \
+    "shldq $32, %%r8, %%r9\n\t" \
+    "shldq $32, %%r15, %%r8\n\t" \
+    "shlq $32, %%r15\n\t" \
+    /* s += h*2^224; words 7-10 of s end up in r11,r12,r13,rax */ \
+    "addq %%r15, 3*8(%%rdi)\n\t" \
+    "adcq %%r8,  4*8(%%rdi)\n\t" \
+    "adcq %%r9,  5*8(%%rdi)\n\t" \
+    "adcq %%r10, 6*8(%%rdi)\n\t" \
+    "adcq %%rcx, %%r11\n\t" \
+    "adcq $0, %%r12\n\t" \
+    "adcq $0, %%r13\n\t" \
+    "adcq $0, %%rax\n\t" \
+    /* c = s[0..6] + s[7..10], with the carry in r9 */ \
+    "movq 0*8(%%rdi), %%r14\n\t" \
+    "movq 1*8(%%rdi), %%rsi\n\t" \
+    "movq 2*8(%%rdi), %%rcx\n\t" \
+    "movq 3*8(%%rdi), %%rdx\n\t" \
+    "movq 4*8(%%rdi), %%rbx\n\t" \
+    "movq 5*8(%%rdi), %%r15\n\t" \
+    "movq 6*8(%%rdi), %%r8\n\t" \
+    "xorl %%r9d, %%r9d\n\t" \
+    "addq %%r11, %%r14\n\t" \
+    "adcq %%r12, %%rsi\n\t" \
+    "adcq %%r13, %%rcx\n\t" \
+    "adcq %%rax, %%rdx\n\t" \
+    "adcq $0, %%rbx\n\t" \
+    "adcq $0, %%r15\n\t" \
+    "adcq $0, %%r8\n\t" \
+    "adcq $0, %%r9\n\t" \
+    /* c += s[7..10]*2^224 */ \
+    "movq %%rax, %%r10\n\t" \
+    "shrq $32, %%r10\n\t" \
+    "shldq $32, %%r13, %%rax\n\t" \
+    "shldq $32, %%r12, %%r13\n\t" \
+    "shldq $32, %%r11, %%r12\n\t" \
+    "shlq $32, %%r11\n\t" \
+    "addq %%r11, %%rdx\n\t" \
+    "adcq %%r12, %%rbx\n\t" \
+    "adcq %%r13, %%r15\n\t" \
+    "adcq %%rax, %%r8\n\t" \
+    "adcq %%r10, %%r9\n\t" \
+    /* The second fold can't carry out */ \
+    FOLD_R9 \
+    FOLD_R9 \
+    "movq %[out], %%rdi\n\t" \
+    "movq %%r14, 0*8(%%rdi)\n\t" \
+    "movq %%rsi, 1*8(%%rdi)\n\t" \
+    "movq %%rcx, 2*8(%%rdi)\n\t" \
+    "movq %%rdx, 3*8(%%rdi)\n\t" \
+    "movq %%rbx, 4*8(%%rdi)\n\t" \
+    "movq %%r15, 5*8(%%rdi)\n\t" \
+    "movq %%r8,  6*8(%%rdi)\n\t" \
+    "movq $0,    7*8(%%rdi)\n\t"
+
+#define ASM_CLOBBERS "rax", "rbx", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15", "cc", "memory"
+
+void
+p448_mul (
+    p448_t *__restrict__ cs,
+    const p448_t *as,
+    const p448_t *bs
+) {
+    uint64_t t[7], *tp = t;
+    const uint64_t *a = as->limb, *b = bs->limb;
+    __asm__ __volatile__ (
+        ZERO_WINDOW
+        MUL_ROW(0, W0,W1,W2,W3,W4,W5,W6,W7)
+        MUL_ROW(1, W1,W2,W3,W4,W5,W6,W7,W0)
+        MUL_ROW(2, W2,W3,W4,W5,W6,W7,W0,W1)
+        MUL_ROW(3, W3,W4,W5,W6,W7,W0,W1,W2)
+        MUL_ROW(4, W4,W5,W6,W7,W0,W1,W2,W3)
+        MUL_ROW(5, W5,W6,W7,W0,W1,W2,W3,W4)
+        MUL_ROW(6, W6,W7,W0,W1,W2,W3,W4,W5)
+        /* The high half is now in W7,W0-W5, ie r15,r8-r13 */
+        REDUCE
+        : "+D"(tp), "+S"(a), "+c"(b)
+        : [zero]"m"(ZERO_WORD), [out]"m"(cs)
+        : ASM_CLOBBERS
+    );
+}
+
+void
+p448_sqr (
+    p448_t *__restrict__ cs,
+    const p448_t *as
+) {
+    uint64_t t[14], *tp = t;
+    const uint64_t *a = as->limb;
+    __asm__ __volatile__ (
+        /* Off-diagonal products, sum over i<j of a[i]a[j] */
+        ZERO_WINDOW
+        SQR_ROW_START(0)
+        SQR_ACC(1,W1,W2) SQR_ACC(2,W2,W3) SQR_ACC(3,W3,W4) SQR_ACC(4,W4,W5)
+        SQR_ACC(5,W5,W6) SQR_ACC(6,W6,W7)
+        ROW_END(0,W0,W7)
+        SQR_ROW_START(1)
+        SQR_ACC(2,W3,W4) SQR_ACC(3,W4,W5) SQR_ACC(4,W5,W6) SQR_ACC(5,W6,W7)
+        SQR_ACC(6,W7,W0)
+        ROW_END(1,W1,W0)
+        SQR_ROW_START(2)
+        SQR_ACC(3,W5,W6) SQR_ACC(4,W6,W7) SQR_ACC(5,W7,W0) SQR_ACC(6,W0,W1)
+        ROW_END(2,W2,W1)
+        SQR_ROW_START(3)
+        SQR_ACC(4,W7,W0) SQR_ACC(5,W0,W1) SQR_ACC(6,W1,W2)
+        ROW_END(3,W3,W2)
+        SQR_ROW_START(4)
+        SQR_ACC(5,W1,W2) SQR_ACC(6,W2,W3)
+        ROW_END(4,W4,W3)
+        SQR_ROW_START(5)
+        SQR_ACC(6,W3,W4)
+        ROW_END(5,W5,W4)
+        "movq " W6 ", 6*8(%%rdi)\n\t"
+        "movq " W7 ", 7*8(%%rdi)\n\t"
+        "movq " W0 ", 8*8(%%rdi)\n\t"
+        "movq " W1 ", 9*8(%%rdi)\n\t"
+        "movq " W2 ", 10*8(%%rdi)\n\t"
+        "movq " W3 ", 11*8(%%rdi)\n\t"
+        "movq " W4 ", 12*8(%%rdi)\n\t"
+        "movq $0, 13*8(%%rdi)\n\t"
+
+        /* t = 2t + diagonal */
+        "xorl %%eax, %%eax\n\t"
+        SQR_DIAG(0,0,1) SQR_DIAG(1,2,3) SQR_DIAG(2,4,5) SQR_DIAG(3,6,7)
+        SQR_DIAG(4,8,9) SQR_DIAG(5,10,11) SQR_DIAG(6,12,13)
+
+        "movq 7*8(%%rdi), %%r15\n\t"
+        "movq 8*8(%%rdi), %%r8\n\t"
+        "movq 9*8(%%rdi), %%r9\n\t"
+        "movq 10*8(%%rdi), %%r10\n\t"
+        "movq 11*8(%%rdi), %%r11\n\t"
+        "movq 12*8(%%rdi), %%r12\n\t"
+        "movq 13*8(%%rdi), %%r13\n\t"
+        REDUCE
+        : "+D"(tp), "+S"(a)
+        : [zero]"m"(ZERO_WORD), [out]"m"(cs)
+        : "rcx", ASM_CLOBBERS
+    );
+}
+
+void
+p448_mulw (
+    p448_t *__restrict__ cs,
+    const p448_t *as,
+    uint64_t b
+) {
+    __uint128_t chain = 0;
+    unsigned int i;
+    for (i=0; i<7; i++) {
+        chain += (__uint128_t)as->limb[i] * b;
+        cs->limb[i] = chain;
+        chain >>= 64;
+    }
+    cs->limb[7] = 0;
+    p448_fold(cs, p448_fold(cs, chain));
+}
+
+void
+p448_strong_reduce (
+    p448_t *a
+) {
+    /* a < 2^448 < 2p.  Compute a - p = a + (2^224+1) - 2^448, and keep it
+     * if that carries out, ie if a >= p.
+     */
+    p448_t b;
+    p448_copy(&b, a);
+    mask_t ge = -p448_fold(&b, 1);
+    unsigned int i;
+    for (i=0; i<7; i++) {
+        a->limb[i] = (a->limb[i] & ~ge) | (b.limb[i] & ge);
+    }
+    a->limb[7] = 0;
+}
+
+void
+p448_serialize (
+    uint8_t *serial,
+    const struct p448_t *x
+) {
+    int i,j;
+    p448_t red;
+    p448_copy(&red, x);
+    p448_strong_reduce(&red);
+    for (i=0; i<7; i++) {
+        for (j=0; j<8; j++) {
+            serial[8*i+j] = red.limb[i];
+            red.limb[i] >>= 8;
+        }
+    }
+}
+
+mask_t
+p448_deserialize (
+    p448_t *x,
+    const uint8_t serial[56]
+) {
+    int i,j;
+    for (i=0; i<7; i++) {
+        word_t out = 0;
+        for (j=0; j<8; j++) {
+            out |= ((word_t)serial[8*i+j])<<(8*j);
+        }
+        x->limb[i] = out;
+    }
+    x->limb[7] = 0;
+
+    /* It's reduced iff x + (2^224+1) doesn't carry out of 2^448. */
+    p448_t y;
+    p448_copy(&y, x);
+    return p448_fold(&y, 1) - 1;
+}
@@ -0,0 +1,245 @@
+/* Copyright (c) 2015 Cryptography Research, Inc.
+ * Released under the MIT License.  See LICENSE.txt for license information.
+ */
+#ifndef __P448_H__
+#define __P448_H__ 1
+
+#include <stdint.h>
+#include <assert.h>
+#include <immintrin.h>
+
+#include "word.h"
+
+/**
+ * Saturated representation: seven 64-bit limbs, little-endian, holding a
+ * value in [0,2^448) which is not necessarily reduced mod p.  The eighth
+ * limb is always zero; it keeps the size and alignment the same as the
+ * other backends, because decaf.h's gf_s has eight words.
+ *
+ * Every operation leaves its result in [0,2^448), so there is no headroom
+ * to track: add_RAW and sub_RAW reduce as they go, and bias and
+ * weak_reduce do nothing.
+ *
+ * mul and sqr need BMI2 and ADX (Broadwell or later).
+ */
+typedef struct p448_t {
+  uint64_t limb[8];
+} __attribute__((aligned(32))) p448_t;
+
+#define LBITS 64
+
+/* Literals are written as eight 56-bit limbs; repack them into seven words. */
+#define P448_LIT_(x) ((uint64_t)(x))
+#define FIELD_LITERAL(a,b,c,d,e,f,g,h) {{ \
+    P448_LIT_(a)     | P448_LIT_(b)<<56, P448_LIT_(b)>>8  | P448_LIT_(c)<<48, \
+    P448_LIT_(c)>>16 | P448_LIT_(d)<<40, P448_LIT_(d)>>24 | P448_LIT_(e)<<32, \
+    P448_LIT_(e)>>32 | P448_LIT_(f)<<24, P448_LIT_(f)>>40 | P448_LIT_(g)<<16, \
+    P448_LIT_(g)>>48 | P448_LIT_(h)<<8,  0 }}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static __inline__ void
+p448_add_RAW (
+    p448_t *out,
+    const p448_t *a,
+    const p448_t *b
+) __attribute__((unused,always_inline));
+
+static __inline__ void
+p448_sub_RAW (
+    p448_t *out,
+    const p448_t *a,
+    const p448_t *b
+) __attribute__((unused,always_inline));
+
+static __inline__ void
+p448_copy (
+    p448_t *out,
+    const p448_t *a
+) __attribute__((unused,always_inline));
+
+static __inline__ void
+p448_weak_reduce (
+    p448_t *inout
+) __attribute__((unused,always_inline));
+
+void
+p448_strong_reduce (
+    p448_t *inout
+);
+
+static __inline__ void
+p448_bias (
+    p448_t *inout,
+    int amount
+) __attribute__((unused,always_inline));
+
+void
+p448_mul (
+    p448_t *__restrict__ out,
+    const p448_t *a,
+    const p448_t *b
+);
+
+void
+p448_mulw (
+    p448_t *__restrict__ out,
+    const p448_t *a,
+    uint64_t b
+);
+
+void
+p448_sqr (
+    p448_t *__restrict__ out,
+    const p448_t *a
+);
+
+void
+p448_serialize (
+    uint8_t *serial,
+    const struct p448_t *x
+);
+
+mask_t
+p448_deserialize (
+    p448_t *x,
+    const uint8_t serial[56]
+);
+
+/* -------------- Inline functions begin here -------------- */
+
+/* Carry-chain steps; these compile to ADC and SBB. */
+static __inline__ unsigned char __attribute__((unused,always_inline))
+p448_adc (
+    unsigned char c,
+    uint64_t a,
+    uint64_t b,
+    uint64_t *out
+) {
+    unsigned long long r;
+    c = _addcarry_u64(c, a, b, &r);
+    *out = r;
+    return c;
+}
+
+static __inline__ unsigned char __attribute__((unused,always_inline))
+p448_sbb (
+    unsigned char c,
+    uint64_t a,
+    uint64_t b,
+    uint64_t *out
+) {
+    unsigned long long r;
+    c = _subborrow_u64(c, a, b, &r);
+    *out = r;
+    return c;
+}
+
+/**
+ * x += c * 2^448 mod p, that is x += c*(2^224+1), for x < 2^448.
+ * Returns the carry out of 2^448.
+ */
+static __inline__ uint64_t __attribute__((unused,always_inline))
+p448_fold (
+    p448_t *x,
+    uint64_t c
+) {
+    unsigned char f;
+    f = p448_adc(0, x->limb[0], c,     &x->limb[0]);
+    f = p448_adc(f, x->limb[1], 0,     &x->limb[1]);
+    f = p448_adc(f, x->limb[2], 0,     &x->limb[2]);
+    f = p448_adc(f, x->limb[3], c<<32, &x->limb[3]);
+    f = p448_adc(f, x->limb[4], c>>32, &x->limb[4]);
+    f = p448_adc(f, x->limb[5], 0,     &x->limb[5]);
+    f = p448_adc(f, x->limb[6], 0,     &x->limb[6]);
+    return f;
+}
+
+/**
+ * x -= c * 2^448 mod p, for x < 2^448 and c < 2^32.
+ * Returns the borrow out of the bottom, as 0 or 1.
+ */
+static __inline__ uint64_t __attribute__((unused,always_inline))
+p448_unfold (
+    p448_t *x,
+    uint64_t c
+) {
+    unsigned char f;
+    f = p448_sbb(0, x->limb[0], c,     &x->limb[0]);
+    f = p448_sbb(f, x->limb[1], 0,     &x->limb[1]);
+    f = p448_sbb(f, x->limb[2], 0,     &x->limb[2]);
+    f = p448_sbb(f, x->limb[3], c<<32, &x->limb[3]);
+    f = p448_sbb(f, x->limb[4], 0,     &x->limb[4]);
+    f = p448_sbb(f, x->limb[5], 0,     &x->limb[5]);
+    f = p448_sbb(f, x->limb[6], 0,     &x->limb[6]);
+    return f;
+}
+
+void
+p448_add_RAW (
+    p448_t *out,
+    const p448_t *a,
+    const p448_t *b
+) {
+    unsigned char f = 0;
+    unsigned int i;
+    for (i=0; i<7; i++) f = p448_adc(f, a->limb[i], b->limb[i], &out->limb[i]);
+    out->limb[7] = 0;
+
+    /* The second fold can't carry out again. */
+    p448_fold(out, p448_fold(out, f));
+}
+
+void
+p448_sub_RAW (
+    p448_t *out,
+    const p448_t *a,
+    const p448_t *b
+) {
+    unsigned char f = 0;
+    unsigned int i;
+    for (i=0; i<7; i++) f = p448_sbb(f, a->limb[i], b->limb[i], &out->limb[i]);
+    out->limb[7] = 0;
+
+    /* On borrow we wrapped around 2^448, so take off 2^448 = 2^224+1 mod p.
+     * That can borrow once more, but not twice.
+     */
+    p448_unfold(out, p448_unfold(out, f));
+}
+
+void
+p448_copy (
+    p448_t *out,
+    const p448_t *a
+) {
+    unsigned int i;
+    for (i=0; i<sizeof(*out)/sizeof(big_register_t); i++) {
+        ((big_register_t *)out)[i] = ((const big_register_t *)a)[i];
+    }
+}
+
+void
+p448_bias (
+    p448_t *a,
+    int amt
+) {
+    /* Subtraction already keeps values nonnegative. */
+    (void)a;
+    (void)amt;
+}
+
+void
+p448_weak_reduce (
+    p448_t *a
+) {
+    /* Values are always < 2^448. */
+    (void)a;
+}
+
+#ifdef __cplusplus
+}; /* extern "C" */
+#endif
+
+#endif /* __P448_H__ */
@@ -0,0 +1,19 @@
+/* Copyright (c) 2015 Cryptography Research, Inc.
+ * Released under the MIT License.  See LICENSE.txt for license information.
+ */
+
+/*
+ * Force-included (-include) when building one backend of a dispatch build,
+ * with -DP448_BACKEND=<name>, so that its out-of-line functions come out as
+ * p448_<name>_mul and so on.  See p448.h.
+ */
+#define P448_BACKEND_FN__(b,f) p448_##b##_##f
+#define P448_BACKEND_FN_(b,f)  P448_BACKEND_FN__(b,f)
+
+#define p448_mul            P448_BACKEND_FN_(P448_BACKEND,mul)
+#define p448_sqr            P448_BACKEND_FN_(P448_BACKEND,sqr)
+#define p448_mul_add        P448_BACKEND_FN_(P448_BACKEND,mul_add)
+#define p448_mulw           P448_BACKEND_FN_(P448_BACKEND,mulw)
+#define p448_strong_reduce  P448_BACKEND_FN_(P448_BACKEND,strong_reduce)
+#define p448_serialize      P448_BACKEND_FN_(P448_BACKEND,serialize)
+#define p448_deserialize    P448_BACKEND_FN_(P448_BACKEND,deserialize)
@@ -0,0 +1,141 @@
+/* Copyright (c) 2015 Cryptography Research, Inc.
+ * Released under the MIT License.  See LICENSE.txt for license information.
+ */
+
+#include "p448.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BACKEND_DECLS(pfx) \
+    void p448_##pfx##_mul (p448_t *__restrict__ cs, const p448_t *as, const p448_t *bs); \
+    void p448_##pfx##_mul_add (p448_t *__restrict__ cs, const p448_t *as, \
+        const p448_t *bs, const p448_t *ds, const p448_t *es); \
+    void p448_##pfx##_sqr (p448_t *__restrict__ cs, const p448_t *as); \
+    void p448_##pfx##_mulw (p448_t *__restrict__ cs, const p448_t *as, uint64_t b); \
+    void p448_##pfx##_strong_reduce (p448_t *a); \
+    void p448_##pfx##_serialize (uint8_t *serial, const struct p448_t *x); \
+    mask_t p448_##pfx##_deserialize (p448_t *x, const uint8_t serial[56]);
+
+BACKEND_DECLS(ref64)
+BACKEND_DECLS(x86_64)
+
+/** The out-of-line operations of one backend. */
+typedef struct {
+    const char *name;
+    void (*mul) (p448_t *__restrict__ cs, const p448_t *as, const p448_t *bs);
+    void (*mul_add) (p448_t *__restrict__ cs, const p448_t *as,
+        const p448_t *bs, const p448_t *ds, const p448_t *es);
+    void (*sqr) (p448_t *__restrict__ cs, const p448_t *as);
+    void (*mulw) (p448_t *__restrict__ cs, const p448_t *as, uint64_t b);
+    void (*strong_reduce) (p448_t *a);
+    void (*serialize) (uint8_t *serial, const struct p448_t *x);
+    mask_t (*deserialize) (p448_t *x, const uint8_t serial[56]);
+    int (*supported) (void);
+} p448_backend_t;
+
+#define BACKEND(pfx, supported) { "arch_" #pfx, \
+    p448_##pfx##_mul, p448_##pfx##_mul_add, p448_##pfx##_sqr, p448_##pfx##_mulw, \
+    p448_##pfx##_strong_reduce, p448_##pfx##_serialize, \
+    p448_##pfx##_deserialize, supported }
+
+static int always (void) { return 1; }
+
+static int have_avx2_bmi2 (void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+}
+
+/** In order of preference.  The last one must always be supported. */
+static const p448_backend_t backends[] = {
+    BACKEND(x86_64, have_avx2_bmi2),
+    BACKEND(ref64, always)
+};
+#define N_BACKENDS (sizeof(backends)/sizeof(backends[0]))
+
+/* A copy rather than a pointer, to save a load on every call.  It starts
+ * out as the portable backend in case anything runs before the constructor.
+ */
+static p448_backend_t impl = BACKEND(ref64, always);
+
+/**
+ * Pick the first supported backend, or the one named by the environment
+ * variable DECAF_FIELD_BACKEND (eg "arch_ref64") if it's supported here.
+ */
+static void __attribute__((constructor))
+p448_dispatch_init (void) {
+    const char *want = getenv("DECAF_FIELD_BACKEND");
+    unsigned int i;
+    for (i=0; i<N_BACKENDS; i++) {
+        if (want && strcmp(want, backends[i].name)) continue;
+        if (backends[i].supported()) {
+            impl = backends[i];
+            return;
+        }
+    }
+    impl = backends[N_BACKENDS-1];
+}
+
+const char *
+p448_backend_name (void) {
+    return impl.name;
+}
+
+void
+p448_mul (
+    p448_t *__restrict__ cs,
+    const p448_t *as,
+    const p448_t *bs
+) {
+    impl.mul(cs, as, bs);
+}
+
+void
+p448_mul_add (
+    p448_t *__restrict__ cs,
+    const p448_t *as,
+    const p448_t *bs,
+    const p448_t *ds,
+    const p448_t *es
+) {
+    impl.mul_add(cs, as, bs, ds, es);
+}
+
+void
+p448_sqr (
+    p448_t *__restrict__ cs,
+    const p448_t *as
+) {
+    impl.sqr(cs, as);
+}
+
+void
+p448_mulw (
+    p448_t *__restrict__ cs,
+    const p448_t *as,
+    uint64_t b
+) {
+    impl.mulw(cs, as, b);
+}
+
+void
+p448_strong_reduce (
+    p448_t *a
+) {
+    impl.strong_reduce(a);
+}
+
+void
+p448_serialize (
+    uint8_t *serial,
+    const struct p448_t *x
+) {
+    impl.serialize(serial, x);
+}
+
+mask_t
+p448_deserialize (
+    p448_t *x,
+    const uint8_t serial[56]
+) {
+    return impl.deserialize(x, serial);
+}
@@ -0,0 +1,29 @@
+/* Copyright (c) 2015 Cryptography Research, Inc.
+ * Released under the MIT License.  See LICENSE.txt for license information.
+ */
+#ifndef __P448_DISPATCH_H__
+#define __P448_DISPATCH_H__ 1
+
+/**
+ * Runtime dispatch between arch_ref64 and arch_x86_64.  They use the same
+ * representation, eight 56-bit limbs with the same headroom, so the tables
+ * and the inline operations can be shared and only the out-of-line ones
+ * need to be switched.
+ *
+ * The inline operations come from arch_x86_64's header, which falls back to
+ * SSE2 when AVX2 isn't enabled, as it isn't for the generic code here.  The
+ * out-of-line ones are built once per backend with that backend's flags,
+ * under their own names (see backend.h), and p448.c picks one at load time.
+ *
+ * arch_x86_64_adx can't be added this way: its limbs are saturated, so
+ * everything compiled against the field, tables included, would differ.
+ */
+#define P448_DISPATCH 1
+
+#include "../arch_x86_64/p448.h"
+
+/** The name of the backend picked at load time, eg "arch_ref64". */
+const char *
+p448_backend_name (void);
+
+#endif /* __P448_DISPATCH_H__ */
@@ -0,0 +1,61 @@
+/**
+ * @file decaf_curve.h
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Curve-specific names and constants for the Decaf group code:
+ * Ed448-Goldilocks.
+ *
+ * decaf_fast.c, decaf_crypto.c and decaf_gen_tables.c are written against
+ * the names here, so that each field directory can instantiate them for
+ * its own curve.
+ */
+#ifndef __DECAF_CURVE_H__
+#define __DECAF_CURVE_H__ 1
+
+#include "decaf.h"
+#include "decaf_crypto.h"
+#include "decaf_448_config.h"
+
+/* Rename table, MSR ECC style */
+#define SCALAR_LIMBS DECAF_448_SCALAR_LIMBS
+#define SCALAR_BITS DECAF_448_SCALAR_BITS
+#define SCALAR_BYTES DECAF_448_SCALAR_BYTES
+#define NLIMBS DECAF_448_LIMBS
+#define SER_BYTES DECAF_448_SER_BYTES
+#define API_NS(_id) decaf_448_##_id
+#define API_NS2(_pref,_id) _pref##_decaf_448_##_id
+#define API_NAME "decaf_448"
+#define CURVE_NAME "Ed448-Goldilocks"
+#define scalar_t decaf_448_scalar_t
+#define point_t decaf_448_point_t
+#define point_s decaf_448_point_s
+#define precomputed_s decaf_448_precomputed_s
+#define precomputed_comb_s decaf_448_precomputed_comb_s
+#define precomputed_wnaf_s decaf_448_precomputed_wnaf_s
+
+/** The curve is x^2 + y^2 = 1 + d*x^2*y^2, with d = EDWARDS_D. */
+#define CURVE_EDWARDS_D (-39081)
+
+/** The prime order q of the group, in SC_LIMB words. */
+#define CURVE_SC_P \
+    SC_LIMB(0x2378c292ab5844f3), \
+    SC_LIMB(0x216cc2728dc58f55), \
+    SC_LIMB(0xc44edb49aed63690), \
+    SC_LIMB(0xffffffff7cca23e9), \
+    SC_LIMB(0xffffffffffffffff), \
+    SC_LIMB(0xffffffffffffffff), \
+    SC_LIMB(0x3fffffffffffffff)
+
+/** q in signed 62-bit limbs, and 1/q mod 2^62, for modinv62. */
+#define CURVE_SC_MODINV62 \
+    {{ 0x2378c292ab5844f3, 0x05b309ca37163d54, 0x04edb49aed636902, 0x3fffffdf3288fa71, \
+       0x3fffffffffffffff, 0x3fffffffffffffff, 0x3fffffffffffffff, 0xfff }}, \
+    0x3c42bbf0516e743b
+
+/** sqrt(5) = 2phi-1 from the curve spec; decaf_gen_tables decodes it. */
+#define CURVE_BASE_POINT_SER \
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,1
+
+#endif /* __DECAF_CURVE_H__ */
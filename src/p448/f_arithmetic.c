@@ -9,6 +9,8 @@
  */
 
 #include "field.h"
+#include "modinv.h"
+#include "decaf.h"
 
 void 
 field_isr (
@@ -41,3 +43,45 @@ field_isr (
     field_sqrn (   L0,   L1,   223 );
     field_mul  (     a,   L2,   L0 );
 }
+
+#if MODINV62
+static const modinv62_modulus_t p448_modinv = {
+    {{ 0x3fffffffffffffff, 0x3fffffffffffffff, 0x3fffffffffffffff, 0x3fffffbfffffffff,
+       0x3fffffffffffffff, 0x3fffffffffffffff, 0x3fffffffffffffff, 0x3fff }},
+    0x3fffffffffffffff, MODINV62_BATCHES(448)
+};
+#endif
+
+void
+field_inverse (
+    field_a_t a,
+    const field_a_t x
+) {
+#if MODINV62
+    uint8_t ser[FIELD_BITS/8];
+    modinv62_t t;
+    field_serialize(ser, x);
+    modinv62_from_bytes(&t, ser, sizeof(ser));
+    modinv62(&t, &p448_modinv);
+    modinv62_to_bytes(ser, sizeof(ser), &t);
+    mask_t ok = field_deserialize(a, ser);
+    (void)ok; /* Always canonical */
+    decaf_bzero(ser, sizeof(ser));
+    decaf_bzero(&t, sizeof(t));
+#else
+    /* 1/x = x * (1/sqrt(x^2))^2; the sign of the isr doesn't matter. */
+    field_a_t L0, L1;
+    field_sqr ( L0, x );
+    field_isr ( L1, L0 );
+    field_sqr ( L0, L1 );
+    field_mul ( a, L0, x );
+#endif
+}
+
+#ifndef P448_DISPATCH
+/* Dispatch builds define this in their p448.c */
+const char *
+field_backend_name (void) {
+    return ARCH_NAME;
+}
+#endif
@@ -28,5 +28,12 @@
 #define field_strong_reduce  p448_strong_reduce
 #define field_serialize      p448_serialize
 #define field_deserialize    p448_deserialize
+#define field_backend_name   p448_backend_name
+#ifdef P448_MUL_ADD
+#define field_mul_add        p448_mul_add
+#endif
+#ifdef P448_SQRN
+#define field_sqrn           p448_sqrn
+#endif
 
 #endif /* __F_FIELD_H__ */
@@ -0,0 +1,185 @@
+/**
+ * @cond internal
+ * @file p448_x4.c
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Four-way AVX2 p448 arithmetic.  See p448_x4.h.
+ */
+
+#include "p448_x4.h"
+#include "field.h"
+#include "decaf.h"
+
+#if P448_X4
+
+/** Low 32 bits of each lane of a, times those of b. */
+static __inline__ uint64x4_t __attribute__((always_inline))
+mul32x4 (uint64x4_t a, uint64x4_t b) {
+    return (uint64x4_t)_mm256_mul_epu32((__m256i)a, (__m256i)b);
+}
+
+/*
+ * In the product, limb m >= 16 has weight 2^(28m) = 2^(28(m-16)) * 2^448,
+ * and 2^448 = 2^224+1 mod p, so it's added to limbs m-16 and m-8.  Doing
+ * that from the top down and collecting terms:
+ *     c[k]   = P[k]   + P[k+16] + P[k+24]     for k < 8
+ *     c[k]   = P[k]   + P[k+8]  + 2*P[k+16]   for k >= 8
+ * where P[m] is the sum of a[i]*b[j] over i+j=m.  At most 38 products land
+ * in any c[k], which with limbs < 2^29+2^11 is < 2^63.3, so nothing
+ * overflows before the carries.
+ */
+
+void
+p448_x4_mul (
+    p448_x4_t *__restrict__ cs,
+    const p448_x4_t *as,
+    const p448_x4_t *bs
+) {
+    const uint64x4_t *a = as->limb, *b = bs->limb;
+    uint64x4_t lo[24], hi[24], acc;
+    int i, k;
+
+    /* Fold the weights into b, so that each c[k] is a plain sum of 16
+     * products a[i] * t[k-i], which the compiler can unroll:
+     *     lo[x+16] = coefficient of a[i] in c[k],   x = k-i, k < 8
+     *     hi[x+16] = coefficient of a[i] in c[k+8], x = k-i, k < 8
+     * The sums b[t]+b[t+8] and b[t]+2b[t+8] are < 2^32 as VPMULUDQ needs.
+     */
+    for (i=0; i<8; i++) {
+        lo[i]    = b[i] + b[i+8];
+        lo[i+8]  = b[i+8];
+        lo[i+16] = b[i];
+        hi[i]    = lo[i] + b[i+8];
+        hi[i+8]  = lo[i];
+        hi[i+16] = b[i+8];
+    }
+
+    for (k=0; k<8; k++) {
+        acc = mul32x4(a[0], lo[k+16]);
+        for (i=1; i<16; i++) acc += mul32x4(a[i], lo[k-i+16]);
+        cs->limb[k] = acc;
+    }
+
+    for (k=0; k<8; k++) {
+        acc = mul32x4(a[0], hi[k+16]);
+        for (i=1; i<16; i++) acc += mul32x4(a[i], hi[k-i+16]);
+        cs->limb[k+8] = acc;
+    }
+
+    /* Two passes take the limbs from < 2^64 to < 2^28 + 2^10. */
+    p448_x4_weak_reduce(cs);
+    p448_x4_weak_reduce(cs);
+}
+
+void
+p448_x4_sqr (
+    p448_x4_t *__restrict__ cs,
+    const p448_x4_t *as
+) {
+    const uint64x4_t *a = as->limb;
+    uint64x4_t a2[16], p[32];
+    const uint64x4_t zero = { 0, 0, 0, 0 };
+    int i, m;
+
+    for (i=0; i<16; i++) a2[i] = a[i] + a[i];
+
+    /* P[m], using each off-diagonal product once, doubled.  In halves,
+     * a^2 = lo^2 + 2*lo*hi*2^224 + hi^2*2^448, because the compiler will
+     * unroll the 8x8 triangles and square, but not the 16x16 triangle.
+     */
+    for (m=0; m<32; m++) p[m] = zero;
+    for (i=0; i<8; i++) {
+        p[2*i]    += mul32x4(a[i],   a[i]);
+        p[2*i+16] += mul32x4(a[i+8], a[i+8]);
+        for (m=i+1; m<8; m++) {
+            p[i+m]    += mul32x4(a[i],   a2[m]);
+            p[i+m+16] += mul32x4(a[i+8], a2[m+8]);
+        }
+        for (m=0; m<8; m++) p[i+m+8] += mul32x4(a[i], a2[m+8]);
+    }
+
+    for (i=0; i<8; i++) {
+        cs->limb[i]   = p[i] + p[i+16] + p[i+24];
+        cs->limb[i+8] = p[i+8] + p[i+16] + p[i+24] + p[i+24];
+    }
+
+    p448_x4_weak_reduce(cs);
+    p448_x4_weak_reduce(cs);
+}
+
+void
+p448_x4_load (
+    p448_x4_t *out,
+    const p448_t in[4]
+) {
+    uint8_t ser[56];
+    uint64_t limb[4][16];
+    int i, j, k;
+
+    for (j=0; j<4; j++) {
+        field_serialize(ser, &in[j]);
+        for (i=0; i<8; i++) {
+            uint64_t w = 0;
+            for (k=6; k>=0; k--) w = w<<8 | ser[7*i+k];
+            limb[j][2*i]   = w & ((1ull<<28)-1);
+            limb[j][2*i+1] = w >> 28;
+        }
+    }
+
+    for (i=0; i<16; i++) {
+        uint64x4_t v = { limb[0][i], limb[1][i], limb[2][i], limb[3][i] };
+        out->limb[i] = v;
+    }
+
+    decaf_bzero(ser, sizeof(ser));
+    decaf_bzero(limb, sizeof(limb));
+}
+
+void
+p448_x4_store (
+    p448_t out[4],
+    const p448_x4_t *in
+) {
+    uint8_t ser[56];
+    uint64_t limb[16], carry;
+    int i, j, k, pass;
+
+    for (j=0; j<4; j++) {
+        for (i=0; i<16; i++) limb[i] = in->limb[i][j];
+
+        /* Carry to exact 28-bit limbs, which is a value < 2^448.  For
+         * limbs < 2^32, the second pass wraps around at most 1, and the
+         * third only has to carry that along.
+         */
+        for (pass=0; pass<3; pass++) {
+            for (i=0; i<15; i++) {
+                limb[i+1] += limb[i] >> 28;
+                limb[i] &= (1ull<<28)-1;
+            }
+            carry = limb[15] >> 28;
+            limb[15] &= (1ull<<28)-1;
+            limb[0] += carry;
+            limb[8] += carry;
+        }
+
+        for (i=0; i<8; i++) {
+            uint64_t w = limb[2*i] | limb[2*i+1]<<28;
+            for (k=0; k<7; k++) {
+                ser[7*i+k] = w;
+                w >>= 8;
+            }
+        }
+
+        /* This may be >= p, which deserialize will flag, but the value is
+         * still right.
+         */
+        (void)field_deserialize(&out[j], ser);
+    }
+
+    decaf_bzero(ser, sizeof(ser));
+    decaf_bzero(limb, sizeof(limb));
+}
+
+#endif /* P448_X4 */
@@ -0,0 +1,189 @@
+/**
+ * @file p448_x4.h
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Four p448 elements at once, in AVX2 registers.
+ *
+ * This is a structure-of-arrays type: limb i of all four elements lives in
+ * one 256-bit register, one element per 64-bit lane.  The limbs are radix
+ * 2^28, so that every limb product fits VPMULUDQ's 32x32->64-bit multiply,
+ * and there are sixteen of them.
+ *
+ * It is independent of the scalar backend: p448_x4_load and p448_x4_store
+ * go through field_serialize and field_deserialize, so they work with any
+ * ARCH.  They're meant to be used at the edges of a batch (encode, decode,
+ * ladders, bucket sums), not once per operation.
+ *
+ * Bounds, per limb: a "reduced" value has limbs < 2^28 + 2^10.  mul and sqr
+ * take inputs with limbs < 2^29 + 2^11, which is to say a reduced value or
+ * the sum of two, and produce reduced values.  sub takes the same inputs
+ * and produces reduced values; add_nr doesn't reduce.
+ */
+
+#ifndef __P448_X4_H__
+#define __P448_X4_H__ 1
+
+#include "word.h"
+#include "p448.h"
+
+#if __AVX2__
+#define P448_X4 1
+
+#define P448_X4_LIMBS 16
+
+/** Four field elements, structure-of-arrays. */
+typedef struct p448_x4_t {
+    uint64x4_t limb[P448_X4_LIMBS];
+} p448_x4_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static __inline__ void
+p448_x4_weak_reduce (
+    p448_x4_t *inout
+) __attribute__((unused,always_inline));
+
+static __inline__ void
+p448_x4_add_nr (
+    p448_x4_t *out,
+    const p448_x4_t *a,
+    const p448_x4_t *b
+) __attribute__((unused,always_inline));
+
+static __inline__ void
+p448_x4_add (
+    p448_x4_t *out,
+    const p448_x4_t *a,
+    const p448_x4_t *b
+) __attribute__((unused,always_inline));
+
+static __inline__ void
+p448_x4_sub (
+    p448_x4_t *out,
+    const p448_x4_t *a,
+    const p448_x4_t *b
+) __attribute__((unused,always_inline));
+
+/**
+ * Constant-time select, lane by lane: out[j] = sel[j] ? b[j] : a[j].
+ * Each sel[j] must be 0 or -1.
+ */
+static __inline__ void
+p448_x4_cond_sel (
+    p448_x4_t *out,
+    const p448_x4_t *a,
+    const p448_x4_t *b,
+    const mask_t sel[4]
+) __attribute__((unused,always_inline));
+
+void
+p448_x4_mul (
+    p448_x4_t *__restrict__ out,
+    const p448_x4_t *a,
+    const p448_x4_t *b
+);
+
+void
+p448_x4_sqr (
+    p448_x4_t *__restrict__ out,
+    const p448_x4_t *a
+);
+
+/** Gather four scalar field elements into lanes 0-3. */
+void
+p448_x4_load (
+    p448_x4_t *out,
+    const p448_t in[4]
+);
+
+/** Scatter the four lanes into scalar field elements. */
+void
+p448_x4_store (
+    p448_t out[4],
+    const p448_x4_t *in
+);
+
+/* -------------- Inline functions begin here -------------- */
+
+void
+p448_x4_weak_reduce (
+    p448_x4_t *a
+) {
+    const uint64x4_t mask = {
+        (1ull<<28)-1, (1ull<<28)-1, (1ull<<28)-1, (1ull<<28)-1
+    };
+    uint64x4_t tmp = a->limb[15] >> 28;
+    int i;
+    a->limb[8] += tmp;
+    for (i=15; i>0; i--) {
+        a->limb[i] = (a->limb[i] & mask) + (a->limb[i-1]>>28);
+    }
+    a->limb[0] = (a->limb[0] & mask) + tmp;
+}
+
+void
+p448_x4_add_nr (
+    p448_x4_t *out,
+    const p448_x4_t *a,
+    const p448_x4_t *b
+) {
+    int i;
+    for (i=0; i<P448_X4_LIMBS; i++) {
+        out->limb[i] = a->limb[i] + b->limb[i];
+    }
+}
+
+void
+p448_x4_add (
+    p448_x4_t *out,
+    const p448_x4_t *a,
+    const p448_x4_t *b
+) {
+    p448_x4_add_nr(out, a, b);
+    p448_x4_weak_reduce(out);
+}
+
+void
+p448_x4_sub (
+    p448_x4_t *out,
+    const p448_x4_t *a,
+    const p448_x4_t *b
+) {
+    /* Bias by 4p, whose limbs are 2^30-4 except for limb 8, which is 2^30-8. */
+    const uint64x4_t four_p = {
+        (1ull<<30)-4, (1ull<<30)-4, (1ull<<30)-4, (1ull<<30)-4
+    };
+    const uint64x4_t four = { 4, 4, 4, 4 };
+    int i;
+    for (i=0; i<P448_X4_LIMBS; i++) {
+        out->limb[i] = a->limb[i] - b->limb[i] + four_p;
+    }
+    out->limb[8] -= four;
+    p448_x4_weak_reduce(out);
+}
+
+void
+p448_x4_cond_sel (
+    p448_x4_t *out,
+    const p448_x4_t *a,
+    const p448_x4_t *b,
+    const mask_t sel[4]
+) {
+    const uint64x4_t m = { sel[0], sel[1], sel[2], sel[3] };
+    int i;
+    for (i=0; i<P448_X4_LIMBS; i++) {
+        out->limb[i] = (a->limb[i] & ~m) | (b->limb[i] & m);
+    }
+}
+
+#ifdef __cplusplus
+}; /* extern "C" */
+#endif
+
+#endif /* __AVX2__ */
+
+#endif /* __P448_X4_H__ */
@@ -0,0 +1,25 @@
+/**
+ * @file decaf_curve.h
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Curve-specific names and constants for the Decaf group code:
+ * Ed480-Ridinghood, not yet available.  See src/p448/decaf_curve.h.
+ */
+#ifndef __DECAF_CURVE_H__
+#define __DECAF_CURVE_H__ 1
+
+/*
+ * FIXME: Ridinghood is x^2 + y^2 = 1 + d x^2 y^2 mod 2^480-2^240-1 with d one
+ * of +-5382[45] (HISTORY.txt), but neither the choice nor the point count
+ * was written down in this tree.  The group order q, its modinv62 form and
+ * the base point all follow from it.  Once it's been counted (eg with PARI's
+ * ellcard or Sage's EllipticCurve.order()), add decaf_480.h,
+ * decaf_crypto_480.h and decaf_480_config.h after the decaf_521 ones, fill
+ * in this file after src/p521/decaf_curve.h, and give src/p480/f_arithmetic.c
+ * a field_inverse.
+ */
+#error "FIELD=p480: Ed480-Ridinghood's group order isn't known yet, so there is no decaf_480 library; see src/p480/decaf_curve.h"
+
+#endif /* __DECAF_CURVE_H__ */
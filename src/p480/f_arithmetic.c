@@ -41,3 +41,8 @@ field_isr (
     field_sqrn (   L0,   L1,   239 );
     field_mul  (     a,   L2,   L0 );
 }
+
+const char *
+field_backend_name (void) {
+    return ARCH_NAME;
+}
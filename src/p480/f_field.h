@@ -28,5 +28,6 @@
 #define field_strong_reduce  p480_strong_reduce
 #define field_serialize      p480_serialize
 #define field_deserialize    p480_deserialize
+#define field_backend_name   p480_backend_name
 
 #endif /* __F_FIELD_H__ */
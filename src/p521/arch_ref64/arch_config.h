@@ -1 +1,3 @@
 #define WORD_BITS 64
+#define ARCH_NAME "arch_ref64"
+#define MODINV62_LIMBS 9
@@ -1 +1,3 @@
 #define WORD_BITS 64
+#define ARCH_NAME "arch_x86_64_r12"
+#define MODINV62_LIMBS 9
@@ -444,7 +444,7 @@ p521_serialize (
 mask_t
 p521_deserialize (
     p521_t *x,
-    const uint8_t serial[LIMBPERM(66)]
+    const uint8_t serial[66]
 ) {
     int i,k=0,bits=0;
     __uint128_t out = 0;
@@ -12,12 +12,22 @@
 #include "constant_time.h"
 
 #define LIMBPERM(x) (((x)%3)*4 + (x)/3)
+#define FIELD_LITERAL(a,b,c,d,e,f,g,h,i) {{a,d,g,0,b,e,h,0,c,f,i,0}}
 #define USE_P521_3x3_TRANSPOSE
 
 typedef struct p521_t {
   uint64_t limb[12];
 } __attribute__((aligned(32))) p521_t;
 
+/*
+ * Limbs 3, 7 and 11 are always zero, so tables which are scanned in
+ * constant time store only the other nine.
+ */
+#define P521_PACKED_LIMBS 9
+typedef struct p521_packed_t {
+  uint64_t limb[P521_PACKED_LIMBS];
+} p521_packed_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -46,6 +56,18 @@ static __inline__ void
 p521_weak_reduce (
     p521_t *inout
 ) __attribute__((unused));
+
+static __inline__ void
+p521_pack (
+    p521_packed_t *out,
+    const p521_t *a
+) __attribute__((unused));
+
+static __inline__ void
+p521_unpack (
+    p521_t *out,
+    const p521_packed_t *a
+) __attribute__((unused));
              
 void
 p521_strong_reduce (
@@ -96,13 +118,18 @@ typedef uint64x4_t uint64x3_t; /* fit it in a vector register */
 
 static const uint64x3_t mask58 = { (1ull<<58) - 1, (1ull<<58) - 1, (1ull<<58) - 1, 0 };
 
-/* Currently requires CLANG.  Sorry. */
 static inline uint64x3_t
 __attribute__((unused))
 timesW (
   uint64x3_t u
 ) {
+#ifdef __clang__
   return u.zxyw + u.zwww;
+#else
+  /* GCC has no swizzles, but the same shuffles */
+  const uint64x4_t zxyw = { 2, 0, 1, 3 }, zwww = { 2, 3, 3, 3 };
+  return __builtin_shuffle(u, zxyw) + __builtin_shuffle(u, zwww);
+#endif
 }
 
 void
@@ -137,6 +164,33 @@ p521_copy (
     memcpy(out,a,sizeof(*a));
 }
 
+void
+p521_pack (
+    p521_packed_t *out,
+    const p521_t *a
+) {
+    unsigned int i;
+    for (i=0; i<3; i++) {
+        out->limb[3*i]   = a->limb[4*i];
+        out->limb[3*i+1] = a->limb[4*i+1];
+        out->limb[3*i+2] = a->limb[4*i+2];
+    }
+}
+
+void
+p521_unpack (
+    p521_t *out,
+    const p521_packed_t *a
+) {
+    unsigned int i;
+    for (i=0; i<3; i++) {
+        out->limb[4*i]   = a->limb[3*i];
+        out->limb[4*i+1] = a->limb[3*i+1];
+        out->limb[4*i+2] = a->limb[3*i+2];
+        out->limb[4*i+3] = 0;
+    }
+}
+
 void
 p521_bias (
     p521_t *a,
@@ -0,0 +1,61 @@
+/**
+ * @file decaf_curve.h
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Curve-specific names and constants for the Decaf group code:
+ * E-521.  See src/p448/decaf_curve.h.
+ */
+#ifndef __DECAF_CURVE_H__
+#define __DECAF_CURVE_H__ 1
+
+#include "decaf_521.h"
+#include "decaf_crypto_521.h"
+#include "decaf_521_config.h"
+
+/* Rename table, MSR ECC style */
+#define SCALAR_LIMBS DECAF_521_SCALAR_LIMBS
+#define SCALAR_BITS DECAF_521_SCALAR_BITS
+#define SCALAR_BYTES DECAF_521_SCALAR_BYTES
+#define NLIMBS DECAF_521_LIMBS
+#define SER_BYTES DECAF_521_SER_BYTES
+#define API_NS(_id) decaf_521_##_id
+#define API_NS2(_pref,_id) _pref##_decaf_521_##_id
+#define API_NAME "decaf_521"
+#define CURVE_NAME "E-521"
+#define gf_s gf_521_s
+#define gf gf_521
+#define scalar_t decaf_521_scalar_t
+#define point_t decaf_521_point_t
+#define point_s decaf_521_point_s
+#define precomputed_s decaf_521_precomputed_s
+#define precomputed_comb_s decaf_521_precomputed_comb_s
+#define precomputed_wnaf_s decaf_521_precomputed_wnaf_s
+
+/** The curve is x^2 + y^2 = 1 + d*x^2*y^2, with d = EDWARDS_D. */
+#define CURVE_EDWARDS_D (-376014)
+
+/** The prime order q of the group, in SC_LIMB words. */
+#define CURVE_SC_P \
+    SC_LIMB(0x40ea2435f5180d6b), \
+    SC_LIMB(0xfbd8c4569a8f1f45), \
+    SC_LIMB(0x36b8af5e7ec53f04), \
+    SC_LIMB(0x15b6c64746fc85f7), \
+    SC_LIMB(0xfffffffffffffffd), \
+    SC_LIMB(0xffffffffffffffff), \
+    SC_LIMB(0xffffffffffffffff), \
+    SC_LIMB(0xffffffffffffffff), \
+    SC_LIMB(0x000000000000007f)
+
+/** q in signed 62-bit limbs, and 1/q mod 2^62, for modinv62. */
+#define CURVE_SC_MODINV62 \
+    {{ 0x00ea2435f5180d6b, 0x2f63115a6a3c7d15, 0x2b8af5e7ec53f04f, 0x2db191d1bf217dcd, \
+       0x3ffffffffffffd15, 0x3fffffffffffffff, 0x3fffffffffffffff, 0x3fffffffffffffff, \
+       0x7fffff }}, \
+    0x3c5e9c2efd97b743
+
+/** The smallest s that decodes; decaf_gen_tables decodes it. */
+#define CURVE_BASE_POINT_SER 4
+
+#endif /* __DECAF_CURVE_H__ */
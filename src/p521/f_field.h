@@ -28,5 +28,14 @@
 #define field_strong_reduce  p521_strong_reduce
 #define field_serialize      p521_serialize
 #define field_deserialize    p521_deserialize
+#define field_backend_name   p521_backend_name
+
+#ifdef P521_PACKED_LIMBS
+/* Tables can store elements without the arch's padding limbs. */
+#define FIELD_PACKED_LIMBS   P521_PACKED_LIMBS
+#define field_packed_t       p521_packed_t
+#define field_pack           p521_pack
+#define field_unpack         p521_unpack
+#endif
 
 #endif /* __F_FIELD_H__ */
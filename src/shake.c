@@ -24,6 +24,10 @@
 #include <errno.h>
 #include <unistd.h>
 
+/* for parallel KangarooTwelve */
+#include <stdlib.h>
+#include <pthread.h>
+
 /* Subset of Mathias Panzenböck's portable endian code, public domain */
 #if defined(__linux__) || defined(__CYGWIN__)
 #	include <endian.h>
@@ -68,7 +72,7 @@ typedef struct keccak_sponge_s {
 
 #define INTERNAL_SPONGE_STRUCT 1
 #include "shake.h"
-#include "decaf.h"
+#include "decaf_common.h"
 
 #define FLAG_ABSORBING 'A'
 #define FLAG_SQUEEZING 'Z'
@@ -109,15 +113,12 @@ static inline uint64_t rol(uint64_t x, int s) {
 // #    define REPEAT24(e) {int _j=0; for (_j=0; _j<24; _j++) { e }}
 // #endif
 
-/*** The Keccak-f[1600] permutation ***/
+/*** The Keccak-f[1600] permutation, on lanes in native byte order ***/
 static void
 __attribute__((noinline))
-keccakf(kdomain_t state, uint8_t startRound) {
-    uint64_t* a = state->w;
+keccakf_native(uint64_t *a, uint8_t startRound) {
     uint64_t b[5] = {0}, t, u;
     uint8_t x, y, i;
-    
-    for (i=0; i<25; i++) a[i] = le64toh(a[i]);
 
     for (i = startRound; i < 24; i++) {
         FOR51(x, b[x] = 0; FOR55(y, b[x] ^= a[x + y];))
@@ -136,8 +137,23 @@ keccakf(kdomain_t state, uint8_t startRound) {
         // Iota
         a[0] ^= RC[i];
     }
+}
+
+static inline void state_to_native(kdomain_t state) {
+    int i;
+    for (i=0; i<25; i++) state->w[i] = le64toh(state->w[i]);
+}
 
-    for (i=0; i<25; i++) a[i] = htole64(a[i]);
+static inline void state_from_native(kdomain_t state) {
+    int i;
+    for (i=0; i<25; i++) state->w[i] = htole64(state->w[i]);
+}
+
+/*** The Keccak-f[1600] permutation, on the byte-oriented state ***/
+static void keccakf(kdomain_t state, uint8_t startRound) {
+    state_to_native(state);
+    keccakf_native(state->w, startRound);
+    state_from_native(state);
 }
 
 static inline void dokeccak (keccak_sponge_t sponge) {
@@ -145,6 +161,61 @@ static inline void dokeccak (keccak_sponge_t sponge) {
     sponge->params->position = 0;
 }
 
+/**
+ * Absorb whole blocks straight from the input as 64-bit lanes, keeping
+ * the state in native order until the last one.  Returns the number of
+ * bytes absorbed.
+ */
+static size_t absorb_blocks (
+    keccak_sponge_t sponge,
+    const uint8_t *in,
+    size_t len
+) {
+    const size_t rate = sponge->params->rate, words = rate/8;
+    uint64_t *a = sponge->state->w, w;
+    size_t done, i;
+
+    if (sponge->params->position || rate%8 || len < rate) return 0;
+
+    state_to_native(sponge->state);
+    for (done=0; len-done >= rate; done += rate) {
+        for (i=0; i<words; i++) {
+            memcpy(&w, &in[done+8*i], 8);
+            a[i] ^= le64toh(w);
+        }
+        keccakf_native(a, sponge->params->startRound);
+    }
+    state_from_native(sponge->state);
+    return done;
+}
+
+/**
+ * Squeeze whole blocks straight to the output; the inverse of absorb_blocks.
+ * Returns the number of bytes squeezed.
+ */
+static size_t squeeze_blocks (
+    keccak_sponge_t sponge,
+    uint8_t *out,
+    size_t len
+) {
+    const size_t rate = sponge->params->rate, words = rate/8;
+    uint64_t *a = sponge->state->w, w;
+    size_t done, i;
+
+    if (sponge->params->position || rate%8 || len < rate) return 0;
+
+    state_to_native(sponge->state);
+    for (done=0; len-done >= rate; done += rate) {
+        for (i=0; i<words; i++) {
+            w = htole64(a[i]);
+            memcpy(&out[done+8*i], &w, 8);
+        }
+        keccakf_native(a, sponge->params->startRound);
+    }
+    state_from_native(sponge->state);
+    return done;
+}
+
 void sha3_update (
     struct keccak_sponge_s * __restrict__ sponge,
     const uint8_t *in,
@@ -157,6 +228,12 @@ void sha3_update (
     while (len) {
         size_t cando = sponge->params->rate - sponge->params->position, i;
         uint8_t* state = &sponge->state->b[sponge->params->position];
+        size_t bulk = absorb_blocks(sponge, in, len);
+        if (bulk) {
+            len -= bulk;
+            in += bulk;
+            continue;
+        }
         if (cando > len) {
             for (i = 0; i < len; i += 1) state[i] ^= in[i];
             sponge->params->position += len;
@@ -200,6 +277,12 @@ void sha3_output (
     while (len) {
         size_t cando = sponge->params->rate - sponge->params->position;
         uint8_t* state = &sponge->state->b[sponge->params->position];
+        size_t bulk = squeeze_blocks(sponge, out, len);
+        if (bulk) {
+            len -= bulk;
+            out += bulk;
+            continue;
+        }
         if (cando > len) {
             memcpy(out, state, len);
             sponge->params->position += len;
@@ -253,6 +336,139 @@ void sponge_hash (
     sponge_destroy(sponge);
 }
 
+#if defined(__AVX2__)
+/*** Four interleaved Keccak-f[1600] permutations, one per 64-bit lane ***/
+typedef uint64_t keccak_x4_t __attribute__((vector_size(32)));
+
+static inline keccak_x4_t rol_x4(keccak_x4_t x, int s) {
+    return (x << s) | (x >> (64 - s));
+}
+
+static void
+__attribute__((noinline))
+keccakf_x4(keccak_x4_t a[25], uint8_t startRound) {
+    keccak_x4_t b[5], t, u;
+    uint8_t x, y, i;
+
+    for (i = startRound; i < 24; i++) {
+        FOR51(x, b[x] = a[x] ^ a[x + 5] ^ a[x + 10] ^ a[x + 15] ^ a[x + 20];)
+        FOR51(x, FOR55(y,
+            a[y + x] ^= b[(x + 4) % 5] ^ rol_x4(b[(x + 1) % 5], 1);
+        ))
+        // Rho and pi
+        t = a[1];
+        x = y = 0;
+        REPEAT24(u = a[pi[x]]; y += x+1; a[pi[x]] = rol_x4(t, y % 64); t = u; x++; )
+        // Chi
+        FOR55(y,
+             FOR51(x, b[x] = a[y + x];)
+             FOR51(x, a[y + x] = b[x] ^ ((~b[(x + 1) % 5]) & b[(x + 2) % 5]);)
+        )
+        // Iota
+        a[0] ^= (keccak_x4_t){RC[i],RC[i],RC[i],RC[i]};
+    }
+}
+
+/* XOR up to a rate's worth of bytes into one lane of the interleaved state. */
+static void xor_lane_x4(keccak_x4_t a[25], int lane, const uint8_t *in, size_t len) {
+    size_t i;
+    for (i=0; i+8 <= len; i+=8) {
+        uint64_t w;
+        memcpy(&w, &in[i], 8);
+        a[i/8][lane] ^= le64toh(w);
+    }
+    for (; i<len; i++) a[i/8][lane] ^= (uint64_t)in[i] << (8*(i%8));
+}
+
+static void get_lane_x4(uint8_t *out, const keccak_x4_t a[25], int lane, size_t len) {
+    size_t i;
+    for (i=0; i<len; i++) out[i] = a[i/8][lane] >> (8*(i%8));
+}
+
+void sponge_hash_x4 (
+    const uint8_t *const in[4],
+    const size_t inlen[4],
+    uint8_t *const out[4],
+    size_t outlen,
+    const struct kparams_s *params
+) {
+    const size_t rate = params->rate;
+    keccak_x4_t a[25];
+    size_t nabs[4], steps = 0, k;
+    int lane;
+
+    assert(params->flags == FLAG_ABSORBING && params->position == 0);
+    assert(params->maxOut == 0xFF || params->maxOut >= outlen);
+
+    /* Each lane absorbs inlen/rate+1 blocks (the last one padded), then squeezes */
+    for (lane=0; lane<4; lane++) {
+        size_t total;
+        nabs[lane] = inlen[lane]/rate + 1;
+        total = nabs[lane] + (outlen ? (outlen-1)/rate : 0);
+        if (total > steps) steps = total;
+    }
+
+    memset(a, 0, sizeof(a));
+    for (k=0; k<steps; k++) {
+        for (lane=0; lane<4; lane++) {
+            if (k+1 < nabs[lane]) {
+                xor_lane_x4(a, lane, &in[lane][k*rate], rate);
+            } else if (k+1 == nabs[lane]) {
+                size_t last = inlen[lane] - k*rate;
+                uint8_t pad[2] = { params->pad, params->ratePad };
+                xor_lane_x4(a, lane, &in[lane][k*rate], last);
+                a[last/8][lane] ^= (uint64_t)pad[0] << (8*(last%8));
+                a[(rate-1)/8][lane] ^= (uint64_t)pad[1] << (8*((rate-1)%8));
+            }
+        }
+        keccakf_x4(a, params->startRound);
+        for (lane=0; lane<4; lane++) {
+            size_t done;
+            if (k+1 < nabs[lane]) continue;
+            done = (k+1-nabs[lane]) * rate;
+            if (done >= outlen) continue;
+            get_lane_x4(&out[lane][done], a, lane,
+                (outlen-done < rate) ? outlen-done : rate);
+        }
+    }
+
+    sponge_bzero(a, sizeof(a));
+}
+
+#else /* !__AVX2__ */
+
+void sponge_hash_x4 (
+    const uint8_t *const in[4],
+    const size_t inlen[4],
+    uint8_t *const out[4],
+    size_t outlen,
+    const struct kparams_s *params
+) {
+    int lane;
+    for (lane=0; lane<4; lane++) {
+        sponge_hash(in[lane], inlen[lane], out[lane], outlen, params);
+    }
+}
+
+#endif /* __AVX2__ */
+
+void sponge_hash_many (
+    size_t n,
+    const uint8_t *const *in,
+    const size_t *inlen,
+    uint8_t *const *out,
+    size_t outlen,
+    const struct kparams_s *params
+) {
+    size_t i;
+    for (i=0; i+4 <= n; i+=4) {
+        sponge_hash_x4(&in[i], &inlen[i], &out[i], outlen, params);
+    }
+    for (; i<n; i++) {
+        sponge_hash(in[i], inlen[i], out[i], outlen, params);
+    }
+}
+
 #define DEFSHAKE(n) \
     const struct kparams_s SHAKE##n##_params_s = \
         { 0, FLAG_ABSORBING, 200-n/4, 0, 0x1f, 0x80, 0xFF, 0 };
@@ -276,6 +492,210 @@ DEFSHA3(256)
 DEFSHA3(384)
 DEFSHA3(512)
 
+/* TurboSHAKE is 12-round Keccak, with a domain byte in place of the pad. */
+#define DEFTURBOSHAKE(n) \
+    const struct kparams_s TurboSHAKE##n##_params_s = \
+        { 0, FLAG_ABSORBING, 200-n/4, 12, 0x1f, 0x80, 0xFF, 0 };
+
+DEFTURBOSHAKE(128)
+DEFTURBOSHAKE(256)
+
+void turboshake_init (
+    keccak_sponge_t sponge,
+    const struct kparams_s *params,
+    uint8_t domain
+) {
+    assert(domain >= 0x01 && domain <= 0x7F);
+    sponge_init(sponge, params);
+    sponge->params->pad = domain;
+}
+
+/*** KangarooTwelve ***/
+#define K12_CHUNK 8192
+#define K12_CV_BYTES 32
+#define K12_MAX_THREADS 64
+/** Leaves claimed by a worker at a time. */
+#define K12_GRAIN 16
+/** Don't bother with a thread for fewer leaves than this. */
+#define K12_LEAVES_PER_THREAD 32
+/** Leaves per chaining-value buffer, when hashing without threads. */
+#define K12_SEGMENT 64
+
+static const struct kparams_s K12_leaf_params_s =
+    { 0, FLAG_ABSORBING, 168, 12, 0x0b, 0x80, 0xFF, 0 };
+
+/* length_encode from the K12 spec: big-endian without leading zeros, then the length */
+static size_t k12_length_encode(uint8_t out[9], uint64_t x) {
+    unsigned int n, i;
+    for (n=0; n<8 && x>>(8*n); n++) {}
+    for (i=0; i<n; i++) out[i] = x >> (8*(n-1-i));
+    out[n] = n;
+    return n+1;
+}
+
+/* The K12 input string S = M || C || length_encode(|C|), never concatenated. */
+struct k12_string {
+    const uint8_t *part[3];
+    size_t len[3];
+};
+
+static size_t k12_string_len(const struct k12_string *s) {
+    return s->len[0] + s->len[1] + s->len[2];
+}
+
+/* Absorb S[off, off+len) */
+static void k12_absorb(
+    keccak_sponge_t sponge,
+    const struct k12_string *s,
+    size_t off,
+    size_t len
+) {
+    int i;
+    for (i=0; i<3 && len; i++) {
+        size_t cando;
+        if (off >= s->len[i]) { off -= s->len[i]; continue; }
+        cando = s->len[i] - off;
+        if (cando > len) cando = len;
+        sha3_update(sponge, &s->part[i][off], cando);
+        off = 0;
+        len -= cando;
+    }
+}
+
+/* Leaves [next,end) lie within the message, and their CVs go to cvs[leaf-first] */
+struct k12_job {
+    const uint8_t *msg;
+    uint8_t *cvs;
+    size_t first, next, end;
+};
+
+static void *k12_worker(void *arg) {
+    struct k12_job *job = (struct k12_job *)arg;
+    size_t i, j, stop;
+    while (1) {
+        i = __sync_fetch_and_add(&job->next, K12_GRAIN);
+        if (i >= job->end) break;
+        stop = (job->end - i < K12_GRAIN) ? job->end : i + K12_GRAIN;
+        for (; i+4 <= stop; i+=4) {
+            const uint8_t *in[4];
+            uint8_t *out[4];
+            const size_t inlen[4] = {K12_CHUNK, K12_CHUNK, K12_CHUNK, K12_CHUNK};
+            for (j=0; j<4; j++) {
+                in[j] = &job->msg[(i+j)*K12_CHUNK];
+                out[j] = &job->cvs[(i+j-job->first)*K12_CV_BYTES];
+            }
+            sponge_hash_x4(in, inlen, out, K12_CV_BYTES, &K12_leaf_params_s);
+        }
+        for (; i<stop; i++) {
+            sponge_hash(&job->msg[i*K12_CHUNK], K12_CHUNK,
+                &job->cvs[(i-job->first)*K12_CV_BYTES], K12_CV_BYTES, &K12_leaf_params_s);
+        }
+    }
+    return NULL;
+}
+
+/* Run the job on this thread and up to threads-1 others. */
+static void k12_run(struct k12_job *job, unsigned int threads) {
+    pthread_t tids[K12_MAX_THREADS];
+    unsigned int t, started = 0;
+    for (t=1; t<threads; t++) {
+        if (!pthread_create(&tids[started], NULL, k12_worker, job)) started++;
+    }
+    k12_worker(job);
+    for (t=0; t<started; t++) pthread_join(tids[t], NULL);
+}
+
+void k12_hash (
+    uint8_t *out,
+    size_t outlen,
+    const uint8_t *in,
+    size_t inlen,
+    const uint8_t *custom,
+    size_t customlen,
+    unsigned int threads
+) {
+    uint8_t enc[9], seg_cvs[K12_SEGMENT*K12_CV_BYTES], *cvs = seg_cvs;
+    struct k12_string s;
+    keccak_sponge_t final, leaf;
+    size_t total, nleaves, inner, i, seg, cap = K12_SEGMENT;
+
+    s.part[0] = in;     s.len[0] = inlen;
+    s.part[1] = custom; s.len[1] = customlen;
+    s.part[2] = enc;    s.len[2] = k12_length_encode(enc, customlen);
+    total = k12_string_len(&s);
+
+    if (total <= K12_CHUNK) {
+        turboshake_init(final, &TurboSHAKE128_params_s, 0x07);
+        k12_absorb(final, &s, 0, total);
+        sha3_output(final, out, outlen);
+        sponge_destroy(final);
+        return;
+    }
+
+    /* Final node: S_0 || 110^62 || CV_1 .. CV_{n-1} || length_encode(n-1) || FF FF */
+    nleaves = (total + K12_CHUNK - 1) / K12_CHUNK;
+    turboshake_init(final, &TurboSHAKE128_params_s, 0x06);
+    k12_absorb(final, &s, 0, K12_CHUNK);
+    {
+        const uint8_t marker[8] = {0x03,0,0,0,0,0,0,0};
+        sha3_update(final, marker, sizeof(marker));
+    }
+
+    /* Leaves that lie entirely in the message are hashed straight from it. */
+    inner = inlen / K12_CHUNK;
+    if (inner > nleaves) inner = nleaves;
+
+    if (threads == 0) {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (ncpu > 0) ? ncpu : 1;
+    }
+    if (threads > K12_MAX_THREADS) threads = K12_MAX_THREADS;
+    if (inner <= 1 || threads > (inner-1)/K12_LEAVES_PER_THREAD) {
+        threads = (inner > 1) ? (inner-1)/K12_LEAVES_PER_THREAD : 1;
+    }
+    if (threads > 1) {
+        /* One pass over all the leaves, if we can hold all the CVs. */
+        uint8_t *all = (uint8_t *)malloc((inner-1)*K12_CV_BYTES);
+        if (all) { cvs = all; cap = inner-1; }
+        else threads = 1;
+    }
+    if (threads < 1) threads = 1;
+
+    for (seg=1; seg<inner; seg+=cap) {
+        struct k12_job job;
+        job.msg = in;
+        job.cvs = cvs;
+        job.first = job.next = seg;
+        job.end = (inner-seg < cap) ? inner : seg+cap;
+        k12_run(&job, threads);
+        sha3_update(final, cvs, (job.end-seg)*K12_CV_BYTES);
+    }
+    if (cvs != seg_cvs) {
+        sponge_bzero(cvs, (inner-1)*K12_CV_BYTES);
+        free(cvs);
+    }
+
+    /* The rest straddle the message and customization string. */
+    for (i = (inner > 1) ? inner : 1; i<nleaves; i++) {
+        size_t len = (total - i*K12_CHUNK < K12_CHUNK) ? total - i*K12_CHUNK : K12_CHUNK;
+        sponge_init(leaf, &K12_leaf_params_s);
+        k12_absorb(leaf, &s, i*K12_CHUNK, len);
+        sha3_output(leaf, seg_cvs, K12_CV_BYTES);
+        sha3_update(final, seg_cvs, K12_CV_BYTES);
+    }
+    sponge_destroy(leaf);
+
+    {
+        uint8_t suffix[11];
+        size_t n = k12_length_encode(suffix, nleaves-1);
+        suffix[n++] = 0xFF;
+        suffix[n++] = 0xFF;
+        sha3_update(final, suffix, n);
+    }
+    sha3_output(final, out, outlen);
+    sponge_destroy(final);
+}
+
 /** Get entropy from a CPU, preferably in the form of RDRAND, but possibly instead from RDTSC. */
 static void get_cpu_entropy(uint8_t *entropy, size_t len) {
 # if (defined(__i386__) || defined(__x86_64__))
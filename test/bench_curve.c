@@ -0,0 +1,105 @@
+/**
+ * @cond internal
+ * @file bench_curve.c
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Curve-generic benchmarks of the Decaf group and crypto routines.
+ *
+ * Like test_curve.c, this uses the C API through decaf_curve.h, so that
+ * the same numbers come out for every curve.  To compare curves:
+ *     make clean; make curvebench
+ *     make clean; make curvebench FIELD=p521 ARCH=arch_x86_64_r12
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "decaf_curve.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Run op n times in a row until 0.5s have passed. */
+#define BENCH(name, n, op) do { \
+    unsigned long iters = 0, i_; \
+    double start_ = now(), elapsed_; \
+    do { \
+        for (i_=0; i_<(n); i_++) { op; } \
+        iters += (n); \
+        elapsed_ = now() - start_; \
+    } while (elapsed_ < 0.5); \
+    printf("%-24s %10.2f us %10.0f /s\n", name, \
+        elapsed_ * 1e6 / iters, iters / elapsed_); \
+} while (0)
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    API_NS(symmetric_key_t) proto1, proto2;
+    API_NS(private_key_t) s1, s2;
+    API_NS(public_key_t) p1, p2;
+    API_NS(signature_t) sig;
+    API_NS(scalar_t) x;
+    API_NS(point_t) p, q;
+    API_NS(precomputed_s) *pre;
+    unsigned char message[32], ss[32], ser[SER_BYTES], ser2[SER_BYTES];
+    volatile decaf_bool_t sink = 0;
+    unsigned int i;
+
+    for (i=0; i<sizeof(proto1); i++) {
+        proto1[i] = i;
+        proto2[i] = i * 7 + 1;
+    }
+    memset(message, 0x5a, sizeof(message));
+    API_NS(derive_private_key)(s1, proto1);
+    API_NS(derive_private_key)(s2, proto2);
+    API_NS(private_to_public)(p1, s1);
+    API_NS(private_to_public)(p2, s2);
+    API_NS(scalar_copy)(x, s1->secret_scalar);
+    API_NS(point_copy)(p, API_NS(point_base));
+    API_NS(point_copy)(q, API_NS(point_base));
+    if (posix_memalign((void **)&pre, API_NS2(alignof,precomputed_s), API_NS2(sizeof,precomputed_s)))
+        return 1;
+
+    printf("%s, field backend %s:\n", CURVE_NAME, API_NS(field_backend)());
+    printf("Point and table sizes: %d-byte points, %d-byte base table\n",
+        (int)SER_BYTES, (int)API_NS2(sizeof,precomputed_s));
+
+    printf("\nGroup:\n");
+    BENCH("Point add", 1000, API_NS(point_add)(p, p, q));
+    BENCH("Point encode", 100, API_NS(point_encode)(ser, p));
+    BENCH("Point decode", 100, sink ^= API_NS(point_decode)(q, ser, DECAF_FALSE));
+    BENCH("Scalarmul", 10, API_NS(point_scalarmul)(p, p, x));
+    BENCH("Scalarmul non-secret", 10, API_NS(point_scalarmul_non_secret)(p, p, x));
+    BENCH("Precomputed scalarmul", 10, API_NS(precomputed_scalarmul)(p, API_NS(precomputed_base), x));
+    BENCH("Double scalarmul", 10, API_NS(point_double_scalarmul)(q, p, x, q, x));
+    BENCH("Double scalarmul non-secret", 10, API_NS(point_double_scalarmul_non_secret)(q, p, x, q, x));
+    BENCH("Precompute table", 10, API_NS(precompute)(pre, p));
+    BENCH("Direct scalarmul", 10,
+        sink ^= API_NS(direct_scalarmul)(ser2, ser, x, DECAF_FALSE, DECAF_TRUE));
+
+    printf("\nCrypto:\n");
+    BENCH("Keygen", 10, {
+        API_NS(derive_private_key)(s2, proto2);
+        proto2[0]++;
+    });
+    BENCH("ECDH", 10, sink ^= API_NS(shared_secret)(ss, sizeof(ss), s1, p2));
+    BENCH("Sign", 10, {
+        API_NS(sign)(sig, s1, message, sizeof(message));
+        message[0]++;
+    });
+    BENCH("Verify", 10, {
+        sink ^= API_NS(verify)(sig, p1, message, sizeof(message));
+        message[1]++;
+    });
+
+    free(pre);
+    (void)sink;
+    return 0;
+}
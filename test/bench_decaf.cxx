@@ -12,7 +12,7 @@
 #include "decaf.hxx"
 #include "shake.hxx"
 #include "shake.h"
-#include "decaf_crypto.h"
+#include "decaf_crypto.hxx"
 #include <stdio.h>
 #include <sys/time.h>
 #include <assert.h>
@@ -24,6 +24,7 @@ using namespace decaf;
 typedef Ed448::Scalar Scalar;
 typedef Ed448::Point Point;
 typedef Ed448::Precomputed Precomputed;
+typedef Ed448::NonSecret NonSecret;
 
 
 static __inline__ void __attribute__((unused)) ignore_result ( int result ) { (void)result; }
@@ -73,11 +74,11 @@ class Benchmark {
     /* FIXME Tcy if get descheduled */
 public:
     int i, j, ntests, nsamples;
-    double begin;
+    double begin, per;
     uint64_t tsc_begin;
     std::vector<double> times;
     std::vector<uint64_t> cycles;
-    Benchmark(const char *s, double factor = 1) {
+    Benchmark(const char *s, double factor = 1, double per = 1) : per(per) {
         printf("%s:", s);
         if (strlen(s) < 25) printf("%*s",int(25-strlen(s)),"");
         fflush(stdout);
@@ -104,8 +105,8 @@ public:
         totalCy += tsc;
         totalS += t;
         
-        t /= ntests*(nsamples-2*DISCARD);
-        tsc /= ntests*(nsamples-2*DISCARD);
+        t /= ntests*(nsamples-2*DISCARD)*per;
+        tsc /= ntests*(nsamples-2*DISCARD)*per;
         
         printSI(t,"s");
         printf("    ");
@@ -277,9 +278,11 @@ static void spake2ee(
 }
 
 int main(int argc, char **argv) {
-    bool micro = false;
+    bool micro = false, combs = false;
     if (argc >= 2 && !strcmp(argv[1], "--micro"))
         micro = true;
+    if (argc >= 2 && !strcmp(argv[1], "--combs"))
+        combs = true;
     
     decaf_448_public_key_t p1,p2;
     decaf_448_private_key_t s1,s2;
@@ -293,6 +296,7 @@ int main(int argc, char **argv) {
     unsigned char umessage[] = {1,2,3,4,5};
     size_t lmessage = sizeof(umessage);
 
+    printf("Field backend: %s\n", decaf_448_field_backend());
 
     if (micro) {
         Precomputed pBase;
@@ -308,8 +312,36 @@ int main(int argc, char **argv) {
         Strobe strobe(Strobe::CLIENT);
         unsigned char b1024[1024] = {1};
         for (Benchmark b("SHAKE128 1kiB", 30); b.iter(); ) { shake1 += TmpBuffer(b1024,1024); }
+        {
+            std::vector<unsigned char> big(16<<20, 1);
+            for (Benchmark b("SHAKE128 64kiB", 0.5); b.iter(); ) {
+                shake1 += TmpBuffer(&big[0],64<<10);
+            }
+            for (Benchmark b("SHAKE128 16MiB", 0.05); b.iter(); ) {
+                shake1 += TmpBuffer(&big[0],big.size());
+            }
+            unsigned char k12out[32];
+            for (Benchmark b("K12 16MiB 1 thread", 0.05); b.iter(); ) {
+                k12_hash(k12out,sizeof(k12out),&big[0],big.size(),NULL,0,1);
+            }
+            for (Benchmark b("K12 16MiB all cores", 0.05); b.iter(); ) {
+                k12_hash(k12out,sizeof(k12out),&big[0],big.size(),NULL,0,0);
+            }
+        }
         for (Benchmark b("SHAKE256 1kiB", 30); b.iter(); ) { shake2 += TmpBuffer(b1024,1024); }
         for (Benchmark b("SHA3-512 1kiB", 30); b.iter(); ) { sha5 += TmpBuffer(b1024,1024); }
+        {
+            const uint8_t *ins[4] = {b1024, b1024+64, b1024+128, b1024+192};
+            const size_t lens[4] = {64,64,64,64};
+            unsigned char o[4][32];
+            uint8_t *outs[4] = {o[0],o[1],o[2],o[3]};
+            for (Benchmark b("SHAKE256 4x64B seq", 30); b.iter(); ) {
+                for (int k=0; k<4; k++) shake256_hash(outs[k],32,ins[k],lens[k]);
+            }
+            for (Benchmark b("SHAKE256 4x64B x4", 30); b.iter(); ) {
+                sponge_hash_x4(ins,lens,outs,32,&SHAKE256_params_s);
+            }
+        }
         strobe.key(TmpBuffer(b1024,1024));
         strobe.respec(STROBE_128);
         for (Benchmark b("STROBE128 1kiB", 10); b.iter(); ) {
@@ -333,7 +365,23 @@ int main(int argc, char **argv) {
         for (Benchmark b("Point add", 100); b.iter(); ) { p += q; }
         for (Benchmark b("Point double", 100); b.iter(); ) { p.double_in_place(); }
         for (Benchmark b("Point scalarmul"); b.iter(); ) { p * s; }
+        {
+            /* Variable time, so it needs a real scalar: s is zero */
+            Scalar r(rng);
+            for (Benchmark b("Point scalarmul non-secret"); b.iter(); ) { p * NonSecret(r); }
+        }
         for (Benchmark b("Point encode"); b.iter(); ) { ep = SecureBuffer(p); }
+        {
+            static decaf_448_point_t pts[64]; /* static: gf needs 32-byte alignment */
+            static unsigned char sers[64*Point::SER_BYTES];
+            for (int i=0; i<64; i++) decaf_448_point_copy(pts[i],Point(rng).p);
+            for (Benchmark b("Point dbl+encode 1 (inv)"); b.iter(); ) {
+                decaf_448_point_double_and_encode_batch(sers,pts,1);
+            }
+            for (Benchmark b("Point dbl+encode 64 (/pt)",0.5,64); b.iter(); ) {
+                decaf_448_point_double_and_encode_batch(sers,pts,64);
+            }
+        }
         for (Benchmark b("Point decode"); b.iter(); ) { p = Point(ep); }
         for (Benchmark b("Point create/destroy"); b.iter(); ) { Point r; }
         for (Benchmark b("Point hash nonuniform"); b.iter(); ) { Point::from_hash(ep); }
@@ -342,10 +390,66 @@ int main(int argc, char **argv) {
         for (Benchmark b("Point unhash uniform"); b.iter(); ) { ignore_result(p.invert_elligator(ep2,0)); }
         for (Benchmark b("Point steg"); b.iter(); ) { p.steg_encode(rng); }
         for (Benchmark b("Point double scalarmul"); b.iter(); ) { Point::double_scalarmul(p,s,q,t); }
+        {
+            Scalar r1(rng), r2(rng);
+            for (Benchmark b("Point double scalarmul non-secret"); b.iter(); ) {
+                Point::double_scalarmul_non_secret(p,r1,q,r2);
+            }
+        }
         for (Benchmark b("Point precmp scalarmul"); b.iter(); ) { pBase * s; }
+        {
+            const size_t sizes[] = {2,16,64,256,512,1024};
+            static decaf_448_point_t pts[1024]; /* static: gf needs 32-byte alignment */
+            static decaf_448_scalar_t scs[1024];
+            for (size_t i=0; i<1024; i++) {
+                Point r(rng); Scalar x(rng);
+                decaf_448_point_copy(pts[i],r.p);
+                decaf_448_scalar_copy(scs[i],x.s);
+            }
+            for (unsigned k=0; k<sizeof(sizes)/sizeof(sizes[0]); k++) {
+                char name[64];
+                snprintf(name,sizeof(name),"Point multiscalar %d (/pt)",(int)sizes[k]);
+                for (Benchmark b(name,std::max(0.05,8.0/sizes[k]),sizes[k]); b.iter(); ) {
+                    decaf_448_multiscalarmul_non_secret(p.p,pts,scs,sizes[k]);
+                }
+            }
+        }
         /* TODO: scalarmul for verif, etc */
     }
 
+    if (combs) {
+        /* Sweep comb shapes: memory vs. additions for fixed-base scalarmul */
+        const unsigned int params[][3] = {
+            {1,2,223}, {2,4,56}, {2,5,45}, {3,5,30}, {4,4,28}, {5,5,18},
+            {4,6,19}, {8,4,14}, {6,6,13}, {8,6,10}, {4,8,14}, {8,7,8}, {16,6,5}
+        };
+        SpongeRng rng(Block("comb-benchmarks"));
+        Point p(rng);
+        Scalar s(rng);
+        
+        printf("\nComb sweep (n,t,s; table size):\n");
+        for (unsigned k=0; k<sizeof(params)/sizeof(params[0]); k++) {
+            const unsigned int n = params[k][0], t = params[k][1], sp = params[k][2];
+            size_t size = decaf_448_sizeof_precomputed_comb(n,t,sp);
+            decaf_448_precomputed_comb_s *comb;
+            if (!size || posix_memalign((void**)&comb, decaf_448_alignof_precomputed_comb(), size)) continue;
+            
+            char name[64];
+            snprintf(name,sizeof(name),"Comb %u,%u,%u %dkB precmp",n,t,sp,(int)((size+1023)/1024));
+            for (Benchmark b(name,0.1); b.iter(); ) {
+                decaf_bool_t ret = decaf_448_precompute_comb(comb,n,t,sp,p.p);
+                ignore_result(ret);
+            }
+            snprintf(name,sizeof(name),"Comb %u,%u,%u %dkB mul",n,t,sp,(int)((size+1023)/1024));
+            for (Benchmark b(name); b.iter(); ) {
+                decaf_448_precomputed_comb_scalarmul(p.p,comb,s.s);
+            }
+            decaf_448_precomputed_comb_destroy(comb);
+            free(comb);
+        }
+        return 0;
+    }
+
     printf("\nMacro-benchmarks:\n");
     for (Benchmark b("Keygen"); b.iter(); ) {
         decaf_448_derive_private_key(s1,r1);
@@ -371,6 +475,50 @@ int main(int argc, char **argv) {
         umessage[1]^=umessage[0];
         ignore_result(ret);
     }
+    
+    {
+        PreparedPublicKey pk(Block(p1,sizeof(p1)));
+        for (Benchmark b("Verify prepared"); b.iter(); ) {
+            bool ret = pk.verify(Block(sig1,sizeof(sig1)),Block(umessage,lmessage));
+            umessage[0]++;
+            umessage[1]^=umessage[0];
+            ignore_result(ret);
+        }
+        
+        PublicKeyCache pkc(16);
+        for (Benchmark b("Verify cached"); b.iter(); ) {
+            bool ret = pkc.verify(Block(sig1,sizeof(sig1)),Block(p1,sizeof(p1)),Block(umessage,lmessage));
+            umessage[0]++;
+            umessage[1]^=umessage[0];
+            ignore_result(ret);
+        }
+    }
+
+    {
+        const size_t sizes[] = {64,1024};
+        std::vector<unsigned char> msgs(1024*sizeof(umessage));
+        std::vector<unsigned char> sigs(1024*sizeof(decaf_448_signature_t));
+        const size_t lsig = sizeof(decaf_448_signature_t);
+        for (size_t i=0; i<1024; i++) {
+            memcpy(&msgs[i*lmessage],umessage,lmessage);
+            msgs[i*lmessage] = i; msgs[i*lmessage+1] = i>>8;
+            decaf_448_sign(&sigs[i*lsig],s1,&msgs[i*lmessage],lmessage);
+        }
+        for (unsigned k=0; k<sizeof(sizes)/sizeof(sizes[0]); k++) {
+            SignatureBatch batch;
+            for (size_t i=0; i<sizes[k]; i++) {
+                batch.add(Block(&sigs[i*lsig],lsig), Block(p1,sizeof(p1)),
+                    Block(&msgs[i*lmessage],lmessage));
+            }
+            char name[64];
+            snprintf(name,sizeof(name),"Verify batch %d (/sig)",(int)sizes[k]);
+            for (Benchmark b(name,64.0/sizes[k],sizes[k]); b.iter(); ) {
+                bool ret = batch.verify();
+                ignore_result(ret);
+                assert(ret);
+            }
+        }
+    }
 
     printf("\nProtocol benchmarks:\n");
     SpongeRng clientRng(Block("client rng seed"));
@@ -0,0 +1,110 @@
+/**
+ * @cond internal
+ * @file bench_field.c
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Field arithmetic benchmarks for the selected ARCH.
+ *
+ * The field functions aren't exported from libdecaf, so this links the
+ * objects directly; test_field checks them.  The four-way AVX2 operations
+ * are timed per element.  To compare backends, run it under each one:
+ *     make clean; make fieldbench ARCH=arch_x86_64
+ *     make clean; make fieldbench ARCH=arch_x86_64_adx
+ * or, in a dispatch build, pick one with DECAF_FIELD_BACKEND:
+ *     make clean; make build/bench_field ARCH=arch_x86_64_dispatch
+ *     DECAF_FIELD_BACKEND=arch_ref64 ./build/bench_field
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <time.h>
+#include "field.h"
+#if FIELD_BITS == 448
+#include "p448_x4.h"
+#endif
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Run op, which does per operations, n times in a row until 0.2s have passed. */
+#define BENCH(name, n, per, op) do { \
+    unsigned long iters = 0, i_; \
+    double start_ = now(), elapsed_; \
+    do { \
+        for (i_=0; i_<(n); i_++) { op; } \
+        iters += (n); \
+        elapsed_ = now() - start_; \
+    } while (elapsed_ < 0.2); \
+    printf("%-24s %10.2f ns %10.2f M/s\n", name, \
+        elapsed_ * 1e9 / (iters * (per)), iters * (per) / elapsed_ * 1e-6); \
+} while (0)
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    field_a_t a, b, c, d, e, f;
+    uint8_t ser[FIELD_BITS/8];
+    unsigned int i;
+    volatile mask_t sink = 0;
+    ANALYZE_THIS_ROUTINE_CAREFULLY;
+
+    for (i=0; i<sizeof(ser); i++) ser[i] = (uint8_t)(i*37 + 11);
+    ser[sizeof(ser)-1] = 0x7f;
+    field_deserialize(a, ser);
+    for (i=0; i<sizeof(ser); i++) ser[i] = (uint8_t)(i*101 + 5);
+    ser[sizeof(ser)-1] = 0x3f;
+    field_deserialize(b, ser);
+
+    printf("Field arithmetic, p%d, %s:\n", FIELD_BITS, field_backend_name());
+
+    /* Dependency chains, so these are latencies rather than throughputs */
+    BENCH("mul", 10000, 2, { field_mul(c, a, b); field_mul(a, c, b); });
+    BENCH("sqr", 10000, 2, { field_sqr(c, a); field_sqr(a, c); });
+    BENCH("sqrn(37), per sqr", 1000, 74, { field_sqrn(c, a, 37); field_sqrn(a, c, 37); });
+    /* x' = x*b + x*y, rotating through a, c, d, e so no output aliases an input */
+    BENCH("mul_add", 10000, 4, {
+        field_mul_add(d, a, b, a, c); field_mul_add(e, d, b, d, a);
+        field_mul_add(c, e, b, e, d); field_mul_add(a, c, b, c, e);
+    });
+    BENCH("mul,mul,add", 10000, 4, {
+        field_mul(d, a, b); field_mul(f, a, c); field_add(d, d, f);
+        field_mul(e, d, b); field_mul(f, d, a); field_add(e, e, f);
+        field_mul(c, e, b); field_mul(f, e, d); field_add(c, c, f);
+        field_mul(a, c, b); field_mul(f, c, e); field_add(a, a, f);
+    });
+    BENCH("mulw", 10000, 2, { field_mulw(c, a, 39081); field_mulw(a, c, 39081); });
+    BENCH("add", 10000, 1, { field_add(a, a, b); });
+    BENCH("sub", 10000, 1, { field_sub(a, a, b); });
+    BENCH("add_nr+sub_nr", 10000, 1, { field_add_nr(c, a, b); field_subx_nr(a, c, b); });
+    BENCH("add+strong_reduce", 10000, 1, { field_add(a, a, b); field_strong_reduce(a); });
+    BENCH("serialize", 10000, 1, { field_serialize(ser, a); ser[0] ^= 1; });
+    BENCH("deserialize", 10000, 1, { sink ^= field_deserialize(a, ser); });
+    BENCH("isr", 100, 2, { field_isr(c, a); field_isr(a, c); });
+    BENCH("inverse", 100, 2, { field_inverse(c, a); field_inverse(a, c); });
+
+#if P448_X4
+    {
+        p448_t four[4];
+        p448_x4_t xa, xb, xc;
+        const mask_t sel[4] = { -1, 0, -1, 0 };
+        for (i=0; i<4; i++) field_mulw(&four[i], b, i+1);
+        p448_x4_load(&xa, four);
+        p448_x4_load(&xb, four);
+
+        printf("\nFour-way AVX2, per element:\n");
+        BENCH("x4 mul", 10000, 8, { p448_x4_mul(&xc, &xa, &xb); p448_x4_mul(&xa, &xc, &xb); });
+        BENCH("x4 sqr", 10000, 8, { p448_x4_sqr(&xc, &xa); p448_x4_sqr(&xa, &xc); });
+        BENCH("x4 add", 10000, 4, { p448_x4_add(&xa, &xa, &xb); });
+        BENCH("x4 sub", 10000, 4, { p448_x4_sub(&xa, &xa, &xb); });
+        BENCH("x4 cond_sel", 10000, 4, { p448_x4_cond_sel(&xa, &xa, &xb, sel); });
+        BENCH("x4 load+store", 10000, 4, { p448_x4_load(&xa, four); p448_x4_store(four, &xa); });
+    }
+#endif
+
+    (void)sink;
+    return 0;
+}
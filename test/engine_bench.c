@@ -0,0 +1,379 @@
+/**
+ * @cond internal
+ * @file engine_bench.c
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Load generator for the signing engine, over a Unix socket.
+ *
+ * Usage: engine_bench [--threads N] [--clients N] [--requests N] [--window N]
+ *                     [--verify PERCENT] [--batch N] [--queue N]
+ *
+ * Serves a decaf_448_engine on a Unix seqpacket socket in a temporary
+ * directory, then runs client threads which pipeline sign and verify
+ * requests through it.  Reports throughput, round-trip latency and the
+ * engine's own statistics, and fails if any answer is wrong.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "decaf_engine.h"
+
+#define MAX_MESSAGE 64
+#define NKEYS 16
+#define NVERIFY 64   /* Distinct pre-signed messages for verify requests */
+#define MAX_CLIENTS 64
+#define CHECK_EVERY 97 /* Check one in this many signatures locally */
+
+struct wire_request {
+    uint32_t id;
+    uint8_t op, key, message_len;
+    decaf_448_public_key_t pub;
+    decaf_448_signature_t sig;
+    unsigned char message[MAX_MESSAGE];
+};
+
+struct wire_response {
+    uint32_t id;
+    uint8_t result;
+    decaf_448_signature_t sig;
+};
+
+/* A request in flight on the server side. */
+struct server_req {
+    decaf_448_engine_request_s req;
+    int fd;
+    struct wire_request w;
+    decaf_448_signature_t sig;
+};
+
+static decaf_448_private_key_t privs[NKEYS];
+static decaf_448_public_key_t pubs[NKEYS];
+static decaf_448_signature_t verify_sigs[NVERIFY];
+static unsigned char verify_msgs[NVERIFY][MAX_MESSAGE];
+static decaf_bool_t verify_expect[NVERIFY];
+
+static struct {
+    unsigned int threads, clients, requests, window, verify_pct, batch, queue;
+} opts = { 0, 4, 1000, 16, 50, 0, 4096 };
+
+static decaf_448_engine_s *engine;
+static char sock_path[96]; /* Fits in sun_path */
+static unsigned int errors;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void make_message(unsigned char *msg, uint32_t id, unsigned int salt) {
+    unsigned int i;
+    for (i=0; i<MAX_MESSAGE; i++) msg[i] = (unsigned char)(id*131 + i*7 + salt);
+}
+
+/* Server side */
+
+static void server_done(decaf_448_engine_request_s *req) {
+    struct server_req *sr = (struct server_req *)req->user;
+    struct wire_response resp;
+    memset(&resp, 0, sizeof(resp));
+    resp.id = sr->w.id;
+    resp.result = !!req->result;
+    if (sr->w.op == DECAF_448_ENGINE_SIGN) memcpy(resp.sig, sr->sig, sizeof(resp.sig));
+    if (send(sr->fd, &resp, sizeof(resp), MSG_NOSIGNAL) != sizeof(resp)) {
+        __sync_fetch_and_add(&errors, 1);
+    }
+    free(sr);
+}
+
+static void *server_conn(void *arg) {
+    int fd = (int)(intptr_t)arg;
+    for (;;) {
+        struct server_req *sr = (struct server_req *)malloc(sizeof(*sr));
+        if (!sr) break;
+        ssize_t got = recv(fd, &sr->w, sizeof(sr->w), 0);
+        if (got != sizeof(sr->w)) {
+            free(sr);
+            if (got < 0 && errno == EINTR) continue;
+            break;
+        }
+        memset(&sr->req, 0, sizeof(sr->req));
+        sr->fd = fd;
+        sr->req.op = (decaf_448_engine_op_t)sr->w.op;
+        sr->req.priv = privs[sr->w.key % NKEYS];
+        sr->req.pub = sr->w.pub;
+        sr->req.message = sr->w.message;
+        sr->req.message_len = sr->w.message_len;
+        sr->req.sig = (sr->w.op == DECAF_448_ENGINE_SIGN) ? sr->sig : sr->w.sig;
+        sr->req.callback = server_done;
+        sr->req.user = sr;
+        while (!decaf_448_engine_submit(engine, &sr->req)) sched_yield();
+    }
+    close(fd);
+    return NULL;
+}
+
+static void *server_accept(void *arg) {
+    int lfd = (int)(intptr_t)arg;
+    pthread_t conns[MAX_CLIENTS];
+    unsigned int i, n = 0;
+    while (n < opts.clients) {
+        int fd = accept(lfd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (pthread_create(&conns[n], NULL, server_conn, (void *)(intptr_t)fd)) {
+            close(fd);
+            break;
+        }
+        n++;
+    }
+    for (i=0; i<n; i++) pthread_join(conns[i], NULL);
+    return NULL;
+}
+
+/* Client side */
+
+struct client {
+    unsigned int index;
+    uint64_t *rtt;
+    uint64_t *sent_ns;
+};
+
+static void *client_run(void *arg) {
+    struct client *c = (struct client *)arg;
+    struct sockaddr_un addr;
+    struct wire_request w;
+    struct wire_response resp;
+    unsigned int sent = 0, received = 0;
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, sock_path, sizeof(sock_path));
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+        fprintf(stderr, "client %u: can't connect: %s\n", c->index, strerror(errno));
+        __sync_fetch_and_add(&errors, 1);
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+
+    while (received < opts.requests) {
+        while (sent < opts.requests && sent - received < opts.window) {
+            uint32_t id = sent;
+            memset(&w, 0, sizeof(w));
+            w.id = id;
+            w.message_len = MAX_MESSAGE;
+            if ((id*37 + c->index) % 100 < opts.verify_pct) {
+                unsigned int k = (id + c->index) % NVERIFY;
+                w.op = DECAF_448_ENGINE_VERIFY;
+                memcpy(w.pub, pubs[k % NKEYS], sizeof(w.pub));
+                memcpy(w.sig, verify_sigs[k], sizeof(w.sig));
+                memcpy(w.message, verify_msgs[k], MAX_MESSAGE);
+            } else {
+                w.op = DECAF_448_ENGINE_SIGN;
+                w.key = (id + c->index) % NKEYS;
+                make_message(w.message, id, c->index);
+            }
+            c->sent_ns[id] = now_ns();
+            if (send(fd, &w, sizeof(w), MSG_NOSIGNAL) != sizeof(w)) goto fail;
+            sent++;
+        }
+
+        if (recv(fd, &resp, sizeof(resp), 0) != sizeof(resp) || resp.id >= sent) goto fail;
+        c->rtt[received++] = now_ns() - c->sent_ns[resp.id];
+
+        /* Check the answer */
+        uint32_t id = resp.id;
+        if ((id*37 + c->index) % 100 < opts.verify_pct) {
+            unsigned int k = (id + c->index) % NVERIFY;
+            if (!resp.result != !verify_expect[k]) __sync_fetch_and_add(&errors, 1);
+        } else if (!resp.result) {
+            __sync_fetch_and_add(&errors, 1);
+        } else if (id % CHECK_EVERY == 0) {
+            unsigned char msg[MAX_MESSAGE];
+            make_message(msg, id, c->index);
+            if (!decaf_448_verify(resp.sig, pubs[(id + c->index) % NKEYS], msg, MAX_MESSAGE)) {
+                __sync_fetch_and_add(&errors, 1);
+            }
+        }
+    }
+    close(fd);
+    return NULL;
+
+fail:
+    fprintf(stderr, "client %u: connection failed after %u responses\n", c->index, received);
+    __sync_fetch_and_add(&errors, 1);
+    close(fd);
+    return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void print_histogram(const char *name, const uint64_t *hist) {
+    unsigned int k;
+    printf("  %s latency:\n", name);
+    for (k=0; k<DECAF_448_ENGINE_LATENCY_BUCKETS; k++) {
+        if (!hist[k]) continue;
+        if (k == 0) printf("    %10s us: %llu\n", "<2", (unsigned long long)hist[k]);
+        else printf("    %10llu us: %llu\n", 1ull<<k, (unsigned long long)hist[k]);
+    }
+}
+
+static unsigned int parse_opt(const char *name, const char *val) {
+    char *end;
+    unsigned long v;
+    if (!val) {
+        fprintf(stderr, "engine_bench: %s needs a value\n", name);
+        exit(2);
+    }
+    v = strtoul(val, &end, 10);
+    if (*end || !*val) {
+        fprintf(stderr, "engine_bench: bad value for %s: %s\n", name, val);
+        exit(2);
+    }
+    return (unsigned int)v;
+}
+
+int main(int argc, char **argv) {
+    int i;
+    unsigned int j;
+    for (i=1; i<argc; i++) {
+        const char *a = argv[i], *v = (i+1 < argc) ? argv[i+1] : NULL;
+        if      (!strcmp(a, "--threads"))  opts.threads    = parse_opt(a, v);
+        else if (!strcmp(a, "--clients"))  opts.clients    = parse_opt(a, v);
+        else if (!strcmp(a, "--requests")) opts.requests   = parse_opt(a, v);
+        else if (!strcmp(a, "--window"))   opts.window     = parse_opt(a, v);
+        else if (!strcmp(a, "--verify"))   opts.verify_pct = parse_opt(a, v);
+        else if (!strcmp(a, "--batch"))    opts.batch      = parse_opt(a, v);
+        else if (!strcmp(a, "--queue"))    opts.queue      = parse_opt(a, v);
+        else {
+            fprintf(stderr, "Usage: %s [--threads N] [--clients N] [--requests N] [--window N]\n"
+                "       [--verify PERCENT] [--batch N] [--queue N]\n", argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (opts.clients < 1 || opts.clients > MAX_CLIENTS || opts.window < 1 || opts.requests < 1) {
+        fprintf(stderr, "engine_bench: need 1..%d clients, and a nonzero window and request count\n",
+            MAX_CLIENTS);
+        return 2;
+    }
+
+    /* Keys and pre-signed messages, one in eight of them corrupted */
+    for (j=0; j<NKEYS; j++) {
+        decaf_448_symmetric_key_t proto;
+        memset(proto, j+1, sizeof(proto));
+        decaf_448_derive_private_key(privs[j], proto);
+        decaf_448_private_to_public(pubs[j], privs[j]);
+    }
+    for (j=0; j<NVERIFY; j++) {
+        make_message(verify_msgs[j], j, 0xFF);
+        decaf_448_sign(verify_sigs[j], privs[j % NKEYS], verify_msgs[j], MAX_MESSAGE);
+        verify_expect[j] = (j % 8 != 7);
+        if (!verify_expect[j]) verify_sigs[j][DECAF_448_SER_BYTES] ^= 1;
+    }
+
+    /* Server */
+    char dir[] = "/tmp/decaf_engine_XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(sock_path, sizeof(sock_path), "%s/sock", dir);
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, sock_path, sizeof(sock_path));
+    int lfd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if (lfd < 0 || bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) || listen(lfd, opts.clients)) {
+        perror("engine_bench: socket");
+        rmdir(dir);
+        return 1;
+    }
+
+    engine = decaf_448_engine_create(opts.threads, opts.queue, opts.batch);
+    if (!engine) {
+        fprintf(stderr, "engine_bench: can't start engine\n");
+        return 1;
+    }
+
+    pthread_t acceptor, clients[MAX_CLIENTS];
+    struct client cs[MAX_CLIENTS];
+    if (pthread_create(&acceptor, NULL, server_accept, (void *)(intptr_t)lfd)) {
+        fprintf(stderr, "engine_bench: can't start server\n");
+        return 1;
+    }
+
+    /* Load */
+    uint64_t begin = now_ns();
+    for (j=0; j<opts.clients; j++) {
+        cs[j].index = j;
+        cs[j].rtt = (uint64_t *)calloc(opts.requests, sizeof(uint64_t));
+        cs[j].sent_ns = (uint64_t *)calloc(opts.requests, sizeof(uint64_t));
+        if (!cs[j].rtt || !cs[j].sent_ns || pthread_create(&clients[j], NULL, client_run, &cs[j])) {
+            fprintf(stderr, "engine_bench: can't start client %u\n", j);
+            return 1;
+        }
+    }
+    for (j=0; j<opts.clients; j++) pthread_join(clients[j], NULL);
+    double elapsed = (now_ns() - begin) * 1e-9;
+
+    pthread_join(acceptor, NULL);
+    close(lfd);
+    unlink(sock_path);
+    rmdir(dir);
+
+    /* Report */
+    size_t total = (size_t)opts.clients * opts.requests, k;
+    uint64_t *all = (uint64_t *)malloc(total * sizeof(uint64_t));
+    if (!all) return 1;
+    for (j=0, k=0; j<opts.clients; j++) {
+        memcpy(&all[k], cs[j].rtt, opts.requests * sizeof(uint64_t));
+        k += opts.requests;
+        free(cs[j].rtt);
+        free(cs[j].sent_ns);
+    }
+    qsort(all, total, sizeof(uint64_t), cmp_u64);
+
+    decaf_448_engine_stats_s stats;
+    decaf_448_engine_stats(engine, &stats);
+    decaf_448_engine_destroy(engine);
+
+    printf("%u clients x %u requests, window %u, %u%% verify\n",
+        opts.clients, opts.requests, opts.window, opts.verify_pct);
+    printf("  throughput: %.0f requests/s\n", total / elapsed);
+    printf("  round trip: p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us\n",
+        all[total/2] * 1e-3, all[total*9/10] * 1e-3, all[total*99/100] * 1e-3, all[total-1] * 1e-3);
+    printf("  engine: %llu completed, %llu rejected, %llu batches (%.1f avg), max queue depth %llu\n",
+        (unsigned long long)stats.completed, (unsigned long long)stats.rejected,
+        (unsigned long long)stats.batches,
+        stats.batches ? (double)stats.completed / stats.batches : 0.0,
+        (unsigned long long)stats.max_queue_depth);
+    print_histogram("sign", stats.latency[DECAF_448_ENGINE_SIGN]);
+    print_histogram("verify", stats.latency[DECAF_448_ENGINE_VERIFY]);
+    free(all);
+
+    if (errors) {
+        printf("FAILED: %u wrong or missing answers\n", errors);
+        return 1;
+    }
+    return 0;
+}
@@ -6,58 +6,354 @@
  *   Released under the MIT License.  See LICENSE.txt for license information.
  * @author Mike Hamburg
  * @brief SHA3 utility, to be combined with test vectors eventually...
+ *
+ * Usage: shakesum [--algo ALGO | ALGO] [--length BYTES] [--jobs N] [--check] [FILE...]
+ *
+ * With no files, hashes stdin and prints just the hash.  Otherwise prints
+ * sha*sum-style lines.  Files are hashed concurrently, large ones via mmap.
+ * With --check, each FILE holds lines of that form, which are verified.
  */
 
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include "shake.h"
 
-int main(int argc, char **argv) {
-    (void)argc; (void)argv;
+/** Files at least this big are mapped instead of read. */
+#define MMAP_THRESHOLD (1<<20)
+/** Read buffer size, for pipes and small files. */
+#define READ_BUFFER (1<<20)
+#define READ_ALIGN 4096
+#define MAX_JOBS 64
+
+struct algo {
+    const char *name;
+    const struct kparams_s *params; /* NULL for KangarooTwelve */
+    unsigned int outlen;
+    int xof;
+};
+
+static const struct algo algos[] = {
+    { "shake256",      &SHAKE256_params_s,      512,    1 },
+    { "shake128",      &SHAKE128_params_s,      512,    1 },
+    { "sha3-224",      &SHA3_224_params_s,      224/8,  0 },
+    { "sha3-256",      &SHA3_256_params_s,      256/8,  0 },
+    { "sha3-384",      &SHA3_384_params_s,      384/8,  0 },
+    { "sha3-512",      &SHA3_512_params_s,      512/8,  0 },
+    { "turboshake128", &TurboSHAKE128_params_s, 512,    1 },
+    { "turboshake256", &TurboSHAKE256_params_s, 512,    1 },
+    { "k12",           NULL,                    512,    1 }
+};
+
+/* One file to hash, and eventually its result. */
+struct job {
+    const char *name;
+    unsigned char *out;
+    int err, done;
+    const char *expect; /* for --check */
+};
+
+static struct {
+    const struct algo *algo;
+    unsigned int outlen;
+    struct job *jobs;
+    size_t njobs, next;
+    unsigned int k12_threads;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} ctx = { NULL, 0, NULL, 0, 0, 1, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+static const struct algo *find_algo(const char *name) {
+    unsigned int i;
+    if (!strcmp(name, "--k12")) name = "k12";
+    for (i=0; i<sizeof(algos)/sizeof(algos[0]); i++) {
+        if (!strcasecmp(name, algos[i].name)) return &algos[i];
+    }
+    return NULL;
+}
 
+/* Read all of fd, through an aligned buffer.  KangarooTwelve needs it all at once. */
+static int hash_fd(int fd, unsigned char *out, unsigned char *buf) {
     keccak_sponge_t sponge;
-    unsigned char buf[1024];
-    
-    unsigned int outlen = 512;
-    shake256_init(sponge);
-
-    /* Sloppy.  Real utility would parse --algo, --size ... */
-    if (argc > 1) {
-        if (!strcmp(argv[1], "shake256") || !strcmp(argv[1], "SHAKE256")) {
-            outlen = 512;
-            shake256_init(sponge);
-        } else if (!strcmp(argv[1], "shake128") || !strcmp(argv[1], "SHAKE128")) {
-            outlen = 512;
-            shake128_init(sponge);
-        } else if (!strcmp(argv[1], "sha3-224") || !strcmp(argv[1], "SHA3-224")) {
-            outlen = 224/8;
-            sha3_224_init(sponge);
-        } else if (!strcmp(argv[1], "sha3-256") || !strcmp(argv[1], "SHA3-256")) {
-            outlen = 256/8;
-            sha3_256_init(sponge);
-        } else if (!strcmp(argv[1], "sha3-384") || !strcmp(argv[1], "SHA3-384")) {
-            outlen = 384/8;
-            sha3_384_init(sponge);
-        } else if (!strcmp(argv[1], "sha3-512") || !strcmp(argv[1], "SHA3-512")) {
-            outlen = 512/8;
-            sha3_512_init(sponge);
+    size_t size = READ_BUFFER, len = 0;
+    unsigned char *all = NULL;
+    ssize_t red;
+
+    if (ctx.algo->params) sponge_init(sponge, ctx.algo->params);
+    while (1) {
+        unsigned char *dst = buf;
+        size_t room = READ_BUFFER;
+        if (!ctx.algo->params) {
+            if (!all || len == size) {
+                unsigned char *bigger = realloc(all, size = all ? 2*size : size);
+                if (!bigger) { free(all); return ENOMEM; }
+                all = bigger;
+            }
+            dst = all+len;
+            room = size-len;
         }
+        red = read(fd, dst, room);
+        if (red < 0 && errno == EINTR) continue;
+        if (red <= 0) break;
+        if (ctx.algo->params) sha3_update(sponge, buf, red);
+        else len += red;
+    }
+    if (red < 0) {
+        int err = errno;
+        free(all);
+        if (ctx.algo->params) sponge_destroy(sponge);
+        return err;
     }
 
-    ssize_t red;
-    do {
-        red = read(0, buf, sizeof(buf));
-        if (red>0) sha3_update(sponge,buf,red);
-    } while (red>0);
-
-    sha3_output(sponge,buf,outlen);
-    sponge_destroy(sponge);
-    unsigned i;
+    if (ctx.algo->params) {
+        sha3_output(sponge, out, ctx.outlen);
+        sponge_destroy(sponge);
+    } else {
+        k12_hash(out, ctx.outlen, all, len, NULL, 0, ctx.k12_threads);
+        free(all);
+    }
+    return 0;
+}
+
+static int hash_file(const char *name, unsigned char *out, unsigned char *buf) {
+    struct stat st;
+    int fd, err = 0;
+
+    if (!strcmp(name, "-")) return hash_fd(0, out, buf);
+
+    fd = open(name, O_RDONLY);
+    if (fd < 0) return errno;
+    if (fstat(fd, &st)) {
+        err = errno;
+    } else if (S_ISDIR(st.st_mode)) {
+        err = EISDIR;
+    } else if (S_ISREG(st.st_mode) && st.st_size >= MMAP_THRESHOLD) {
+        void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            err = hash_fd(fd, out, buf);
+        } else {
+            posix_madvise(map, st.st_size, POSIX_MADV_SEQUENTIAL);
+            if (ctx.algo->params) {
+                sponge_hash(map, st.st_size, out, ctx.outlen, ctx.algo->params);
+            } else {
+                k12_hash(out, ctx.outlen, map, st.st_size, NULL, 0, ctx.k12_threads);
+            }
+            munmap(map, st.st_size);
+        }
+    } else {
+        err = hash_fd(fd, out, buf);
+    }
+    close(fd);
+    return err;
+}
+
+static void *worker(void *arg) {
+    unsigned char *buf = NULL;
+    size_t i;
+    (void)arg;
+
+    if (posix_memalign((void **)&buf, READ_ALIGN, READ_BUFFER)) buf = NULL;
+    while (1) {
+        int err;
+        pthread_mutex_lock(&ctx.lock);
+        i = ctx.next++;
+        pthread_mutex_unlock(&ctx.lock);
+        if (i >= ctx.njobs) break;
+
+        err = buf ? hash_file(ctx.jobs[i].name, ctx.jobs[i].out, buf) : ENOMEM;
+
+        pthread_mutex_lock(&ctx.lock);
+        ctx.jobs[i].err = err;
+        ctx.jobs[i].done = 1;
+        pthread_cond_broadcast(&ctx.cond);
+        pthread_mutex_unlock(&ctx.lock);
+    }
+    free(buf);
+    return NULL;
+}
+
+static void print_hex(const unsigned char *out, unsigned int outlen) {
+    unsigned int i;
+    for (i=0; i<outlen; i++) printf("%02x", out[i]);
+}
+
+/* Compare a hash against its expected hex, case-insensitively. */
+static int hex_matches(const unsigned char *out, unsigned int outlen, const char *hex) {
+    unsigned int i;
+    char mine[3];
+    if (strlen(hex) != 2*outlen) return 0;
     for (i=0; i<outlen; i++) {
-        printf("%02x", buf[i]);
+        snprintf(mine, sizeof(mine), "%02x", out[i]);
+        if (strncasecmp(mine, &hex[2*i], 2)) return 0;
     }
-    printf("\n");
+    return 1;
+}
+
+/* Parse "HEX  NAME" or "HEX *NAME" lines into jobs. */
+static int read_check_file(const char *file, struct job **jobs, size_t *njobs, size_t *cap) {
+    FILE *f = strcmp(file, "-") ? fopen(file, "r") : stdin;
+    char *line = NULL;
+    size_t linecap = 0;
+    ssize_t len;
 
+    if (!f) {
+        fprintf(stderr, "shakesum: %s: %s\n", file, strerror(errno));
+        return -1;
+    }
+    while ((len = getline(&line, &linecap, f)) > 0) {
+        char *sp;
+        while (len && (line[len-1] == '\n' || line[len-1] == '\r')) line[--len] = 0;
+        sp = strchr(line, ' ');
+        if (!sp || !sp[1] || (sp[1] != ' ' && sp[1] != '*') || !sp[2]) {
+            if (len) fprintf(stderr, "shakesum: %s: improperly formatted line\n", file);
+            continue;
+        }
+        *sp = 0;
+        if (*njobs == *cap) {
+            struct job *bigger = realloc(*jobs, (*cap = 2*(*cap)+16) * sizeof(**jobs));
+            if (!bigger) { free(line); return -1; }
+            *jobs = bigger;
+        }
+        memset(&(*jobs)[*njobs], 0, sizeof(**jobs));
+        (*jobs)[*njobs].expect = strdup(line);
+        (*jobs)[*njobs].name = strdup(sp+2);
+        (*njobs)++;
+    }
+    free(line);
+    if (f != stdin) fclose(f);
     return 0;
 }
+
+static void usage(void) {
+    unsigned int i;
+    fprintf(stderr, "usage: shakesum [--algo ALGO | ALGO] [--length BYTES] [--jobs N] [--check] [FILE...]\n");
+    fprintf(stderr, "algorithms:");
+    for (i=0; i<sizeof(algos)/sizeof(algos[0]); i++) fprintf(stderr, " %s", algos[i].name);
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv) {
+    const char **files = calloc(argc, sizeof(*files));
+    size_t nfiles = 0, cap = 0, i;
+    long length = -1, njobs = 0;
+    int check = 0, bare = 0, status = 0, a;
+    pthread_t tids[MAX_JOBS];
+    unsigned int nthreads, started = 0, t;
+
+    if (!files) return 1;
+    ctx.algo = &algos[0];
+
+    for (a=1; a<argc; a++) {
+        const struct algo *found;
+        if (!strcmp(argv[a], "--algo") && a+1 < argc) {
+            if (!(ctx.algo = find_algo(argv[++a]))) { usage(); return 1; }
+        } else if (!strcmp(argv[a], "--length") && a+1 < argc) {
+            length = strtol(argv[++a], NULL, 0);
+        } else if (!strcmp(argv[a], "--jobs") && a+1 < argc) {
+            njobs = strtol(argv[++a], NULL, 0);
+        } else if (!strcmp(argv[a], "--check") || !strcmp(argv[a], "-c")) {
+            check = 1;
+        } else if (!strcmp(argv[a], "--help") || !strcmp(argv[a], "-h")) {
+            usage();
+            return 0;
+        } else if (!strcmp(argv[a], "--")) {
+            for (a++; a<argc; a++) files[nfiles++] = argv[a];
+        } else if (a == 1 && (found = find_algo(argv[a]))) {
+            /* Old style: the algorithm is the first argument */
+            ctx.algo = found;
+        } else if (argv[a][0] == '-' && argv[a][1]) {
+            usage();
+            return 1;
+        } else {
+            files[nfiles++] = argv[a];
+        }
+    }
+
+    ctx.outlen = ctx.algo->outlen;
+    if (length >= 0) {
+        if (length == 0 || (!ctx.algo->xof && length > (long)ctx.algo->outlen) || length > 1<<20) {
+            fprintf(stderr, "shakesum: bad length %ld for %s\n", length, ctx.algo->name);
+            return 1;
+        }
+        ctx.outlen = length;
+    }
+    if (!nfiles) {
+        files[nfiles++] = "-";
+        bare = !check;
+    }
+
+    if (check) {
+        for (i=0; i<nfiles; i++) {
+            if (read_check_file(files[i], &ctx.jobs, &ctx.njobs, &cap)) status = 1;
+        }
+        /* Without --length, the expected hashes set the output length */
+        if (ctx.njobs && length < 0) {
+            size_t hexlen = strlen(ctx.jobs[0].expect);
+            if (ctx.algo->xof && hexlen && hexlen%2 == 0) ctx.outlen = hexlen/2;
+        }
+    } else {
+        ctx.njobs = nfiles;
+        ctx.jobs = calloc(nfiles, sizeof(*ctx.jobs));
+        if (!ctx.jobs) return 1;
+        for (i=0; i<nfiles; i++) ctx.jobs[i].name = files[i];
+    }
+    for (i=0; i<ctx.njobs; i++) {
+        if (!(ctx.jobs[i].out = malloc(ctx.outlen))) return 1;
+    }
+
+    if (njobs <= 0) {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        njobs = (ncpu > 0) ? ncpu : 1;
+    }
+    nthreads = (njobs > MAX_JOBS) ? MAX_JOBS : njobs;
+    if (nthreads > ctx.njobs) nthreads = ctx.njobs;
+    /* A lone file gets all the cores for KangarooTwelve's leaves instead */
+    ctx.k12_threads = (ctx.njobs == 1) ? (unsigned int)njobs : 1;
+    for (t=0; t<nthreads; t++) {
+        if (!pthread_create(&tids[started], NULL, worker, NULL)) started++;
+    }
+    if (!started && ctx.njobs) worker(NULL);
+
+    /* Report in order, as results come in */
+    for (i=0; i<ctx.njobs; i++) {
+        struct job *job = &ctx.jobs[i];
+        pthread_mutex_lock(&ctx.lock);
+        while (!job->done) pthread_cond_wait(&ctx.cond, &ctx.lock);
+        pthread_mutex_unlock(&ctx.lock);
+
+        if (job->err) {
+            fprintf(stderr, "shakesum: %s: %s\n", job->name, strerror(job->err));
+            if (check) printf("%s: FAILED open or read\n", job->name);
+            status = 1;
+        } else if (check) {
+            int ok = hex_matches(job->out, ctx.outlen, job->expect);
+            printf("%s: %s\n", job->name, ok ? "OK" : "FAILED");
+            if (!ok) status = 1;
+        } else {
+            print_hex(job->out, ctx.outlen);
+            if (bare) printf("\n");
+            else printf("  %s\n", job->name);
+        }
+    }
+
+    for (t=0; t<started; t++) pthread_join(tids[t], NULL);
+    for (i=0; i<ctx.njobs; i++) {
+        free(ctx.jobs[i].out);
+        if (check) {
+            free((char *)ctx.jobs[i].name);
+            free((char *)ctx.jobs[i].expect);
+        }
+    }
+    free(ctx.jobs);
+    free(files);
+    return status;
+}
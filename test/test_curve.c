@@ -0,0 +1,240 @@
+/**
+ * @cond internal
+ * @file test_curve.c
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Curve-generic tests of the Decaf group and crypto routines.
+ *
+ * test_decaf.cxx goes through the C++ wrapper, which only exists for
+ * Ed448-Goldilocks.  This uses the C API through the names in
+ * src/$(FIELD)/decaf_curve.h, so it runs on every curve:
+ *     make clean; make test FIELD=p521 ARCH=arch_x86_64_r12
+ * Mostly it checks that the different ways of computing the same thing
+ * agree, which catches carry and table layout bugs in a new backend.
+ */
+
+#define _XOPEN_SOURCE 600 /* for posix_memalign */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "decaf_curve.h"
+
+#ifndef N_TESTS_BASE
+#define N_TESTS_BASE 200
+#endif
+
+static int failures = 0;
+
+static void check(decaf_bool_t ok, const char *what, int i) {
+    if (!ok) {
+        if (failures < 10) printf("    Failure: %s (iteration %d)\n", what, i);
+        failures++;
+    }
+}
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static void random_bytes(unsigned char *out, size_t n) {
+    size_t i;
+    for (i=0; i<n; i++) {
+        /* xorshift64*; fine for tests */
+        rng_state ^= rng_state >> 12;
+        rng_state ^= rng_state << 25;
+        rng_state ^= rng_state >> 27;
+        out[i] = (rng_state * 0x2545f4914f6cdd1dull) >> 56;
+    }
+}
+
+static void random_scalar(API_NS(scalar_t) s) {
+    unsigned char ser[SCALAR_BYTES + 8];
+    random_bytes(ser, sizeof(ser));
+    API_NS(scalar_decode_long)(s, ser, sizeof(ser));
+}
+
+static decaf_bool_t same_point(const API_NS(point_t) a, const API_NS(point_t) b) {
+    unsigned char sa[SER_BYTES], sb[SER_BYTES];
+    API_NS(point_encode)(sa, a);
+    API_NS(point_encode)(sb, b);
+    return API_NS(point_eq)(a, b) & decaf_memeq(sa, sb, SER_BYTES);
+}
+
+static void test_arithmetic(void) {
+    API_NS(point_t) base, p, q, r, s;
+    API_NS(scalar_t) x, y, z, one;
+    unsigned char ser[SER_BYTES], ser2[SER_BYTES], sc[SCALAR_BYTES];
+    int i;
+
+    printf("Arithmetic...\n");
+
+    API_NS(point_copy)(base, API_NS(point_base));
+    API_NS(point_encode)(ser, base);
+    check(API_NS(point_decode)(p, ser, DECAF_FALSE), "base point decodes", 0);
+    check(same_point(p, base), "base point round trip", 0);
+    check(API_NS(point_valid)(base), "base point valid", 0);
+    check(~API_NS(point_eq)(base, API_NS(point_identity)), "base point isn't the identity", 0);
+
+    /* (q-1)*B = -B checks the group order */
+    API_NS(scalar_sub)(x, API_NS(scalar_zero), API_NS(scalar_one));
+    API_NS(point_scalarmul)(p, base, x);
+    API_NS(point_add)(p, p, base);
+    check(API_NS(point_eq)(p, API_NS(point_identity)), "q*B = 0", 0);
+
+    for (i=0; i<N_TESTS_BASE; i++) {
+        random_scalar(x);
+        random_scalar(y);
+
+        /* Scalars */
+        API_NS(scalar_encode)(sc, x);
+        check(API_NS(scalar_decode)(z, sc), "scalar decodes", i);
+        check(API_NS(scalar_eq)(z, x), "scalar round trip", i);
+        check(API_NS(scalar_invert)(z, x), "scalar invert", i);
+        API_NS(scalar_mul)(z, z, x);
+        API_NS(scalar_copy)(one, API_NS(scalar_one));
+        check(API_NS(scalar_eq)(z, one), "x * 1/x = 1", i);
+
+        /* x*B, four ways */
+        API_NS(point_scalarmul)(p, base, x);
+        API_NS(precomputed_scalarmul)(q, API_NS(precomputed_base), x);
+        check(same_point(p, q), "precomputed base = scalarmul", i);
+        API_NS(point_encode)(ser, base);
+        check(API_NS(direct_scalarmul)(ser2, ser, x, DECAF_FALSE, DECAF_FALSE),
+            "direct scalarmul", i);
+        API_NS(point_encode)(ser, p);
+        check(decaf_memeq(ser, ser2, SER_BYTES), "direct scalarmul = scalarmul", i);
+        check(API_NS(point_decode)(r, ser, DECAF_FALSE), "point decodes", i);
+        check(same_point(p, r), "point round trip", i);
+
+        /* Linearity */
+        API_NS(point_scalarmul)(q, base, y);
+        API_NS(point_add)(r, p, q);
+        API_NS(scalar_add)(z, x, y);
+        API_NS(precomputed_scalarmul)(s, API_NS(precomputed_base), z);
+        check(same_point(r, s), "(x+y)B = xB + yB", i);
+        API_NS(point_double_scalarmul)(s, base, x, base, y);
+        check(same_point(r, s), "double scalarmul", i);
+
+        /* y*P for a random P, with the variable-base tables */
+        API_NS(point_scalarmul)(r, p, y);
+        API_NS(scalar_mul)(z, x, y);
+        API_NS(point_scalarmul)(s, base, z);
+        check(same_point(r, s), "y(xB) = (xy)B", i);
+        API_NS(point_scalarmul_non_secret)(s, p, y);
+        check(same_point(r, s), "scalarmul non secret", i);
+        API_NS(base_double_scalarmul_non_secret)(s, x, p, y);
+        API_NS(point_add)(q, p, r);
+        check(same_point(q, s), "base double scalarmul non secret", i);
+        API_NS(point_double_scalarmul_non_secret)(s, base, x, p, y);
+        check(same_point(q, s), "double scalarmul non secret", i);
+
+        API_NS(point_double)(q, p);
+        API_NS(point_add)(r, p, p);
+        check(same_point(q, r), "2P = P+P", i);
+        API_NS(point_sub)(r, r, p);
+        check(same_point(p, r), "2P - P = P", i);
+        API_NS(point_double_and_encode_batch)(ser, (const API_NS(point_t) *)p, 1);
+        API_NS(point_encode)(ser2, q);
+        check(decaf_memeq(ser, ser2, SER_BYTES), "double and encode", i);
+    }
+}
+
+static void test_tables(void) {
+    static const unsigned int combs[][3] = { {DECAF_COMBS_N, DECAF_COMBS_T, DECAF_COMBS_S}, DECAF_EXTRA_BASE_COMBS };
+    API_NS(point_t) p, q, r;
+    API_NS(scalar_t) x;
+    API_NS(precomputed_s) *pre = NULL;
+    API_NS(precomputed_comb_s) *comb = NULL;
+    unsigned int i, k;
+
+    printf("Precomputed tables...\n");
+
+    if (posix_memalign((void **)&pre, API_NS2(alignof,precomputed_s), API_NS2(sizeof,precomputed_s))) {
+        check(DECAF_FALSE, "allocate table", 0);
+        return;
+    }
+
+    random_scalar(x);
+    API_NS(point_scalarmul)(p, API_NS(point_base), x);
+    API_NS(precompute)(pre, p);
+
+    for (i=0; i<N_TESTS_BASE/4; i++) {
+        random_scalar(x);
+        API_NS(point_scalarmul)(q, p, x);
+        API_NS(precomputed_scalarmul)(r, pre, x);
+        check(same_point(q, r), "precomputed table = scalarmul", i);
+
+        API_NS(point_scalarmul)(q, API_NS(point_base), x);
+        for (k=0; k<sizeof(combs)/sizeof(combs[0]); k++) {
+            check(API_NS(precomputed_base_comb_scalarmul)(r, combs[k][0], combs[k][1], combs[k][2], x),
+                "built-in base comb", i);
+            check(same_point(q, r), "built-in base comb = scalarmul", i);
+        }
+    }
+
+    k = API_NS(sizeof_precomputed_comb)(3, 7, 25);
+    if (k && !posix_memalign((void **)&comb, API_NS(alignof_precomputed_comb)(), k)) {
+        check(API_NS(precompute_comb)(comb, 3, 7, 25, p), "runtime comb", 0);
+        for (i=0; i<N_TESTS_BASE/4; i++) {
+            random_scalar(x);
+            API_NS(point_scalarmul)(q, p, x);
+            API_NS(precomputed_comb_scalarmul)(r, comb, x);
+            check(same_point(q, r), "runtime comb = scalarmul", i);
+        }
+        free(comb);
+    } else {
+        check(DECAF_FALSE, "allocate comb", 0);
+    }
+
+    free(pre);
+}
+
+static void test_crypto(void) {
+    API_NS(symmetric_key_t) proto1, proto2;
+    API_NS(private_key_t) s1, s2;
+    API_NS(public_key_t) p1, p2;
+    API_NS(signature_t) sig;
+    unsigned char message[100], ss1[64], ss2[64];
+    int i;
+
+    printf("Crypto...\n");
+
+    for (i=0; i<N_TESTS_BASE/10; i++) {
+        random_bytes(proto1, sizeof(proto1));
+        random_bytes(proto2, sizeof(proto2));
+        random_bytes(message, sizeof(message));
+        API_NS(derive_private_key)(s1, proto1);
+        API_NS(derive_private_key)(s2, proto2);
+        API_NS(private_to_public)(p1, s1);
+        API_NS(private_to_public)(p2, s2);
+
+        check(API_NS(shared_secret)(ss1, sizeof(ss1), s1, p2), "shared secret", i);
+        check(API_NS(shared_secret)(ss2, sizeof(ss2), s2, p1), "shared secret", i);
+        check(decaf_memeq(ss1, ss2, sizeof(ss1)), "shared secrets agree", i);
+
+        API_NS(sign)(sig, s1, message, sizeof(message));
+        check(API_NS(verify)(sig, p1, message, sizeof(message)), "verify", i);
+        check(~API_NS(verify)(sig, p2, message, sizeof(message)), "verify with the wrong key", i);
+        message[i % sizeof(message)] ^= 1;
+        check(~API_NS(verify)(sig, p1, message, sizeof(message)), "verify a changed message", i);
+
+        API_NS(destroy_private_key)(s1);
+        API_NS(destroy_private_key)(s2);
+    }
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+
+    printf("Testing %s, field backend %s:\n", CURVE_NAME, API_NS(field_backend)());
+    test_arithmetic();
+    test_tables();
+    test_crypto();
+
+    if (failures) {
+        printf("Failed %d checks.\n", failures);
+        return 1;
+    }
+    printf("Passed all tests.\n");
+    return 0;
+}
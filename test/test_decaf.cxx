@@ -11,8 +11,11 @@
 
 #include "decaf.hxx"
 #include "shake.hxx"
-#include "decaf_crypto.h"
+#include "decaf_crypto.hxx"
+#include "decaf_engine.h"
 #include <stdio.h>
+#include <vector>
+#include <sched.h>
 
 
 static bool passing = true;
@@ -46,6 +49,7 @@ template<typename Group> struct Tests {
 typedef typename Group::Scalar Scalar;
 typedef typename Group::Point Point;
 typedef typename Group::Precomputed Precomputed;
+typedef typename Group::NonSecret NonSecret;
 
 static void print(const char *name, const Scalar &x) {
     unsigned char buffer[Scalar::SER_BYTES];
@@ -194,6 +198,57 @@ static void test_elligator() {
     }
 }
 
+static void test_inversion() {
+    decaf::SpongeRng rng(decaf::Block("test_inversion"));
+    
+    Test test("Inversion");
+    
+    /* Scalars: compare with Fermat, x^(q-2), including the edge cases */
+    unsigned char qm2[Scalar::SER_BYTES];
+    (-Scalar(1)).encode(qm2);
+    qm2[0] -= 1; /* q-1 is even */
+    
+    for (int i=0; i<200 && test.passing_now; i++) {
+        Scalar x(rng.read(Scalar::SER_BYTES + 8));
+        if (i==0) x = 0;
+        else if (i==1) x = 1;
+        else if (i==2) x = -Scalar(1);
+        else if (i==3) x = Scalar(1)/2;
+        else if (i==4) x = -Scalar(2);
+        else if (i<16) x = i;
+        
+        Scalar want(1);
+        for (int b=Scalar::SER_BYTES*8-1; b>=0; b--) {
+            want = want*want;
+            if (qm2[b/8]>>(b%8) & 1) want = want*x;
+        }
+        Scalar got;
+        decaf_bool_t ok = decaf_448_scalar_invert(got.s,x.s);
+        if (got != want || ok != (x == 0 ? DECAF_FALSE : DECAF_TRUE)) {
+            test.fail();
+            print("x", x);
+            print("safegcd", got);
+            print("fermat", want);
+        }
+    }
+    
+    /* Field: the single-point batch encode inverts directly */
+    for (int i=0; i<200 && test.passing_now; i++) {
+        static decaf_448_point_t pt; /* static: gf needs 32-byte alignment */
+        unsigned char got[Point::SER_BYTES], want[Point::SER_BYTES];
+        Point p(rng);
+        if (i==0) p = Point::identity();
+        else if (i==1) p = Point::base();
+        else if (i==2) decaf_448_point_debugging_2torque(p.p,p.p);
+        decaf_448_point_copy(pt,p.p);
+        decaf_448_point_double_and_encode_batch(got,&pt,1);
+        (p+p).encode(want);
+        if (memcmp(got,want,sizeof(got))) {
+            test.fail(); printf("  Fail field inverse via double-and-encode, i=%d\n", i);
+        }
+    }
+}
+
 static void test_ec() {
     decaf::SpongeRng rng(decaf::Block("test_ec"));
     
@@ -203,6 +258,13 @@ static void test_ec() {
     point_check(test,id,id,id,0,0,Point::from_hash(""),id,"fh0");
     point_check(test,id,id,id,0,0,Point::from_hash("\x01"),id,"fh1");
     
+    decaf_448_precomputed_wnaf_s *wnaf;
+    if (posix_memalign((void**)&wnaf, alignof_decaf_448_precomputed_wnaf_s,
+            sizeof_decaf_448_precomputed_wnaf_s)) {
+        test.fail(); printf("  Can't allocate wnaf table\n");
+        return;
+    }
+    
     for (int i=0; i<NTESTS && test.passing_now; i++) {
         /* TODO: pathological cases */
         Scalar x(rng);
@@ -225,7 +287,35 @@ static void test_ec() {
         point_check(test,p,q,r,x,y,(x*y)*p,x*(y*p),"assoc mul");
         point_check(test,p,q,r,x,y,x*p+y*q,Point::double_scalarmul(x,p,y,q),"ds mul");
         point_check(test,base,q,r,x,y,x*base+y*q,q.non_secret_combo_with_base(y,x),"ds vt mul");
+        point_check(test,p,q,r,x,y,x*p+y*q,Point::double_scalarmul_non_secret(p,x,q,y),"ds vt mul2");
+        point_check(test,p,q,r,x,0,x*p,Point::double_scalarmul_non_secret(p,x,q,0),"ds vt mul2 y=0");
         point_check(test,p,q,r,x,0,Precomputed(p)*x,p*x,"precomp mul");
+        point_check(test,p,q,r,x,0,p*NonSecret(x),p*x,"vt mul");
+        point_check(test,p,q,r,0,0,p*NonSecret(Scalar(0)),Point::identity(),"vt mul x=0");
+        point_check(test,p,q,r,0,0,NonSecret(Scalar(1))*p,p,"vt mul x=1");
+        point_check(test,p,q,r,x,0,p*NonSecret(-x),-(p*x),"vt mul x=-x");
+        
+        {
+            Point ws((decaf::NOINIT()));
+            decaf_448_precompute_wnaf(wnaf,q.p);
+            decaf_448_base_double_scalarmul_wnaf_non_secret(ws.p,x.s,wnaf,y.s);
+            point_check(test,base,q,r,x,y,x*base+y*q,ws,"ds vt wnaf mul");
+            decaf_448_base_double_scalarmul_wnaf_non_secret(ws.p,x.s,wnaf,Scalar(0).s);
+            point_check(test,base,q,r,x,0,x*base,ws,"ds vt wnaf mul y=0");
+            decaf_448_base_double_scalarmul_wnaf_non_secret(ws.p,Scalar(0).s,wnaf,y.s);
+            point_check(test,base,q,r,0,y,y*q,ws,"ds vt wnaf mul x=0");
+        }
+        
+        {
+            decaf_448_point_t pts[3];
+            decaf_448_scalar_t scs[3];
+            decaf_448_point_copy(pts[0],p.p); decaf_448_scalar_copy(scs[0],x.s);
+            decaf_448_point_copy(pts[1],q.p); decaf_448_scalar_copy(scs[1],y.s);
+            decaf_448_point_copy(pts[2],r.p); decaf_448_scalar_copy(scs[2],(x-y).s);
+            Point ms((decaf::NOINIT()));
+            decaf_448_multiscalarmul_non_secret(ms.p,pts,scs,3);
+            point_check(test,p,q,r,x,y,x*p+y*q+(x-y)*r,ms,"multiscalar vt mul");
+        }
         point_check(test,p,q,r,0,0,r,
             Point::from_hash(buffer.slice(0,Point::HASH_BYTES))
             + Point::from_hash(buffer.slice(Point::HASH_BYTES,Point::HASH_BYTES)),
@@ -235,6 +325,92 @@ static void test_ec() {
 
         point_check(test,p,q,r,x,0,Point(x.direct_scalarmul(decaf::SecureBuffer(p))),x*p,"direct mul");
     }
+    
+    /* Enough points for the bucket method, with some edge-case scalars */
+    for (int i=0; i<2 && test.passing_now; i++) {
+        const int N = 300;
+        static decaf_448_point_t pts[N]; /* static: gf needs 32-byte alignment */
+        static decaf_448_scalar_t scs[N];
+        Point p(rng), want = Point::identity(), ms((decaf::NOINIT()));
+        Scalar x(rng);
+        for (int j=0; j<N; j++) {
+            Scalar s(rng);
+            if (j%50 == 0) s = 0;
+            else if (j%50 == 1) s = 1;
+            else if (j%50 == 2) s = -Scalar(1);
+            else if (j%50 == 3) s = x;
+            if (j%7 == 0) p = Point(rng);
+            decaf_448_point_copy(pts[j],p.p);
+            decaf_448_scalar_copy(scs[j],s.s);
+            want += s*p;
+        }
+        decaf_448_multiscalarmul_non_secret(ms.p,pts,scs,N);
+        point_check(test,p,p,p,x,0,want,ms,"multiscalar vt mul many");
+    }
+    
+    
+    /* Batch encoding, across the inversion batch boundary */
+    for (int i=0; i<3 && test.passing_now; i++) {
+        const int N = 70;
+        static decaf_448_point_t pts[N]; /* static: gf needs 32-byte alignment */
+        static unsigned char sers[N*Point::SER_BYTES];
+        int n = (i==0) ? 1 : N - i;
+        for (int j=0; j<n; j++) {
+            Point p(rng);
+            if (j%17 == 3) p = Point::identity();
+            if (j%17 == 5) decaf_448_point_debugging_2torque(p.p,p.p);
+            decaf_448_point_copy(pts[j],p.p);
+        }
+        decaf_448_point_double_and_encode_batch(sers,pts,n);
+        for (int j=0; j<n; j++) {
+            unsigned char want[Point::SER_BYTES];
+            Point p(pts[j]);
+            (p+p).encode(want);
+            if (memcmp(want,&sers[j*Point::SER_BYTES],Point::SER_BYTES)) {
+                test.fail(); printf("  Fail double-and-encode batch, n=%d j=%d\n", n, j);
+                break;
+            }
+        }
+    }
+    
+    /* Comb tables with runtime parameters, including edge cases of t and s */
+    const unsigned int combs[][3] = {{5,5,18},{2,5,45},{6,6,13},{1,2,223},{3,8,19},{446,2,1}};
+    for (unsigned c=0; c<sizeof(combs)/sizeof(combs[0]) && test.passing_now; c++) {
+        const unsigned int n = combs[c][0], t = combs[c][1], s = combs[c][2];
+        decaf_448_precomputed_comb_s *comb;
+        if (posix_memalign((void**)&comb, decaf_448_alignof_precomputed_comb(),
+                decaf_448_sizeof_precomputed_comb(n,t,s))) {
+            test.fail(); printf("  Can't allocate comb table\n");
+            break;
+        }
+        Point p(rng);
+        if (!decaf_448_precompute_comb(comb,n,t,s,p.p)) {
+            test.fail(); printf("  Fail precompute comb %u,%u,%u\n",n,t,s);
+        }
+        for (int i=0; i<10 && test.passing_now; i++) {
+            Scalar x(rng);
+            if (i==0) x = 0;
+            if (i==1) x = -Scalar(1);
+            Point cm((decaf::NOINIT())), bm((decaf::NOINIT()));
+            decaf_448_precomputed_comb_scalarmul(cm.p,comb,x.s);
+            point_check(test,p,p,p,x,0,p*x,cm,"comb mul");
+            if (c < 3) {
+                if (!decaf_448_precomputed_base_comb_scalarmul(bm.p,n,t,s,x.s)) {
+                    test.fail(); printf("  Missing base comb %u,%u,%u\n",n,t,s);
+                }
+                point_check(test,base,p,p,x,0,base*x,bm,"base comb mul");
+            }
+        }
+        decaf_448_precomputed_comb_destroy(comb);
+        free(comb);
+    }
+    if (decaf_448_sizeof_precomputed_comb(5,5,17) || decaf_448_sizeof_precomputed_comb(2,9,25)
+        || decaf_448_sizeof_precomputed_comb(0,5,18) || decaf_448_sizeof_precomputed_comb(446,1,1)) {
+        test.fail(); printf("  Accepted bad comb parameters\n");
+    }
+    
+    decaf_448_precomputed_wnaf_destroy(wnaf);
+    free(wnaf);
 }
 
 }; // template<decaf::GroupId GROUP>
@@ -274,13 +450,369 @@ static void test_decaf() {
     }
 }
 
+static void test_batch_verify() {
+    Test test("Batch verify");
+    decaf::SpongeRng rng(decaf::Block("test_batch_verify"));
+    
+    const int N = 100;
+    decaf_448_symmetric_key_t proto;
+    decaf_448_private_key_t priv[3];
+    decaf_448_public_key_t pubs[3];
+    decaf_448_signature_t sigs[N];
+    unsigned char messages[N][16];
+    
+    for (int i=0; i<3; i++) {
+        rng.read(decaf::TmpBuffer(proto,sizeof(proto)));
+        decaf_448_derive_private_key(priv[i],proto);
+        decaf_448_private_to_public(pubs[i],priv[i]);
+    }
+    
+    for (int iter=0; iter<10 && test.passing_now; iter++) {
+        decaf::SignatureBatch batch;
+        std::vector<bool> expected(N,true), results;
+        for (int i=0; i<N; i++) {
+            rng.read(decaf::TmpBuffer(messages[i],sizeof(messages[i])));
+            decaf_448_sign(sigs[i],priv[i%3],messages[i],sizeof(messages[i]));
+        }
+        
+        /* Break a few, in different ways */
+        for (int k=0; k<iter; k++) {
+            int i = (37*k + 11*iter) % N;
+            switch (k%3) {
+            case 0: sigs[i][DECAF_448_SER_BYTES] ^= 1; break;
+            case 1: messages[i][0] ^= 1; break;
+            case 2: memset(sigs[i],0xFF,DECAF_448_SER_BYTES); break;
+            }
+            expected[i] = false;
+        }
+        
+        for (int i=0; i<N; i++) {
+            batch.add(decaf::Block(sigs[i],sizeof(sigs[i])),
+                decaf::Block(pubs[(i+(iter==9))%3],sizeof(pubs[0])),
+                decaf::Block(messages[i],sizeof(messages[i])));
+            if (iter==9) expected[i] = false;
+        }
+        
+        bool all = batch.verify(results);
+        bool all_expected = (iter==0);
+        if (all != all_expected || batch.verify() != all_expected || results != expected) {
+            test.fail(); printf("Fail batch verify, iter=%d\n", iter);
+        }
+        for (int i=0; i<N; i++) {
+            bool single = decaf_448_verify(sigs[i],pubs[(i+(iter==9))%3],messages[i],sizeof(messages[i]));
+            if (single != expected[i]) {
+                test.fail(); printf("Fail batch vs single verify, iter=%d i=%d\n", iter, i);
+            }
+        }
+    }
+}
+
+static void test_prepared_verify() {
+    Test test("Prepared verify");
+    decaf::SpongeRng rng(decaf::Block("test_prepared_verify"));
+    
+    const int NKEYS = 5;
+    decaf_448_symmetric_key_t proto;
+    decaf_448_private_key_t priv[NKEYS];
+    decaf_448_public_key_t pubs[NKEYS], bad_pub;
+    decaf_448_prepared_public_key_s *prep[NKEYS];
+    decaf_448_signature_t sig;
+    unsigned char message[16];
+    
+    for (int i=0; i<NKEYS; i++) {
+        rng.read(decaf::TmpBuffer(proto,sizeof(proto)));
+        decaf_448_derive_private_key(priv[i],proto);
+        decaf_448_private_to_public(pubs[i],priv[i]);
+        prep[i] = decaf_448_prepared_public_key_create(pubs[i]);
+        if (!prep[i]) { test.fail(); printf("  Fail prepare %d\n", i); return; }
+    }
+    
+    memset(bad_pub,0xFF,sizeof(bad_pub));
+    if (decaf_448_prepared_public_key_create(bad_pub)) {
+        test.fail(); printf("  Fail: prepared an invalid key\n");
+    }
+    
+    /* Capacity less than the number of keys, so the cache evicts */
+    decaf_448_public_key_cache_s *cache = decaf_448_public_key_cache_create(3);
+    
+    for (int iter=0; iter<200 && test.passing_now; iter++) {
+        int k = (iter*iter) % NKEYS, signer = (iter%7) ? k : (k+1)%NKEYS;
+        rng.read(decaf::TmpBuffer(message,sizeof(message)));
+        decaf_448_sign(sig,priv[signer],message,sizeof(message));
+        if (iter%5 == 1) sig[DECAF_448_SER_BYTES] ^= 1;
+        if (iter%5 == 2) message[0] ^= 1;
+        if (iter%5 == 3) memset(sig,0xFF,DECAF_448_SER_BYTES);
+        
+        bool expected = decaf_448_verify(sig,pubs[k],message,sizeof(message));
+        bool prepared = decaf_448_verify_prepared(sig,prep[k],message,sizeof(message));
+        bool cached = decaf_448_verify_cached(cache,sig,pubs[k],message,sizeof(message));
+        bool valid = (iter%5 == 0 || iter%5 == 4) && signer == k;
+        if (expected != valid || prepared != expected || cached != expected) {
+            test.fail();
+            printf("  Fail iter=%d: verify=%d prepared=%d cached=%d\n",
+                iter, (int)expected, (int)prepared, (int)cached);
+        }
+        
+        if (decaf_448_verify_cached(cache,sig,bad_pub,message,sizeof(message))) {
+            test.fail(); printf("  Fail: cached verify with invalid key, iter=%d\n", iter);
+        }
+    }
+    
+    {
+        decaf::PreparedPublicKey pk(decaf::Block(pubs[0],sizeof(pubs[0])));
+        decaf::PublicKeyCache pkc(2);
+        decaf_448_sign(sig,priv[0],message,sizeof(message));
+        decaf::Block bsig(sig,sizeof(sig)), bmsg(message,sizeof(message));
+        if (!pk.verify(bsig,bmsg) || !pkc.verify(bsig,decaf::Block(pubs[0],sizeof(pubs[0])),bmsg)
+            || pkc.verify(bsig,decaf::Block(pubs[1],sizeof(pubs[1])),bmsg)) {
+            test.fail(); printf("  Fail C++ prepared verify\n");
+        }
+    }
+    
+    decaf_448_public_key_cache_destroy(cache);
+    for (int i=0; i<NKEYS; i++) decaf_448_prepared_public_key_destroy(prep[i]);
+}
+
+static void engine_done(decaf_448_engine_request_s *req) {
+    __sync_fetch_and_add((int *)req->user, 1);
+}
+
+static void test_signing_engine() {
+    Test test("Signing engine");
+    decaf::SpongeRng rng(decaf::Block("test_signing_engine"));
+    
+    const int N = 150, NKEYS = 3;
+    decaf_448_symmetric_key_t proto;
+    decaf_448_private_key_t priv[NKEYS];
+    decaf_448_public_key_t pubs[NKEYS];
+    static decaf_448_signature_t sigs[N], batch_sigs[N];
+    static unsigned char messages[N][24];
+    const decaf_448_private_key_s *privs[N];
+    const unsigned char *msgs[N];
+    size_t lens[N];
+    
+    for (int i=0; i<NKEYS; i++) {
+        rng.read(decaf::TmpBuffer(proto,sizeof(proto)));
+        decaf_448_derive_private_key(priv[i],proto);
+        decaf_448_private_to_public(pubs[i],priv[i]);
+    }
+    
+    /* Batch signing matches one at a time, across more than one sub-batch */
+    for (int i=0; i<N; i++) {
+        rng.read(decaf::TmpBuffer(messages[i],sizeof(messages[i])));
+        privs[i] = priv[i%NKEYS];
+        msgs[i] = messages[i];
+        lens[i] = i % sizeof(messages[i]);
+        decaf_448_sign(sigs[i],priv[i%NKEYS],messages[i],lens[i]);
+    }
+    decaf_448_sign_batch(batch_sigs,privs,msgs,lens,N);
+    for (int i=0; i<N; i++) {
+        if (memcmp(sigs[i],batch_sigs[i],sizeof(sigs[i]))) {
+            test.fail(); printf("  Fail sign batch, i=%d\n", i);
+            break;
+        }
+    }
+    
+    /* A small queue, so that submissions sometimes bounce */
+    decaf_448_engine_s *engine = decaf_448_engine_create(2,16,8);
+    if (!engine) { test.fail(); printf("  Fail create engine\n"); return; }
+    
+    static decaf_448_engine_request_s reqs[2*N];
+    static decaf_448_signature_t out[N];
+    int done = 0;
+    for (int i=0; i<2*N; i++) {
+        decaf_448_engine_request_s *req = &reqs[i];
+        memset(req,0,sizeof(*req));
+        int j = i/2;
+        if (i%2 == 0) {
+            req->op = DECAF_448_ENGINE_SIGN;
+            req->priv = priv[j%NKEYS];
+            req->sig = out[j];
+        } else {
+            req->op = DECAF_448_ENGINE_VERIFY;
+            req->pub = pubs[(j + (j%5==3)) % NKEYS];
+            req->sig = sigs[j];
+        }
+        req->message = messages[j];
+        req->message_len = lens[j];
+        req->callback = engine_done;
+        req->user = &done;
+        while (!decaf_448_engine_submit(engine,req)) sched_yield();
+    }
+    
+    while (__sync_fetch_and_add(&done,0) < 2*N) sched_yield();
+    decaf_448_engine_stats_s stats;
+    decaf_448_engine_stats(engine,&stats);
+    decaf_448_engine_destroy(engine);
+    
+    if (done != 2*N || stats.submitted != 2*N || stats.completed != 2*N || stats.queue_depth) {
+        test.fail(); printf("  Fail: %d callbacks, stats %d/%d/%d\n", done,
+            (int)stats.submitted, (int)stats.completed, (int)stats.queue_depth);
+    }
+    for (int j=0; j<N && test.passing_now; j++) {
+        bool ok_sign = reqs[2*j].result && !memcmp(out[j],sigs[j],sizeof(sigs[j]));
+        bool ok_verify = bool(reqs[2*j+1].result) == (j%5 != 3);
+        if (!ok_sign || !ok_verify) {
+            test.fail(); printf("  Fail engine, j=%d sign=%d verify=%d\n", j, (int)ok_sign, (int)ok_verify);
+        }
+    }
+}
+
+static void test_sponge_bulk() {
+    Test test("Sponge bulk");
+    decaf::SpongeRng rng(decaf::Block("test_sponge_bulk"));
+    
+    /* Known answers for the empty message */
+    const unsigned char shake128_empty[16] = {
+        0x7f,0x9c,0x2b,0xa4,0xe8,0x8f,0x82,0x7d,0x61,0x60,0x45,0x50,0x76,0x05,0x85,0x3e
+    };
+    const unsigned char sha3_512_empty[16] = {
+        0xa6,0x9f,0x73,0xcc,0xa2,0x3a,0x9a,0xc5,0xc8,0xb5,0x67,0xdc,0x18,0x5a,0x75,0x6e
+    };
+    unsigned char kat[16];
+    shake128_hash(kat,sizeof(kat),(const uint8_t *)"",0);
+    if (memcmp(kat,shake128_empty,sizeof(kat))) {
+        test.fail(); printf("    Fail SHAKE128 known answer\n");
+    }
+    sha3_512_hash(kat,sizeof(kat),(const uint8_t *)"",0);
+    if (memcmp(kat,sha3_512_empty,sizeof(kat))) {
+        test.fail(); printf("    Fail SHA3-512 known answer\n");
+    }
+    
+    /* Piecewise absorb and squeeze must agree with one-shot */
+    const struct kparams_s *params[] = {
+        &SHAKE128_params_s, &SHAKE256_params_s,
+        &SHA3_224_params_s, &SHA3_256_params_s, &SHA3_384_params_s, &SHA3_512_params_s
+    };
+    static unsigned char in[3000], want[600], got[600];
+    rng.read(decaf::TmpBuffer(in,sizeof(in)));
+    for (int p=0; p<6 && test.passing_now; p++) {
+        size_t outlen = (p < 2) ? sizeof(want) : 28;
+        sponge_hash(in,sizeof(in),want,outlen,params[p]);
+        for (int iter=0; iter<20; iter++) {
+            keccak_sponge_t sponge;
+            unsigned char r[2];
+            sponge_init(sponge,params[p]);
+            for (size_t done=0, step; done<sizeof(in); done+=step) {
+                rng.read(decaf::TmpBuffer(r,1));
+                step = (iter&1) ? r[0] : 8*r[0]+r[0]%3;
+                if (step > sizeof(in)-done) step = sizeof(in)-done;
+                sha3_update(sponge,&in[done],step);
+            }
+            sha3_output(sponge,got,outlen);
+            sponge_destroy(sponge);
+            if (memcmp(want,got,outlen)) {
+                test.fail(); printf("    Fail piecewise sponge p=%d iter=%d\n",p,iter);
+            }
+        }
+    }
+}
+
+static void test_sponge_many() {
+    Test test("Sponge hash many");
+    decaf::SpongeRng rng(decaf::Block("test_sponge_many"));
+    
+    const int N = 10;
+    const struct kparams_s *params[] = {
+        &SHAKE128_params_s, &SHAKE256_params_s, &SHA3_512_params_s
+    };
+    const size_t outlens[] = {32, 400, 64};
+    unsigned char inbuf[N][600], outbuf[N][400], want[400];
+    const uint8_t *in[N];
+    uint8_t *out[N];
+    size_t inlen[N];
+    
+    for (int p=0; p<3 && test.passing_now; p++) {
+        for (int iter=0; iter<10; iter++) {
+            for (int i=0; i<N; i++) {
+                rng.read(decaf::TmpBuffer(inbuf[i],sizeof(inbuf[i])));
+                /* Cover empty input and the rate boundaries */
+                inlen[i] = (iter == 0) ? i*68 % 600 : (inbuf[i][0] | inbuf[i][1]<<8) % 600;
+                if (iter == 1) inlen[i] = 0;
+                in[i] = inbuf[i];
+                out[i] = outbuf[i];
+            }
+            sponge_hash_many(N, in, inlen, out, outlens[p], params[p]);
+            for (int i=0; i<N; i++) {
+                sponge_hash(in[i], inlen[i], want, outlens[p], params[p]);
+                if (memcmp(want, outbuf[i], outlens[p])) {
+                    test.fail();
+                    printf("    Fail sponge_hash_many p=%d iter=%d i=%d len=%d\n",
+                        p, iter, i, (int)inlen[i]);
+                }
+            }
+        }
+    }
+}
+
+static void test_k12() {
+    Test test("KangarooTwelve");
+    decaf::SpongeRng rng(decaf::Block("test_k12"));
+    
+    /* Known answers: TurboSHAKE of "", and K12 of the spec's ptn(17^i) pattern */
+    const unsigned char ts128_empty[16] = {
+        0x1e,0x41,0x5f,0x1c,0x59,0x83,0xaf,0xf2,0x16,0x92,0x17,0x27,0x7d,0x17,0xbb,0x53
+    };
+    const unsigned char ts256_empty[16] = {
+        0x36,0x7a,0x32,0x9d,0xaf,0xea,0x87,0x1c,0x78,0x02,0xec,0x67,0xf9,0x05,0xae,0x13
+    };
+    const unsigned char k12_ptn[5][16] = {
+        {0x1a,0xc2,0xd4,0x50,0xfc,0x3b,0x42,0x05,0xd1,0x9d,0xa7,0xbf,0xca,0x1b,0x37,0x51},
+        {0x6b,0xf7,0x5f,0xa2,0x23,0x91,0x98,0xdb,0x47,0x72,0xe3,0x64,0x78,0xf8,0xe1,0x9b},
+        {0x0c,0x31,0x5e,0xbc,0xde,0xdb,0xf6,0x14,0x26,0xde,0x7d,0xcf,0x8f,0xb7,0x25,0xd1},
+        {0xcb,0x55,0x2e,0x2e,0xc7,0x7d,0x99,0x10,0x70,0x1d,0x57,0x8b,0x45,0x7d,0xdf,0x77},
+        {0x87,0x01,0x04,0x5e,0x22,0x20,0x53,0x45,0xff,0x4d,0xda,0x05,0x55,0x5c,0xbb,0x5c}
+    };
+    unsigned char kat[16];
+    turboshake128_hash(kat,sizeof(kat),(const uint8_t *)"",0);
+    if (memcmp(kat,ts128_empty,sizeof(kat))) {
+        test.fail(); printf("    Fail TurboSHAKE128 known answer\n");
+    }
+    turboshake256_hash(kat,sizeof(kat),(const uint8_t *)"",0);
+    if (memcmp(kat,ts256_empty,sizeof(kat))) {
+        test.fail(); printf("    Fail TurboSHAKE256 known answer\n");
+    }
+    
+    std::vector<unsigned char> msg(8192*160);
+    for (size_t i=0; i<msg.size(); i++) msg[i] = i % 251;
+    for (int i=0, len=0; i<5; i++, len = len ? len*17 : 17) {
+        k12_hash(kat,sizeof(kat),&msg[0],len,NULL,0,1);
+        if (memcmp(kat,k12_ptn[i],sizeof(kat))) {
+            test.fail(); printf("    Fail K12 known answer, len=%d\n", len);
+        }
+    }
+    
+    /* Threads, lanes and customization must not change the answer */
+    rng.read(decaf::TmpBuffer(&msg[0],msg.size()));
+    for (int iter=0; iter<20 && test.passing_now; iter++) {
+        unsigned char r[4], custom[20000], serial[64], par[64];
+        rng.read(decaf::TmpBuffer(r,sizeof(r)));
+        size_t len = (r[0] | r[1]<<8 | r[2]<<16) % msg.size();
+        if (iter < 4) len = 8192*(33*4+iter) + iter - 2; /* near a leaf boundary */
+        size_t customlen = (iter%3 == 0) ? 0 : (iter%3 == 1) ? r[3] : sizeof(custom)-r[3];
+        rng.read(decaf::TmpBuffer(custom,sizeof(custom)));
+        k12_hash(serial,sizeof(serial),&msg[0],len,custom,customlen,1);
+        k12_hash(par,sizeof(par),&msg[0],len,custom,customlen,4);
+        if (memcmp(serial,par,sizeof(par))) {
+            test.fail(); printf("    Fail K12 threads, len=%d custom=%d\n", (int)len, (int)customlen);
+        }
+    }
+}
+
 int main(int argc, char **argv) {
     (void) argc; (void) argv;
     
     Tests<decaf::Ed448>::test_arithmetic();
     Tests<decaf::Ed448>::test_elligator();
+    Tests<decaf::Ed448>::test_inversion();
     Tests<decaf::Ed448>::test_ec();
     test_decaf();
+    test_batch_verify();
+    test_prepared_verify();
+    test_signing_engine();
+    test_sponge_bulk();
+    test_sponge_many();
+    test_k12();
     
     if (passing) printf("Passed all tests.\n");
     
@@ -0,0 +1,213 @@
+/**
+ * @cond internal
+ * @file test_field.c
+ * @copyright
+ *   Copyright (c) 2015 Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Field arithmetic tests for the selected ARCH.
+ *
+ * The field functions aren't exported from libdecaf, so this links the
+ * objects directly, like bench_field.  It checks the fused and shortcut
+ * kernels (sqrn, mul_add, field_inverse, and the four-way AVX2 operations)
+ * against the plain mul/sqr/add path.  In a dispatch build, pick the
+ * backend with DECAF_FIELD_BACKEND:
+ *     make clean; make build/test_field ARCH=arch_x86_64_dispatch
+ *     DECAF_FIELD_BACKEND=arch_ref64 ./build/test_field
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "field.h"
+#if FIELD_BITS == 448
+#include "p448_x4.h"
+#endif
+
+#ifndef N_TESTS_BASE
+#define N_TESTS_BASE 100
+#endif
+
+static int failures = 0;
+
+static void check(int ok, const char *what, int i) {
+    if (!ok) {
+        if (failures < 10) printf("    Failure: %s (iteration %d)\n", what, i);
+        failures++;
+    }
+}
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static void random_bytes(unsigned char *out, size_t n) {
+    size_t i;
+    for (i=0; i<n; i++) {
+        /* xorshift64*; fine for tests */
+        rng_state ^= rng_state >> 12;
+        rng_state ^= rng_state << 25;
+        rng_state ^= rng_state >> 27;
+        out[i] = (rng_state * 0x2545f4914f6cdd1dull) >> 56;
+    }
+}
+
+static void random_field(field_a_t x) {
+    uint8_t ser[FIELD_BITS/8];
+    random_bytes(ser, sizeof(ser));
+    ser[sizeof(ser)-1] &= 0x7f; /* keep it below p */
+    field_deserialize(x, ser);
+}
+
+static int field_same(const field_a_t x, const field_a_t y) {
+    uint8_t sx[FIELD_BITS/8], sy[FIELD_BITS/8];
+    field_serialize(sx, x);
+    field_serialize(sy, y);
+    return !memcmp(sx, sy, sizeof(sx));
+}
+
+/* Check the fused kernels against separate multiplies */
+static void check_mul_add(const field_a_t a, const field_a_t b, int i) {
+    field_a_t c, d, s, t, u;
+    field_sqr(c, a);
+    field_mulw(d, b, 12345);
+    field_mul(s, a, b);
+    field_mul(t, c, d);
+    field_add(u, s, t);
+    field_mul_add(s, a, b, c, d);
+    check(field_same(s, u), "mul_add = mul,mul,add", i);
+    field_mul(s, a, b);
+    field_sub(u, s, t);
+    field_mul_sub(s, a, b, c, d);
+    check(field_same(s, u), "mul_sub = mul,mul,sub", i);
+}
+
+/* Check field_sqrn against field_sqr, for odd and even n */
+static void check_sqrn(const field_a_t a, int i) {
+    field_a_t s, t;
+    int j, n;
+    for (n=1; n<=10; n++) {
+        t[0] = a[0];
+        for (j=0; j<n; j++) {
+            field_sqr(s, t);
+            t[0] = s[0];
+        }
+        field_sqrn(s, a, n);
+        check(field_same(s, t), "sqrn = n sqrs", i);
+    }
+}
+
+/* 1/x the old way, through the inverse square root: x * (1/sqrt(x^2))^2 */
+static void isr_inverse(field_a_t out, const field_a_t x) {
+    field_a_t s, t;
+    field_sqr(s, x);
+    field_isr(t, s);
+    field_sqr(s, t);
+    field_mul(out, s, x);
+}
+
+/*
+ * Check field_inverse against the isr chain on 0, 1, p-1 and a sequence of
+ * other values, each also with 2p added to its limbs so that the input
+ * isn't canonical.  Also check that x * 1/x = 1, and 1/0 = 0.
+ */
+static void check_inverse(const field_a_t a) {
+    field_a_t zero, one, x, inv, ref, t;
+    uint8_t ser[FIELD_BITS/8] = {1};
+    int i, j;
+    memset(zero, 0, sizeof(zero));
+    field_deserialize(one, ser);
+
+    for (i=0; i<1003; i++) {
+        switch (i) {
+        case 0: x[0] = zero[0]; break;
+        case 1: x[0] = one[0]; break;
+        case 2: field_sub(x, zero, one); break;
+        case 3: x[0] = a[0]; break;
+        default: field_mul(t, x, a); field_add(x, t, one); break;
+        }
+        for (j=0; j<2; j++) {
+            if (j) {
+                field_bias(x, 2);
+                IF32( field_weak_reduce(x) );
+            }
+            field_inverse(inv, x);
+            isr_inverse(ref, x);
+            field_mul(t, inv, x);
+            check(field_same(inv, ref),
+                j ? "inverse = isr chain, non-canonical" : "inverse = isr chain", i);
+            check(field_same(t, i ? one : zero), "x * 1/x = 1", i);
+        }
+    }
+}
+
+#if P448_X4
+/* Check the x4 kernels against the scalar field, with a zero in lane 3 */
+static void check_x4(const field_a_t base, int iter) {
+    p448_t in[4], in2[4], out[4], ref[4], sum;
+    p448_x4_t a, b, c, d;
+    const mask_t sel[4] = { 0, -1, -1, 0 };
+    static const char *const names[6] = {
+        "x4 mul", "x4 sqr", "x4 add", "x4 sub", "x4 add_nr,mul", "x4 cond_sel"
+    };
+    int i, j;
+
+    for (j=0; j<4; j++) {
+        field_mulw(&in[j], base, 1000+j);
+        field_sqr(&in2[j], &in[j]);
+    }
+    field_sub(&in[3], &in[3], &in[3]);
+    p448_x4_load(&a, in);
+    p448_x4_load(&b, in2);
+
+    for (i=0; i<6; i++) {
+        switch (i) {
+        case 0: p448_x4_mul(&c, &a, &b); break;
+        case 1: p448_x4_sqr(&c, &a); break;
+        case 2: p448_x4_add(&c, &a, &b); break;
+        case 3: p448_x4_sub(&c, &a, &b); break;
+        case 4: p448_x4_add_nr(&d, &a, &b); p448_x4_mul(&c, &d, &d); break;
+        case 5: p448_x4_cond_sel(&c, &a, &b, sel); break;
+        }
+        p448_x4_store(out, &c);
+        for (j=0; j<4; j++) {
+            switch (i) {
+            case 0: field_mul(&ref[j], &in[j], &in2[j]); break;
+            case 1: field_sqr(&ref[j], &in[j]); break;
+            case 2: field_add(&ref[j], &in[j], &in2[j]); break;
+            case 3: field_sub(&ref[j], &in[j], &in2[j]); break;
+            case 4: field_add(&sum, &in[j], &in2[j]); field_sqr(&ref[j], &sum); break;
+            case 5: ref[j] = sel[j] ? in2[j] : in[j]; break;
+            }
+            check(field_same(&out[j], &ref[j]), names[i], iter);
+        }
+    }
+}
+#endif
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    field_a_t a, b;
+    int i;
+
+    printf("Testing p%d, field backend %s:\n", FIELD_BITS, field_backend_name());
+
+    printf("Fused kernels...\n");
+    for (i=0; i<N_TESTS_BASE; i++) {
+        random_field(a);
+        random_field(b);
+        check_sqrn(a, i);
+        check_mul_add(a, b, i);
+#if P448_X4
+        check_x4(a, i);
+#endif
+    }
+
+    printf("Inverse...\n");
+    random_field(a);
+    check_inverse(a);
+
+    if (failures) {
+        printf("Failed %d checks.\n", failures);
+        return 1;
+    }
+    printf("Passed all tests.\n");
+    return 0;
+}